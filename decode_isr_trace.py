@@ -0,0 +1,261 @@
+#!/usr/bin/env python3
+import argparse
+import struct
+import sys
+import zlib
+
+"""This script is used to fetch and decode the ISR timeline recorded by firmware
+built with OC_ISR_TRACE (see software/src/OC_trace.h), and print per-phase
+duration histograms and the slowest core ISR ticks with everything that ran
+inside them.
+
+Dump format (little-endian): a 28 byte header
+    char magic[4] = "OCTR", u16 version, u16 record_size, u32 f_cpu,
+    u32 core_timer_rate (us), u32 trigger_cycles, u32 trigger_index, u32 count
+followed by count records, oldest first
+    u32 cycles, u16 arg, u8 event, u8 flags (0 = enter, 1 = exit, 2 = instant)
+and a CRC-32 (zlib) of everything before it.
+"""
+
+HEADER = struct.Struct('<4sHHIIIII')
+RECORD = struct.Struct('<IHBB')
+NOT_TRIGGERED = 0xffffffff
+
+# Same order as OC::TraceEvent
+EVENT_NAMES = [
+    'CORE_ISR',
+    'DISPLAY_FLUSH',
+    'DAC_UPDATE',
+    'DISPLAY_UPDATE',
+    'ADC_SCAN',
+    'DIGITAL_INPUTS_SCAN',
+    'APP_ISR',
+    'APPLET_ISR',
+    'UI_POLL',
+    'UI_EVENT',
+    'MENU_DRAW',
+    'DEFERRED',
+]
+
+ENTER, EXIT, INSTANT = 0, 1, 2
+
+CORE_ISR = EVENT_NAMES.index('CORE_ISR')
+APP_ISR = EVENT_NAMES.index('APP_ISR')
+APPLET_ISR = EVENT_NAMES.index('APPLET_ISR')
+UI_EVENT = EVENT_NAMES.index('UI_EVENT')
+
+def main(argv):
+    args = parse_args(argv)
+
+    if args.port:
+        data = fetch(args.port, args.timeout)
+        if args.save:
+            with open(args.save, 'wb') as f:
+                f.write(data)
+    else:
+        with open(args.input, 'rb') as f:
+            data = f.read()
+
+    trace = parse(data)
+    scopes, instants = match_scopes(trace)
+
+    print_summary(trace, scopes)
+    print_histograms(trace, scopes, args.bins)
+    print_worst(trace, scopes, instants, args.top)
+    return 0
+
+def fetch(port, timeout):
+    import serial  # pyserial, only needed to talk to the module
+
+    with serial.Serial(port, timeout=timeout) as s:
+        s.reset_input_buffer()
+        s.write(b'd')
+        header = s.read(HEADER.size)
+        if len(header) < HEADER.size:
+            raise SystemExit('No response from %s (firmware built with OC_ISR_TRACE?)' % port)
+        count = HEADER.unpack(header)[-1]
+        body = s.read(count * RECORD.size + 4)
+    return header + body
+
+def parse(data):
+    if len(data) < HEADER.size + 4:
+        raise SystemExit('Dump too short (%d bytes)' % len(data))
+
+    magic, version, record_size, f_cpu, timer_rate, trigger_cycles, trigger_index, count = \
+        HEADER.unpack_from(data)
+    if magic != b'OCTR' or version != 1 or record_size != RECORD.size:
+        raise SystemExit('Not a version 1 trace dump')
+
+    end = HEADER.size + count * RECORD.size
+    if len(data) < end + 4:
+        raise SystemExit('Dump truncated: %d of %d records' % ((len(data) - HEADER.size) // RECORD.size, count))
+    crc, = struct.unpack_from('<I', data, end)
+    if crc != zlib.crc32(data[:end]) & 0xffffffff:
+        raise SystemExit('CRC mismatch, dump is corrupt')
+
+    # Unwrap the 32-bit cycle counter into a monotonic timeline
+    records = []
+    t = 0
+    last = None
+    for i in range(count):
+        cycles, arg, event, flags = RECORD.unpack_from(data, HEADER.size + i * RECORD.size)
+        if last is not None:
+            t += (cycles - last) & 0xffffffff
+        last = cycles
+        records.append((t, event, flags, arg))
+
+    return {
+        'f_cpu': f_cpu,
+        'timer_rate': timer_rate,
+        'trigger_cycles': trigger_cycles,
+        'trigger_index': None if trigger_index == NOT_TRIGGERED else trigger_index,
+        'records': records,
+    }
+
+def match_scopes(trace):
+    """Pair up enter/exit records. Preemption always nests (the core ISR
+    interrupts the UI ISR, which interrupts loop()), so a single stack does.
+    Exits without an enter are from before the start of the ring and dropped.
+    """
+    scopes = []
+    instants = []
+    stack = []
+    for index, (t, event, flags, arg) in enumerate(trace['records']):
+        if flags == ENTER:
+            scope = {'event': event, 'arg': arg, 'start': t, 'end': None,
+                     'depth': len(stack), 'index': index, 'children': [],
+                     'preempted': [s['event'] for s in stack]}
+            if stack:
+                stack[-1]['children'].append(scope)
+            stack.append(scope)
+        elif flags == EXIT:
+            for depth in range(len(stack) - 1, -1, -1):
+                if stack[depth]['event'] == event and stack[depth]['arg'] == arg:
+                    scope = stack[depth]
+                    scope['end'] = t
+                    scope['exit_index'] = index
+                    scopes.append(scope)
+                    del stack[depth:]
+                    break
+        else:
+            instants.append((t, event, arg))
+    return scopes, instants
+
+def event_name(event, arg=None):
+    name = EVENT_NAMES[event] if event < len(EVENT_NAMES) else 'EVENT_%d' % event
+    if arg is None:
+        return name
+    if event == APP_ISR:
+        return '%s %s' % (name, app_id(arg))
+    if event == APPLET_ISR:
+        return '%s %s:%d' % (name, 'LR'[(arg >> 8) & 1], arg & 0xff)
+    if event == UI_EVENT:
+        return '%s type=%d control=0x%02x' % (name, arg & 0xff, arg >> 8)
+    return name
+
+def app_id(arg):
+    # App ids are two character codes, e.g. TWOCC<'H','S'>, first character in the high byte
+    chars = bytes([arg >> 8, arg & 0xff])
+    if all(32 <= c < 127 for c in chars):
+        return chars.decode('ascii')
+    return '0x%04x' % arg
+
+def us(trace, cycles):
+    return cycles * 1000000.0 / trace['f_cpu']
+
+def print_summary(trace, scopes):
+    isrs = [s for s in scopes if s['event'] == CORE_ISR]
+    period = trace['timer_rate']
+    print('## Trace')
+    print('')
+    print('%d records, %d complete core ISRs, %.1f ms' % (
+        len(trace['records']), len(isrs),
+        us(trace, trace['records'][-1][0]) / 1000.0 if trace['records'] else 0))
+    print('Core ISR period %dus, trigger at %.1fus%s' % (
+        period, us(trace, trace['trigger_cycles']),
+        '' if trace['trigger_index'] is not None else ' (not triggered)'))
+    overruns = [s for s in isrs if us(trace, s['end'] - s['start']) > period]
+    print('Overruns (ISR longer than its period): %d' % len(overruns))
+    print('')
+
+def print_histograms(trace, scopes, bins):
+    print('## Durations (us, inclusive)')
+    print('')
+
+    groups = {}
+    for s in scopes:
+        key = event_name(s['event'], s['arg'] if s['event'] in (APP_ISR, APPLET_ISR) else None)
+        groups.setdefault(key, []).append(us(trace, s['end'] - s['start']))
+
+    for key in sorted(groups):
+        values = sorted(groups[key])
+        n = len(values)
+        print('%s: n=%d min=%.1f median=%.1f p99=%.1f max=%.1f' % (
+            key, n, values[0], values[n // 2], values[min(n - 1, (n * 99) // 100)], values[-1]))
+
+        lo, hi = values[0], values[-1]
+        width = (hi - lo) / bins if hi > lo else 1.0
+        counts = [0] * bins
+        for v in values:
+            counts[min(bins - 1, int((v - lo) / width))] += 1
+        peak = max(counts)
+        for b, c in enumerate(counts):
+            if c:
+                print('  %7.1f-%7.1f %6d %s' % (lo + b * width, lo + (b + 1) * width, c,
+                                                '#' * max(1, (c * 40) // peak)))
+        print('')
+
+def print_worst(trace, scopes, instants, top):
+    isrs = sorted((s for s in scopes if s['event'] == CORE_ISR),
+                  key=lambda s: s['end'] - s['start'], reverse=True)
+
+    print('## Slowest core ISRs (top %d)' % min(top, len(isrs)))
+    print('')
+    for s in isrs[:top]:
+        marker = ''
+        trigger = trace['trigger_index']
+        if trigger is not None and s['index'] <= trigger <= s['exit_index']:
+            marker = ' <- trigger'
+        preempted = ', preempted ' + ' > '.join(EVENT_NAMES[e] for e in s['preempted']) if s['preempted'] else ''
+        print('%.1fus at %.3fms%s%s' % (us(trace, s['end'] - s['start']), us(trace, s['start']) / 1000.0,
+                                        preempted, marker))
+        print_stack(trace, s, 1)
+        during = [i for i in instants if s['start'] <= i[0] <= s['end']]
+        for t, event, arg in during:
+            print('    @%.1fus %s' % (us(trace, t - s['start']), event_name(event, arg)))
+        print('')
+
+def print_stack(trace, scope, depth):
+    for c in scope['children']:
+        if c['end'] is None:
+            continue
+        print('%s+%.1fus %s %.1fus' % ('  ' * depth, us(trace, c['start'] - scope['start']),
+                                     event_name(c['event'], c['arg']), us(trace, c['end'] - c['start'])))
+        print_stack(trace, c, depth + 1)
+
+def parse_args(argv):
+    """CLI arguments parsing
+
+    Args:
+        argv (list): list of args to be parsed
+
+    Returns:
+        ArgumentParser: Parsed arguments
+    """
+    parser = argparse.ArgumentParser(
+        description='Fetch and decode an ISR trace from firmware built with OC_ISR_TRACE.',
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--port', help='USB serial port to request a dump from (needs pyserial)')
+    source.add_argument('--input', help='Previously saved dump')
+    parser.add_argument('--save', help='Also save the raw dump fetched from --port to this file')
+    parser.add_argument('--timeout', help='Serial read timeout in seconds', type=float, default=2.0)
+    parser.add_argument('--bins', help='Histogram bins per phase', type=int, default=10)
+    parser.add_argument('--top', help='Number of slowest ISRs to list', type=int, default=5)
+
+    res = parser.parse_args(argv[1:])
+
+    return res
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+import os.path as path
+import argparse
+import subprocess
+import sys
+
+"""This script is used to report how much flash and RAM the firmware uses,
+in total and per symbol, from the ELF that PlatformIO builds
+"""
+
+FLASH_SIZE = 256 * 1024  # MK20DX256
+RAM_SIZE = 64 * 1024
+
+# Teensy 3 linker script sections; .data is stored in flash and copied to RAM
+FLASH_SECTIONS = ['.text', '.ARM.exidx', '.data']
+RAM_SECTIONS = ['.data', '.bss', '.usbdescriptortable', '.dmabuffers', '.usbbuffers']
+
+# nm symbol types: text and read-only data live in flash, initialized data
+# is stored in flash and copied to RAM, bss only takes RAM
+FLASH_TYPES = 'tTrRvVwW'
+DATA_TYPES = 'dD'
+BSS_TYPES = 'bB'
+
+def main(argv):
+    args = parse_args(argv)
+
+    if not path.isfile(args.elf):
+        print('ELF not found: %s (build first?)' % args.elf)
+        return 1
+
+    symbols = read_symbols(args.nm, args.elf)
+
+    flash = [s for s in symbols if s['type'] in FLASH_TYPES + DATA_TYPES]
+    ram = [s for s in symbols if s['type'] in DATA_TYPES + BSS_TYPES]
+
+    if args.filter:
+        flash = [s for s in flash if args.filter in s['name']]
+        ram = [s for s in ram if args.filter in s['name']]
+
+    print_totals(args.size, args.elf)
+    print_top('FLASH', flash, args.count)
+    print_top('RAM', ram, args.count)
+    return 0
+
+def read_symbols(nm, elf):
+    output = subprocess.check_output([nm, '--print-size', '--size-sort', '--demangle', elf],
+                                     universal_newlines=True)
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) < 4:
+            continue
+        symbols.append({
+            'size': int(fields[1], 16),
+            'type': fields[2],
+            'name': fields[3]
+        })
+    return symbols
+
+def print_totals(size, elf):
+    output = subprocess.check_output([size, '-A', elf], universal_newlines=True)
+    sections = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 3 and fields[1].isdigit():
+            sections[fields[0]] = int(fields[1])
+
+    flash = sum(sections.get(name, 0) for name in FLASH_SECTIONS)
+    ram = sum(sections.get(name, 0) for name in RAM_SECTIONS)
+
+    print('## Totals')
+    print('')
+    print('FLASH %7d / %7d (%5.1f%%), %7d free' % (flash, FLASH_SIZE, 100.0 * flash / FLASH_SIZE, FLASH_SIZE - flash))
+    print('RAM   %7d / %7d (%5.1f%%), %7d free (before stack)' % (ram, RAM_SIZE, 100.0 * ram / RAM_SIZE, RAM_SIZE - ram))
+    print('')
+
+def print_top(title, symbols, count):
+    symbols = sorted(symbols, key=lambda s: s['size'], reverse=True)
+    total = sum(s['size'] for s in symbols)
+
+    print('## %s (top %d of %d symbols, %d bytes)' % (title, min(count, len(symbols)), len(symbols), total))
+    print('')
+    for s in symbols[:count]:
+        print('%7d %s %s' % (s['size'], s['type'], s['name']))
+    print('')
+
+def parse_args(argv):
+    """CLI arguments parsing
+
+    Args:
+        argv (list): list of args to be parsed
+
+    Returns:
+        ArgumentParser: Parsed arguments
+    """
+    parser = argparse.ArgumentParser(
+        description='Report flash and RAM usage per symbol. Requires the firmware ELF and the arm-none-eabi binutils.',
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('--elf', help='Firmware ELF',
+                        default='./software/.pio/build/teensy31/firmware.elf')
+    parser.add_argument('--nm', help='nm executable', default='arm-none-eabi-nm')
+    parser.add_argument('--size', help='size executable', default='arm-none-eabi-size')
+    parser.add_argument('--count', help='Number of symbols to list', type=int, default=40)
+    parser.add_argument('--filter', help='Only list symbols containing this string, e.g. Strings::')
+
+    res = parser.parse_args(argv[1:])
+
+    return res
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
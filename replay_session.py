@@ -0,0 +1,369 @@
+#!/usr/bin/env python3
+import argparse
+import gzip
+import sys
+import threading
+import time
+
+"""This script is used to record input sessions from, and replay them to,
+firmware built with OC_INPUT_REPLAY (see software/src/OC_replay.h), and to
+compare the DAC outputs of two replays tick by tick, e.g. before and after a
+change to an app.
+
+Session files (.gz is compressed transparently), after an 8 byte header
+    char magic[4] = "OCRS", u8 version, u8 first ADC scan channel, u16 app id
+have one or more bytes per core tick:
+    00dddddd        one tick, ADC delta d (6 bit zigzag), nothing else changed
+    1nnnnnnn        n + 1 ticks with nothing changed
+    01000fea ...    one tick, followed by
+                    a: ADC delta (zigzag varint), otherwise it's 0
+                    f: digital inputs byte (levels | clocked << 4)
+                    e: UI event (u8 type, varint control, zigzag value,
+                       varint mask, zigzag accelerated)
+    01001000        end of session
+    01010000 n      n ticks were lost while recording, varint
+The ADC delta is against the previous value of the same channel; the scan
+channel advances by one every tick.
+
+Output files, after an 8 byte header
+    char magic[4] = "OCRO", u8 version, u8 channels, u16 app id
+have one or more bytes per tick:
+    0000mmmm ...    one tick, zigzag varint deltas for the channels in mask m
+    1nnnnnnn        n + 1 ticks with no changes
+    01000000        end
+"""
+
+VERSION = 1
+HEADER_SIZE = 8
+ADC_CHANNELS = 4
+
+TICK_RUN = 0x80
+TICK_FLAGS = 0x40
+TICK_ADC = 0x01
+TICK_DIGITAL = 0x02
+TICK_EVENT = 0x04
+TICK_END = 0x48
+TICK_GAP = 0x50
+OUTPUTS_END = 0x40
+
+# Same order as UI::EventType
+EVENT_TYPES = ['NONE', 'BUTTON_PRESS', 'BUTTON_LONG_PRESS', 'ENCODER']
+
+class Truncated(Exception):
+    pass
+
+class Reader(object):
+    def __init__(self, data, pos=0):
+        self.data = data
+        self.pos = pos
+
+    def get(self):
+        if self.pos >= len(self.data):
+            raise Truncated()
+        value = self.data[self.pos]
+        self.pos += 1
+        return value
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            byte = self.get()
+            value |= (byte & 0x7f) << shift
+            if not byte & 0x80:
+                return value
+            shift += 7
+
+    def zigzag(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+def main(argv):
+    args = parse_args(argv)
+    return args.func(args)
+
+def open_file(path, mode):
+    if path.endswith('.gz'):
+        return gzip.open(path, mode)
+    return open(path, mode)
+
+def read_file(path):
+    with open_file(path, 'rb') as f:
+        return f.read()
+
+def write_file(path, data):
+    with open_file(path, 'wb') as f:
+        f.write(data)
+
+def parse_header(data, magic):
+    if len(data) < HEADER_SIZE or data[:4] != magic:
+        raise SystemExit('Not a %s stream' % magic.decode('ascii'))
+    if data[4] != VERSION:
+        raise SystemExit('Unsupported %s version %d' % (magic.decode('ascii'), data[4]))
+    return data[5], data[6] | data[7] << 8
+
+def decode_session(data):
+    """Returns (header, ticks, complete); each tick is a dict with the ADC
+    channel and value, levels, clocked and the event (or None). Lost ticks
+    are reported as a single {'lost': n} entry.
+    """
+    first_channel, app = parse_header(data, b'OCRS')
+    adc = [0] * ADC_CHANNELS
+    digital = 0
+    channel = first_channel
+    ticks = []
+    reader = Reader(data, HEADER_SIZE)
+
+    def tick(delta, event=None):
+        nonlocal channel
+        adc[channel] = (adc[channel] + delta) & 0xffff
+        ticks.append({'channel': channel, 'adc': adc[channel], 'levels': digital & 0x0f,
+                      'clocked': digital >> 4, 'event': event})
+        channel = (channel + 1) % ADC_CHANNELS
+
+    try:
+        while True:
+            op = reader.get()
+            if op & TICK_RUN:
+                for _ in range((op & 0x7f) + 1):
+                    tick(0)
+            elif not op & TICK_FLAGS:
+                tick((op >> 1) ^ -(op & 1))
+            elif op == TICK_END:
+                return (first_channel, app), ticks, True
+            elif op == TICK_GAP:
+                lost = reader.varint()
+                ticks.append({'lost': lost})
+                channel = (channel + lost) % ADC_CHANNELS
+            else:
+                delta = reader.zigzag() if op & TICK_ADC else 0
+                if op & TICK_DIGITAL:
+                    digital = reader.get()
+                event = None
+                if op & TICK_EVENT:
+                    event = (reader.get(), reader.varint(), reader.zigzag(), reader.varint(), reader.zigzag())
+                tick(delta, event)
+    except Truncated:
+        return (first_channel, app), ticks, False
+
+def decode_outputs(data):
+    """Returns (header, ticks, complete); each tick is a tuple of DAC values"""
+    channels, app = parse_header(data, b'OCRO')
+    values = [0] * channels
+    ticks = []
+    reader = Reader(data, HEADER_SIZE)
+    try:
+        while True:
+            op = reader.get()
+            if op & TICK_RUN:
+                ticks.extend([tuple(values)] * ((op & 0x7f) + 1))
+            elif op == OUTPUTS_END:
+                return (channels, app), ticks, True
+            else:
+                for i in range(channels):
+                    if op & (1 << i):
+                        values[i] = (values[i] + reader.zigzag()) & 0xffff
+                ticks.append(tuple(values))
+    except Truncated:
+        return (channels, app), ticks, False
+
+def app_id(value):
+    # TWOCC, first character in the high byte
+    chars = bytes([value >> 8, value & 0xff])
+    if all(32 <= c < 127 for c in chars):
+        return chars.decode('ascii')
+    return '0x%04x' % value
+
+def event_name(event):
+    etype, control, value, mask, accelerated = event
+    name = EVENT_TYPES[etype] if etype < len(EVENT_TYPES) else 'EVENT_%d' % etype
+    return '%s control=0x%02x value=%d mask=0x%x accelerated=%d' % (name, control, value, mask, accelerated)
+
+def read_until_idle(s, idle):
+    data = bytearray()
+    last = time.time()
+    while time.time() - last < idle:
+        chunk = s.read(s.in_waiting or 1)
+        if chunk:
+            data += chunk
+            last = time.time()
+    return bytes(data)
+
+def record(args):
+    import serial  # pyserial, only needed to talk to the module
+
+    with serial.Serial(args.port, timeout=0.1) as s:
+        s.reset_input_buffer()
+        s.write(b'r')
+        data = bytearray()
+        print('Recording, press Ctrl-C to stop')
+        try:
+            while True:
+                data += s.read(s.in_waiting or 1)
+        except KeyboardInterrupt:
+            pass
+        s.write(b's')
+        data += read_until_idle(s, args.timeout)
+
+    data = bytes(data)
+    header, ticks, complete = decode_session(data)
+    if not complete:
+        raise SystemExit('Session incomplete (%d ticks received)' % len(ticks))
+    write_file(args.out, data)
+    print_session_summary(header, ticks)
+    return 0
+
+def replay(args):
+    import serial  # pyserial, only needed to talk to the module
+
+    session = read_file(args.input)
+    header, ticks, complete = decode_session(session)
+    if not complete:
+        raise SystemExit('%s is incomplete' % args.input)
+
+    received = bytearray()
+    sent = threading.Event()
+
+    with serial.Serial(args.port, timeout=0.1) as s:
+        s.reset_input_buffer()
+
+        # Read concurrently so neither side blocks on a full buffer. The
+        # module stops sending once the replay has ended.
+        def reader():
+            last = time.time()
+            while not sent.is_set() or time.time() - last < args.timeout:
+                chunk = s.read(s.in_waiting or 1)
+                if chunk:
+                    received.extend(chunk)
+                    last = time.time()
+
+        thread = threading.Thread(target=reader)
+        thread.start()
+        s.write(b'p')
+        s.write(session)
+        sent.set()
+        thread.join()
+
+    data = bytes(received)
+    out_header, outputs, complete = decode_outputs(data)
+    if not complete:
+        raise SystemExit('Replay incomplete, %d ticks of output received' % len(outputs))
+    if out_header[1] != header[1]:
+        print('Warning: recorded with app %s, replayed on app %s' % (app_id(header[1]), app_id(out_header[1])))
+    write_file(args.out, data)
+    print('%d ticks replayed, %d ticks of output' % (sum(1 for t in ticks if 'lost' not in t), len(outputs)))
+    return 0
+
+def compare(args):
+    header_a, a, complete_a = decode_outputs(read_file(args.a))
+    header_b, b, complete_b = decode_outputs(read_file(args.b))
+    for path, complete in ((args.a, complete_a), (args.b, complete_b)):
+        if not complete:
+            print('Warning: %s is incomplete' % path)
+    if header_a[1] != header_b[1]:
+        print('Warning: apps differ (%s vs %s)' % (app_id(header_a[1]), app_id(header_b[1])))
+
+    diffs = 0
+    first = None
+    for tick, (va, vb) in enumerate(zip(a, b)):
+        if va != vb:
+            diffs += 1
+            if first is None:
+                first = tick
+                channel = next(i for i in range(len(va)) if va[i] != vb[i])
+                print('First difference at tick %d, channel %d: %d vs %d' % (tick, channel, va[channel], vb[channel]))
+    if len(a) != len(b):
+        print('Lengths differ: %d vs %d ticks' % (len(a), len(b)))
+    if diffs:
+        print('%d of %d ticks differ' % (diffs, min(len(a), len(b))))
+    if not diffs and len(a) == len(b):
+        print('%d ticks identical' % len(a))
+        return 0
+    return 1
+
+def dump(args):
+    data = read_file(args.input)
+    if data[:4] == b'OCRO':
+        header, outputs, complete = decode_outputs(data)
+        print('Outputs: %d channels, app %s, %d ticks%s' % (
+            header[0], app_id(header[1]), len(outputs), '' if complete else ' (incomplete)'))
+        last = None
+        for tick, values in enumerate(outputs):
+            if values != last or args.all:
+                print('%8d %s' % (tick, ' '.join('%5d' % v for v in values)))
+            last = values
+        return 0
+
+    header, ticks, complete = decode_session(data)
+    print_session_summary(header, ticks)
+    if not complete:
+        print('(incomplete)')
+    index = 0
+    last = None
+    for t in ticks:
+        if 'lost' in t:
+            print('%8d -- %d ticks lost' % (index, t['lost']))
+            continue
+        state = (t['levels'], t['clocked'])
+        if args.all or t['event'] or state != last:
+            print('%8d adc%d=%4d levels=%x clocked=%x%s' % (
+                index, t['channel'] + 1, t['adc'], t['levels'], t['clocked'],
+                ' ' + event_name(t['event']) if t['event'] else ''))
+        last = state
+        index += 1
+    return 0
+
+def print_session_summary(header, ticks):
+    count = sum(1 for t in ticks if 'lost' not in t)
+    lost = sum(t['lost'] for t in ticks if 'lost' in t)
+    events = sum(1 for t in ticks if t.get('event'))
+    print('Session: app %s, %d ticks, %d UI events, %d ticks lost' % (app_id(header[1]), count, events, lost))
+
+def parse_args(argv):
+    """CLI arguments parsing
+
+    Args:
+        argv (list): list of args to be parsed
+
+    Returns:
+        ArgumentParser: Parsed arguments
+    """
+    parser = argparse.ArgumentParser(
+        description='Record, replay and compare input sessions with firmware built with OC_INPUT_REPLAY.',
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    commands = parser.add_subparsers(dest='command')
+    commands.required = True
+
+    p = commands.add_parser('record', help='Record a session until Ctrl-C',
+                            formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    p.add_argument('--port', help='USB serial port (needs pyserial)', required=True)
+    p.add_argument('--out', help='Session file to write (.gz to compress)', required=True)
+    p.add_argument('--timeout', help='Seconds without data that end the transfer', type=float, default=1.0)
+    p.set_defaults(func=record)
+
+    p = commands.add_parser('replay', help='Replay a session and save the outputs',
+                            formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    p.add_argument('--port', help='USB serial port (needs pyserial)', required=True)
+    p.add_argument('--input', help='Session file to replay', required=True)
+    p.add_argument('--out', help='Outputs file to write (.gz to compress)', required=True)
+    p.add_argument('--timeout', help='Seconds without data that abort the replay', type=float, default=2.0)
+    p.set_defaults(func=replay)
+
+    p = commands.add_parser('compare', help='Compare two outputs files tick by tick',
+                            formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    p.add_argument('a', help='Outputs file')
+    p.add_argument('b', help='Outputs file')
+    p.set_defaults(func=compare)
+
+    p = commands.add_parser('dump', help='Print a session or outputs file',
+                            formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    p.add_argument('input', help='Session or outputs file')
+    p.add_argument('--all', help='Print every tick, not only changes', action='store_true')
+    p.set_defaults(func=dump)
+
+    res = parser.parse_args(argv[1:])
+
+    return res
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,45 @@
+#include "host_app.h"
+#include "OC_ADC.h"
+#include "OC_DAC.h"
+#include "OC_digital_inputs.h"
+#include "OC_ui.h"
+
+// Stand-in app that touches every input, so sessions can be checked end to
+// end: sample and hold of CV 1 on clock 1, CV 2 followed, clock 2 counter,
+// and encoder position gated by trigger input 3.
+
+namespace HostApp {
+
+const uint16_t kId = 0x4854; // "HT"
+
+static uint32_t held;
+static uint32_t clocks;
+static int32_t position;
+
+void Init() {
+  held = clocks = 0;
+  position = 0;
+}
+
+void ISR() {
+  const uint32_t clocked = OC::DigitalInputs::clocked();
+  if (clocked & 0x01)
+    held = OC::ADC::raw_value(ADC_CHANNEL_1);
+  if (clocked & 0x02)
+    ++clocks;
+
+  for (const UI::Event &event : OC::ui.events) {
+    if (UI::EVENT_ENCODER == event.type)
+      position += event.accelerated;
+    else if (UI::EVENT_BUTTON_PRESS == event.type)
+      position = 0;
+  }
+  OC::ui.events.clear();
+
+  OC::DAC::set(DAC_CHANNEL_A, held << 4);
+  OC::DAC::set(DAC_CHANNEL_B, OC::ADC::raw_value(ADC_CHANNEL_2) << 4);
+  OC::DAC::set(DAC_CHANNEL_C, (clocks * 257) & 0xffff);
+  OC::DAC::set(DAC_CHANNEL_D, (OC::DigitalInputs::levels() & 0x04) ? (32768 + position) & 0xffff : 0);
+}
+
+}; // namespace HostApp
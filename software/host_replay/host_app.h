@@ -0,0 +1,19 @@
+#ifndef HOST_APP_H_
+#define HOST_APP_H_
+
+#include <stdint.h>
+
+// The app that the host build drives. Its ISR runs once per core tick, reads
+// the mocked inputs (OC::ADC, OC::DigitalInputs, and OC::ui.events, which it
+// should consume) and sets the mocked DAC. Link a different implementation
+// with APP_SRC=... to replay sessions against other code.
+namespace HostApp {
+
+extern const uint16_t kId; // Written to the session and outputs headers
+
+void Init();
+void ISR();
+
+}; // namespace HostApp
+
+#endif // HOST_APP_H_
@@ -0,0 +1,258 @@
+// Replays input sessions (see OC_replay.h) on the host, against the firmware's
+// own recorder and decoder and a mocked core ISR, so outputs can be compared
+// with replay_session.py without a module.
+//
+//   host_replay [--text FILE] [--poll N] SESSION OUTPUTS
+//     Replays SESSION (uncompressed) into the app and writes the outputs file;
+//     prints the replay speed in ticks/s.
+//   host_replay --generate TICKS [--seed N] [--text FILE] [--poll N] SESSION
+//     Records a pseudo-random session through the recorder, while running the
+//     app on the live inputs.
+//
+// --text writes the DAC values after each tick, one line per tick, so a
+// generated session and its replay can be compared with cmp. --poll sets how
+// many core ticks run between loop() passes.
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#include "Arduino.h"
+#include "OC_ADC.h"
+#include "OC_apps.h"
+#include "OC_core.h"
+#include "OC_DAC.h"
+#include "OC_digital_inputs.h"
+#include "OC_replay.h"
+#include "OC_ui.h"
+#include "host_app.h"
+#include "src/drivers/FreqMeasure/OC_FreqMeasure.h"
+
+HostSerial Serial;
+HostGraphics graphics;
+HostFreqMeasure FreqMeasure;
+
+namespace OC {
+
+volatile uint32_t CORE::ticks;
+
+size_t ADC::scan_channel_;
+uint16_t ADC::raw_[ADC_CHANNEL_LAST];
+uint32_t DAC::values_[DAC_CHANNEL_LAST];
+uint32_t DigitalInputs::clocked_mask_;
+uint32_t DigitalInputs::levels_;
+bool DigitalInputs::injecting_;
+Ui ui;
+
+static App host_app = { HostApp::kId };
+App *apps::current_app = &host_app;
+
+}; // namespace OC
+
+namespace {
+
+struct Options {
+  uint32_t generate = 0;
+  uint32_t seed = 1;
+  uint32_t poll = 4;
+  const char *text = nullptr;
+};
+
+FILE *text_file;
+
+// Same order as CORE_timer_ISR; returns false if the tick was held
+bool CoreTick(uint16_t adc, uint32_t clocked, uint32_t levels) {
+  if (!OC::Replay::replaying())
+    OC::ADC::Scan(adc);
+  OC::DigitalInputs::Scan(clocked, levels);
+  if (!OC::Replay::ProcessInputs())
+    return false;
+
+  ++OC::CORE::ticks;
+  HostApp::ISR();
+  OC::Replay::ProcessOutputs();
+
+  if (text_file) {
+    fprintf(text_file, "%u %u %u %u\n",
+            OC::DAC::value(DAC_CHANNEL_A), OC::DAC::value(DAC_CHANNEL_B),
+            OC::DAC::value(DAC_CHANNEL_C), OC::DAC::value(DAC_CHANNEL_D));
+  }
+  return true;
+}
+
+uint32_t xorshift(uint32_t &state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+bool ReadFile(const char *path, std::vector<uint8_t> &data) {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return false;
+  uint8_t buffer[4096];
+  size_t length;
+  while ((length = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    data.insert(data.end(), buffer, buffer + length);
+  fclose(f);
+  return true;
+}
+
+bool WriteFile(const char *path, const std::vector<uint8_t> &data) {
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+  bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+  return fclose(f) == 0 && ok;
+}
+
+// Slowly wandering CVs with occasional jumps, clocks, gate changes and
+// encoder/button events
+int Generate(const Options &options, const char *session_path) {
+  uint32_t random = options.seed ? options.seed : 1;
+  uint16_t cv[ADC_CHANNEL_LAST] = { 2048, 1024, 3072, 0 };
+  uint32_t levels = 0;
+
+  Serial.in.push_back('r');
+  OC::Replay::Poll();
+
+  for (uint32_t tick = 0; tick < options.generate; ++tick) {
+    const size_t channel = OC::ADC::scan_channel();
+    uint32_t r = xorshift(random);
+    if (r % 3 == 0) cv[channel] = (cv[channel] + (r >> 8) % 9 - 4) & 0xfff;
+    if (r % 64 == 1) cv[channel] = (r >> 12) & 0xfff;
+    if (r % 256 == 2) levels ^= 1 << ((r >> 8) % 4);
+    uint32_t clocked = (r % 128 == 3) ? 1 << ((r >> 8) % 4) : 0;
+
+    if (r % 512 == 4) {
+      uint32_t e = xorshift(random);
+      UI::Event event = (e & 0x0f)
+          ? UI::Event(UI::EVENT_ENCODER, OC::CONTROL_ENCODER_L << (e >> 4) % 2, (e >> 8) % 7 - 3, 0, (e >> 12) % 41 - 20)
+          : UI::Event(UI::EVENT_BUTTON_PRESS, OC::CONTROL_BUTTON_UP << (e >> 4) % 4, 0, 0);
+      if (OC::Replay::FilterEvent(event))
+        OC::ui.InjectEvent(event);
+    }
+
+    CoreTick(cv[channel], clocked, levels);
+    if (tick % options.poll == 0)
+      OC::Replay::Poll();
+  }
+
+  Serial.in.push_back('s');
+  OC::Replay::Poll();
+
+  fprintf(stderr, "Recorded %u ticks, %u lost, %zu bytes\n",
+          OC::Replay::ticks(), OC::Replay::overflows(), Serial.out.size());
+  if (!WriteFile(session_path, Serial.out)) {
+    fprintf(stderr, "Can't write %s\n", session_path);
+    return 1;
+  }
+  return OC::Replay::overflows() ? 1 : 0;
+}
+
+int Replay(const Options &options, const char *session_path, const char *outputs_path) {
+  Serial.in.push_back('p');
+  if (!ReadFile(session_path, Serial.in)) {
+    fprintf(stderr, "Can't read %s\n", session_path);
+    return 1;
+  }
+
+  uint32_t ticks = 0, held = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  OC::Replay::Poll(); // 'p'
+  OC::Replay::Poll(); // Header
+  if (!OC::Replay::replaying()) {
+    fprintf(stderr, "%s is not a session\n", session_path);
+    return 1;
+  }
+
+  bool truncated = false;
+  while (OC::Replay::replaying()) {
+    uint32_t ran = 0;
+    for (uint32_t i = 0; i < options.poll; ++i) {
+      if (CoreTick(0, 0, 0))
+        ++ran;
+      else
+        ++held;
+    }
+    ticks += ran;
+    // Nothing left to decode and no end marker; loop() would wait forever
+    if (!ran && !Serial.available()) {
+      truncated = true;
+      break;
+    }
+    OC::Replay::Poll();
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  double rate = elapsed.count() > 0 ? ticks / elapsed.count() : 0;
+  fprintf(stderr, "Replayed %u ticks (%u held) in %.3fs: %.0f ticks/s, %.1fx real time\n",
+          ticks, held, elapsed.count(), rate, rate / OC_CORE_ISR_FREQ);
+  if (truncated) {
+    fprintf(stderr, "%s is truncated\n", session_path);
+    return 1;
+  }
+
+  if (!WriteFile(outputs_path, Serial.out)) {
+    fprintf(stderr, "Can't write %s\n", outputs_path);
+    return 1;
+  }
+  return 0;
+}
+
+void Usage() {
+  fprintf(stderr,
+          "usage: host_replay [--text FILE] [--poll N] SESSION OUTPUTS\n"
+          "       host_replay --generate TICKS [--seed N] [--text FILE] [--poll N] SESSION\n");
+}
+
+}; // namespace
+
+int main(int argc, char **argv) {
+  static const struct option long_options[] = {
+    { "generate", required_argument, nullptr, 'g' },
+    { "seed", required_argument, nullptr, 's' },
+    { "poll", required_argument, nullptr, 'p' },
+    { "text", required_argument, nullptr, 't' },
+    { nullptr, 0, nullptr, 0 }
+  };
+
+  Options options;
+  int c;
+  while ((c = getopt_long(argc, argv, "", long_options, nullptr)) != -1) {
+    switch (c) {
+      case 'g': options.generate = strtoul(optarg, nullptr, 0); break;
+      case 's': options.seed = strtoul(optarg, nullptr, 0); break;
+      case 'p': options.poll = strtoul(optarg, nullptr, 0); break;
+      case 't': options.text = optarg; break;
+      default: Usage(); return 2;
+    }
+  }
+  const int files = options.generate ? 1 : 2;
+  if (argc - optind != files || !options.poll) {
+    Usage();
+    return 2;
+  }
+
+  if (options.text) {
+    text_file = fopen(options.text, "w");
+    if (!text_file) {
+      fprintf(stderr, "Can't write %s\n", options.text);
+      return 1;
+    }
+  }
+
+  OC::Replay::Init();
+  HostApp::Init();
+  int result = options.generate
+      ? Generate(options, argv[optind])
+      : Replay(options, argv[optind], argv[optind + 1]);
+
+  if (text_file)
+    fclose(text_file);
+  return result;
+}
@@ -0,0 +1,71 @@
+#include <Arduino.h>
+#include <new>
+#include "cortex_m4_divide.h"
+#include "host_app.h"
+#include "OC_core.h"
+#include "OC_ui.h"
+#include "util/util_misc.h"
+#include "HEM_Slew.h"
+
+// The Slew applet (HEM_Slew.h, unmodified) in both hemispheres, driven the
+// way HemisphereManager does it: the CV input manager is updated once per
+// tick and then each hemisphere's controller runs. Encoders and the L/R
+// buttons go to their hemisphere's applet like in DelegateEncoderMovement()
+// and DelegateEncoderPush(); the select buttons are ignored, as there is only
+// the one applet to select.
+//
+// Channel B divides by zero when it's one tick from its target (the halved
+// ticks_to_remaining), so divisions behave as on the module, see
+// host_tests/cortex_m4_divide.h.
+
+namespace HS {
+
+struct AppletArena {
+  alignas(Slew) uint8_t storage[sizeof(Slew)];
+};
+
+static AppletArena applet_arena[2];
+
+inline void *AppletStorage(bool hemisphere) {
+  return applet_arena[hemisphere].storage;
+}
+
+}; // namespace HS
+
+// HemisphereApplet only declares these, which the firmware gets away with
+// because its base vtable is optimized out. The host compiler needs it.
+const char *HemisphereApplet::applet_name() { return ""; }
+void HemisphereApplet::Start() { }
+void HemisphereApplet::Controller() { }
+void HemisphereApplet::View() { }
+void HemisphereApplet::SetHelp() { }
+
+namespace HostApp {
+
+const uint16_t kId = 0x534c; // "SL"
+
+void Init() {
+  InstallDivideHandler();
+  for (int h = 0; h < 2; ++h) {
+    new (HS::AppletStorage(h)) Slew();
+    Slew_Start(h);
+  }
+}
+
+void ISR() {
+  for (const UI::Event &event : OC::ui.events) {
+    if (UI::EVENT_ENCODER == event.type) {
+      Slew_OnEncoderMove(event.control == OC::CONTROL_ENCODER_L ? LEFT_HEMISPHERE : RIGHT_HEMISPHERE, event.value);
+    } else if (UI::EVENT_BUTTON_PRESS == event.type) {
+      if (event.control == OC::CONTROL_BUTTON_L) Slew_OnButtonPress(LEFT_HEMISPHERE);
+      if (event.control == OC::CONTROL_BUTTON_R) Slew_OnButtonPress(RIGHT_HEMISPHERE);
+    }
+  }
+  OC::ui.events.clear();
+
+  CVInputManager::get()->Update();
+  for (int h = 0; h < 2; ++h)
+    Slew_Controller(h, false);
+}
+
+}; // namespace HostApp
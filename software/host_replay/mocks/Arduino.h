@@ -0,0 +1,45 @@
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+// The parts of the Teensy core that OC_replay.cpp, the applets and their
+// headers use. USB serial is a pair of byte buffers that the driver fills and
+// drains.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+typedef uint8_t byte;
+
+template <typename T, typename L, typename H>
+inline T constrain(T x, L low, H high) {
+  return x < low ? low : (x > high ? high : x);
+}
+
+class HostSerial {
+public:
+  std::vector<uint8_t> in;
+  std::vector<uint8_t> out;
+  size_t in_pos = 0;
+
+  int available() {
+    return static_cast<int>(in.size() - in_pos);
+  }
+
+  int read() {
+    return in_pos < in.size() ? in[in_pos++] : -1;
+  }
+
+  size_t write(const uint8_t *buffer, size_t size) {
+    out.insert(out.end(), buffer, buffer + size);
+    return size;
+  }
+
+  void send_now() { }
+};
+
+extern HostSerial Serial;
+
+#endif // HOST_ARDUINO_H_
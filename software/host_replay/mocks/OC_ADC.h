@@ -0,0 +1,57 @@
+#ifndef HOST_OC_ADC_H_
+#define HOST_OC_ADC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum ADC_CHANNEL {
+  ADC_CHANNEL_1,
+  ADC_CHANNEL_2,
+  ADC_CHANNEL_3,
+  ADC_CHANNEL_4,
+  ADC_CHANNEL_LAST,
+};
+
+namespace OC {
+
+// Holds the last value per channel; the driver plays the part of Scan
+class ADC {
+public:
+  static inline size_t scan_channel() {
+    return scan_channel_;
+  }
+
+  static inline void set_scan_channel(size_t channel) {
+    scan_channel_ = channel;
+  }
+
+  static void Scan(uint16_t value) {
+    raw_[scan_channel_] = value;
+    scan_channel_ = (scan_channel_ + 1) % ADC_CHANNEL_LAST;
+  }
+
+  static void Inject(uint16_t value) {
+    Scan(value);
+  }
+
+  static uint32_t raw_value(ADC_CHANNEL channel) {
+    return raw_[channel];
+  }
+
+  // With the default calibration: _ADC_OFFSET (0V at 2.2V) and
+  // kDefaultPitchCVScale
+  static int32_t raw_pitch_value(ADC_CHANNEL channel) {
+    int32_t value = kDefaultOffset - static_cast<int32_t>(raw_value(channel));
+    return (value * kDefaultPitchCVScale) >> 12;
+  }
+
+  static const int32_t kDefaultOffset = 2730;
+  static const int32_t kDefaultPitchCVScale = 120 << 7;
+
+  static size_t scan_channel_;
+  static uint16_t raw_[ADC_CHANNEL_LAST];
+};
+
+}; // namespace OC
+
+#endif // HOST_OC_ADC_H_
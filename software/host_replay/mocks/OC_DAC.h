@@ -0,0 +1,56 @@
+#ifndef HOST_OC_DAC_H_
+#define HOST_OC_DAC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum DAC_CHANNEL {
+  DAC_CHANNEL_A, DAC_CHANNEL_B, DAC_CHANNEL_C, DAC_CHANNEL_D, DAC_CHANNEL_LAST
+};
+
+namespace OC {
+
+class DAC {
+public:
+  static const int kOctaveZero = 3;
+
+  static void set(size_t index, uint32_t value) {
+    values_[index] = value;
+  }
+
+  // As the driver does it, with the calibration that calibration_reset()
+  // leaves: the default octaves plus DAC_OFFSET, the same for all channels
+  static int32_t pitch_to_dac(DAC_CHANNEL, int32_t pitch, int32_t octave_offset) {
+    static const int32_t calibrated_octaves[11] = {
+      4890, 11443, 17997, 24551, 31104, 37658, 44211, 50765, 57318, 63871, 65535
+    };
+
+    pitch += (kOctaveZero + octave_offset) * 12 << 7;
+    if (pitch < 0) pitch = 0;
+    if (pitch > (120 << 7)) pitch = 120 << 7;
+
+    const int32_t octave = pitch / (12 << 7);
+    const int32_t fractional = pitch - octave * (12 << 7);
+
+    int32_t sample = calibrated_octaves[octave];
+    if (fractional) {
+      int32_t span = calibrated_octaves[octave + 1] - sample;
+      sample += (fractional * span) / (12 << 7);
+    }
+    return sample;
+  }
+
+  static void set_pitch(DAC_CHANNEL channel, int32_t pitch, int32_t octave_offset) {
+    set(channel, pitch_to_dac(channel, pitch, octave_offset));
+  }
+
+  static uint32_t value(size_t index) {
+    return values_[index];
+  }
+
+  static uint32_t values_[DAC_CHANNEL_LAST];
+};
+
+}; // namespace OC
+
+#endif // HOST_OC_DAC_H_
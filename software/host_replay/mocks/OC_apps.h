@@ -0,0 +1,18 @@
+#ifndef HOST_OC_APPS_H_
+#define HOST_OC_APPS_H_
+
+#include <stdint.h>
+
+namespace OC {
+
+struct App {
+  uint16_t id;
+};
+
+namespace apps {
+  extern App *current_app;
+};
+
+}; // namespace OC
+
+#endif // HOST_OC_APPS_H_
@@ -0,0 +1,14 @@
+#ifndef HOST_OC_CORE_H_
+#define HOST_OC_CORE_H_
+
+#include <stdint.h>
+#include "OC_config.h"
+#include "src/drivers/display.h"
+
+namespace OC {
+  namespace CORE {
+  extern volatile uint32_t ticks;
+  }; // namespace CORE
+}; // namespace OC
+
+#endif // HOST_OC_CORE_H_
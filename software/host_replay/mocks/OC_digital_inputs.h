@@ -0,0 +1,61 @@
+#ifndef HOST_OC_DIGITAL_INPUTS_H_
+#define HOST_OC_DIGITAL_INPUTS_H_
+
+#include <stdint.h>
+
+namespace OC {
+
+enum DigitalInput {
+  DIGITAL_INPUT_1,
+  DIGITAL_INPUT_2,
+  DIGITAL_INPUT_3,
+  DIGITAL_INPUT_4,
+  DIGITAL_INPUT_LAST
+};
+
+// The driver sets the scanned clocks and levels; Inject overrides them
+class DigitalInputs {
+public:
+  static void reInit() { }
+
+  static void Scan(uint32_t clocked, uint32_t levels) {
+    if (!injecting_) {
+      clocked_mask_ = clocked;
+      levels_ = levels;
+    }
+  }
+
+  static inline uint32_t clocked() {
+    return clocked_mask_;
+  }
+
+  template <DigitalInput input> static inline uint32_t clocked() {
+    return clocked_mask_ & (0x1 << input);
+  }
+
+  template <DigitalInput input> static inline bool read_immediate() {
+    return levels_ & (0x1 << input);
+  }
+
+  static inline uint32_t levels() {
+    return levels_;
+  }
+
+  static inline void Inject(uint32_t clocked, uint32_t levels) {
+    clocked_mask_ = clocked;
+    levels_ = levels;
+    injecting_ = true;
+  }
+
+  static inline void EndInject() {
+    injecting_ = false;
+  }
+
+  static uint32_t clocked_mask_;
+  static uint32_t levels_;
+  static bool injecting_;
+};
+
+}; // namespace OC
+
+#endif // HOST_OC_DIGITAL_INPUTS_H_
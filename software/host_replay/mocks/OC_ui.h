@@ -0,0 +1,33 @@
+#ifndef HOST_OC_UI_H_
+#define HOST_OC_UI_H_
+
+#include <vector>
+#include "UI/ui_events.h"
+
+namespace OC {
+
+enum UiControl {
+  CONTROL_BUTTON_UP   = 0x1,
+  CONTROL_BUTTON_DOWN = 0x2,
+  CONTROL_BUTTON_L    = 0x4,
+  CONTROL_BUTTON_R    = 0x8,
+  CONTROL_BUTTON_M    = 0x10,
+  CONTROL_ENCODER_L   = 0x20,
+  CONTROL_ENCODER_R   = 0x40,
+};
+
+// Events that would have been dispatched to the app, in order
+class Ui {
+public:
+  inline void InjectEvent(const UI::Event &event) {
+    events.push_back(event);
+  }
+
+  std::vector<UI::Event> events;
+};
+
+extern Ui ui;
+
+}; // namespace OC
+
+#endif // HOST_OC_UI_H_
@@ -0,0 +1,11 @@
+#ifndef HOST_OC_FREQMEASURE_H_
+#define HOST_OC_FREQMEASURE_H_
+
+class HostFreqMeasure {
+public:
+  void end() { }
+};
+
+extern HostFreqMeasure FreqMeasure;
+
+#endif // HOST_OC_FREQMEASURE_H_
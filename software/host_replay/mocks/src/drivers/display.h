@@ -0,0 +1,24 @@
+#ifndef HOST_DISPLAY_H_
+#define HOST_DISPLAY_H_
+
+// Drawing is ignored; views only have to compile
+
+#include <stdint.h>
+
+class HostGraphics {
+public:
+  void setPixel(int, int) { }
+  void drawLine(int, int, int, int, uint8_t = 1) { }
+  void drawFrame(int, int, int, int) { }
+  void drawRect(int, int, int, int) { }
+  void invertRect(int, int, int, int) { }
+  void drawCircle(int, int, int) { }
+  void drawBitmap8(int, int, int, const uint8_t *) { }
+  void setPrintPos(int, int) { }
+  void print(const char *) { }
+  void print(int) { }
+};
+
+extern HostGraphics graphics;
+
+#endif // HOST_DISPLAY_H_
@@ -0,0 +1,444 @@
+// Round trip test for the Backup / Restore streaming protocol (APP_Backup.h).
+// The app runs against mocks of USB MIDI and the EEPROM, and talks to a host
+// implementation of the other end of the protocol through a link that drops
+// and corrupts frames. Backups have to end with the host holding an exact copy
+// of the range, and restores with the module holding the host's copy, with the
+// apps re-initialized exactly once and only after every page has arrived.
+//
+// Corruption never touches the command byte: that is what tells frames of the
+// original format apart, so the protocol can't protect it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "APP_Backup.h"
+
+HostMIDI usbMIDI;
+EEPROMClass EEPROM;
+HostGraphics graphics;
+
+void SystemExclusiveHandler::OnSendSysEx() { }
+void SystemExclusiveHandler::OnReceiveSysEx() { }
+
+namespace {
+
+unsigned app_inits;
+
+}; // namespace
+
+void OC::apps::Init(bool reset_settings) { ++app_inits; }
+void OC::apps::FlushSettings() { }
+
+namespace {
+
+typedef std::vector<uint8_t> Frame;
+
+uint32_t random_state = 1;
+
+uint32_t xorshift() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+// Loses or corrupts a percentage of the frames going one way
+struct Link {
+  unsigned drop_percent;
+  unsigned corrupt_percent;
+  unsigned dropped;
+  unsigned corrupted;
+
+  // Returns false if the frame is lost
+  bool Pass(Frame &frame) {
+    uint32_t r = xorshift() % 100;
+    if (r < drop_percent) {
+      ++dropped;
+      return false;
+    }
+    if (r < drop_percent + corrupt_percent && frame.size() > 1) {
+      frame[1 + xorshift() % (frame.size() - 1)] ^= 1 << (xorshift() % 8);
+      ++corrupted;
+    }
+    return true;
+  }
+};
+
+void SendToModule(Frame frame, Link &link) {
+  if (!link.Pass(frame))
+    return;
+  UnpackedData unpacked;
+  unpacked.set_data(frame.size(), frame.data());
+  PackedData packed = unpacked.pack();
+  Frame sysex = { 0xf0, 0x7d, 0x62, 'B' };
+  sysex.insert(sysex.end(), packed.data, packed.data + packed.size);
+  sysex.push_back(0xf7);
+  usbMIDI.in.push_back(sysex);
+}
+
+std::vector<Frame> ReceiveFromModule(Link &link) {
+  std::vector<Frame> frames;
+  for (auto &sysex : usbMIDI.out) {
+    if (sysex.size() < 6 || sysex[0] != 0xf0 || sysex[1] != 0x7d || sysex[2] != 0x62 || sysex[3] != 'B' || sysex.back() != 0xf7) {
+      printf("  module sent a malformed SysEx message\n");
+      continue;
+    }
+    PackedData packed;
+    packed.set_data(sysex.size() - 5, sysex.data() + 4);
+    UnpackedData unpacked = packed.unpack();
+    Frame frame(unpacked.data, unpacked.data + unpacked.size);
+    if (link.Pass(frame))
+      frames.push_back(frame);
+  }
+  usbMIDI.out.clear();
+  return frames;
+}
+
+// The ISR runs many times for each loop(), and reads one message per call
+void RunModule() {
+  do {
+    Backup_isr();
+  } while (!usbMIDI.in.empty());
+  Backup_loop();
+}
+
+void StartModule() {
+  usbMIDI.in.clear();
+  usbMIDI.out.clear();
+  Backup_handleAppEvent(OC::APP_EVENT_RESUME);
+  app_inits = 0;
+}
+
+void PressButton(uint16_t control) {
+  Backup_handleButtonEvent(UI::Event(UI::EVENT_BUTTON_PRESS, control, 0, 0));
+}
+
+uint32_t RangeCRC(const uint8_t *image, uint8_t first, uint8_t last) {
+  return util::CRC32::Compute(image + first * backup::PAGE_SIZE, (last - first) * backup::PAGE_SIZE);
+}
+
+Frame PageFrame(const uint8_t *image, uint8_t p) {
+  Frame frame = { backup::CMD_PAGE, p };
+  frame.insert(frame.end(), image + p * backup::PAGE_SIZE, image + (p + 1) * backup::PAGE_SIZE);
+  frame.resize(frame.size() + 4);
+  backup::put_u32(&frame[2 + backup::PAGE_SIZE], util::CRC32::Compute(&frame[1], backup::PAGE_SIZE + 1));
+  return frame;
+}
+
+bool PageFrameValid(const Frame &frame) {
+  return frame.size() == 2 + backup::PAGE_SIZE + 4 && frame[1] < backup::PAGE_COUNT &&
+      util::CRC32::Compute(&frame[1], backup::PAGE_SIZE + 1) == backup::get_u32(&frame[2 + backup::PAGE_SIZE]);
+}
+
+void RandomImage(uint8_t *image) {
+  for (size_t i = 0; i < EEPROMStorage::LENGTH; ++i)
+    image[i] = xorshift();
+}
+
+// Changes some pages of a copy of the EEPROM, leaving the rest identical
+void RandomChanges(uint8_t *image, unsigned pages) {
+  memcpy(image, EEPROM.cells, EEPROMStorage::LENGTH);
+  for (unsigned i = 0; i < pages; ++i) {
+    size_t page = xorshift() % backup::PAGE_COUNT;
+    for (size_t b = 0; b < backup::PAGE_SIZE; ++b)
+      image[page * backup::PAGE_SIZE + b] = xorshift();
+  }
+}
+
+const unsigned kMaxSteps = 20000;
+// Steps without any frames before the host assumes something got lost
+const unsigned kTimeout = 8;
+
+struct Stats {
+  unsigned steps;
+  unsigned frames_to_module;
+  unsigned frames_from_module;
+};
+
+void Report(const char *name, const Link &to_module, const Link &from_module, const Stats &stats, bool ok) {
+  printf("%-40s %5u steps, %4u frames out (%3u lost, %3u bad), %4u in (%3u lost, %3u bad): %s\n",
+         name, stats.steps,
+         stats.frames_to_module, to_module.dropped, to_module.corrupted,
+         stats.frames_from_module, from_module.dropped, from_module.corrupted,
+         ok ? "ok" : "FAIL");
+}
+
+// Host requests a backup, optionally sending its hashes first (delta backup),
+// and requests pages again until its copy matches the module's range CRC
+bool TestBackup(const char *name, bool calibration, bool delta, unsigned drop, unsigned corrupt) {
+  RandomImage(EEPROM.cells);
+  const uint8_t first = calibration ? 0 : backup::CALIBRATION_PAGES;
+  const uint8_t last = calibration ? backup::CALIBRATION_PAGES : backup::PAGE_COUNT;
+
+  uint8_t image[EEPROMStorage::LENGTH];
+  RandomChanges(image, delta ? 6 : backup::PAGE_COUNT);
+  StartModule();
+  const size_t writes = EEPROM.writes;
+
+  Link to_module = { drop, corrupt }, from_module = { drop, corrupt };
+  Stats stats = {};
+  bool done = false, request = true, ended = false;
+  uint32_t end_crc = 0;
+  unsigned idle = 0;
+  bool received[backup::PAGE_COUNT] = {};
+
+  while (!done && stats.steps < kMaxSteps) {
+    if (request) {
+      // The module only accepts hashes and requests while it isn't sending
+      if (delta) {
+        for (uint8_t p = first; p < last; p += backup::HASHES_PER_FRAME) {
+          Frame frame = { backup::CMD_HASHES, p };
+          for (uint8_t h = 0; h < backup::HASHES_PER_FRAME; ++h) {
+            frame.resize(frame.size() + 4);
+            if (p + h < last)
+              backup::put_u32(&frame[frame.size() - 4], RangeCRC(image, p + h, p + h + 1));
+          }
+          SendToModule(frame, to_module);
+          ++stats.frames_to_module;
+        }
+      }
+      SendToModule({ backup::CMD_REQUEST, calibration }, to_module);
+      ++stats.frames_to_module;
+      memset(received, 0, sizeof(received));
+      ended = false;
+      request = false;
+    }
+
+    RunModule();
+    ++stats.steps;
+    std::vector<Frame> frames = ReceiveFromModule(from_module);
+    stats.frames_from_module += frames.size();
+
+    for (auto &frame : frames) {
+      if (frame[0] == backup::CMD_PAGE) {
+        if (PageFrameValid(frame)) {
+          uint8_t p = frame[1];
+          memcpy(image + p * backup::PAGE_SIZE, &frame[2], backup::PAGE_SIZE);
+          received[p] = true;
+          SendToModule({ backup::CMD_ACK, p }, to_module);
+        } else {
+          SendToModule({ backup::CMD_NAK, static_cast<uint8_t>(frame[1] & (backup::PAGE_COUNT - 1)) }, to_module);
+        }
+        ++stats.frames_to_module;
+      } else if (frame[0] == backup::CMD_END && frame.size() >= 6) {
+        ended = true;
+        end_crc = backup::get_u32(&frame[2]);
+      }
+    }
+
+    if (ended && RangeCRC(image, first, last) == end_crc) {
+      done = true;
+    } else if (frames.empty()) {
+      ++idle;
+      if (ended && idle == 2) {
+        // Pages went missing, or a corrupt hash frame made the module skip
+        // the wrong ones: ask for every page that wasn't received
+        for (uint8_t p = first; p < last; ++p) {
+          if (received[p]) continue;
+          SendToModule({ backup::CMD_NAK, p }, to_module);
+          ++stats.frames_to_module;
+        }
+      }
+      if (idle >= kTimeout) {
+        // Lost the request, the end, or all the retransmits; start over
+        request = true;
+        idle = 0;
+      }
+    } else {
+      idle = 0;
+    }
+  }
+
+  bool ok = done;
+  if (!done)
+    printf("  backup didn't complete\n");
+  if (memcmp(image + first * backup::PAGE_SIZE, EEPROM.cells + first * backup::PAGE_SIZE, (last - first) * backup::PAGE_SIZE)) {
+    printf("  host copy differs from the module\n");
+    ok = false;
+  }
+  if (EEPROM.writes != writes) {
+    printf("  backup wrote to the EEPROM\n");
+    ok = false;
+  }
+  Report(name, to_module, from_module, stats, ok);
+  return ok;
+}
+
+// Host streams its copy and resends pages on request, and sends the end frame
+// again if nothing happens. bad_end sends a wrong range CRC first, which must
+// make the module ask for the whole range instead of applying the restore.
+bool TestRestore(const char *name, bool calibration, unsigned drop, unsigned corrupt, bool bad_end) {
+  RandomImage(EEPROM.cells);
+  const uint8_t first = calibration ? 0 : backup::CALIBRATION_PAGES;
+  const uint8_t last = calibration ? backup::CALIBRATION_PAGES : backup::PAGE_COUNT;
+
+  uint8_t before[EEPROMStorage::LENGTH];
+  memcpy(before, EEPROM.cells, sizeof(before));
+  uint8_t image[EEPROMStorage::LENGTH];
+  RandomChanges(image, backup::PAGE_COUNT / 2);
+  size_t changed = 0;
+  for (size_t i = first * backup::PAGE_SIZE; i < last * backup::PAGE_SIZE; ++i)
+    changed += image[i] != EEPROM.cells[i];
+
+  StartModule();
+  PressButton(OC::CONTROL_BUTTON_L);
+  const size_t writes = EEPROM.writes;
+
+  Link to_module = { drop, corrupt }, from_module = { drop, corrupt };
+  Stats stats = {};
+  std::vector<uint8_t> queue;
+  for (uint8_t p = first; p < last; ++p)
+    queue.push_back(p);
+  bool end_queued = true, good_end_sent = false;
+  unsigned ends_sent = 0;
+  unsigned idle = 0;
+  unsigned naks = 0;
+  bool ok = true;
+
+  while (!app_inits && stats.steps < kMaxSteps) {
+    // A few pages per step, like the module does
+    for (int n = 0; n < 4 && !queue.empty(); ++n) {
+      SendToModule(PageFrame(image, queue.front()), to_module);
+      queue.erase(queue.begin());
+      ++stats.frames_to_module;
+    }
+    if (queue.empty() && end_queued) {
+      Frame frame = { backup::CMD_END, static_cast<uint8_t>(last - first), 0, 0, 0, 0 };
+      uint32_t crc = RangeCRC(image, first, last);
+      const bool wrong = bad_end && !ends_sent++;
+      backup::put_u32(&frame[2], wrong ? ~crc : crc);
+      good_end_sent |= !wrong;
+      SendToModule(frame, to_module);
+      ++stats.frames_to_module;
+      end_queued = false;
+    }
+
+    RunModule();
+    ++stats.steps;
+    std::vector<Frame> frames = ReceiveFromModule(from_module);
+    stats.frames_from_module += frames.size();
+
+    for (auto &frame : frames) {
+      if (frame.size() < 2) continue;
+      uint8_t p = frame[1];
+      if (frame[0] == backup::CMD_NAK) {
+        ++naks;
+        if (p >= first && p < last) {
+          queue.push_back(p);
+          end_queued = true;
+        }
+      }
+    }
+
+    if (app_inits) {
+      if (!good_end_sent) {
+        printf("  applied despite the wrong range CRC\n");
+        ok = false;
+      }
+      if (memcmp(image + first * backup::PAGE_SIZE, EEPROM.cells + first * backup::PAGE_SIZE, (last - first) * backup::PAGE_SIZE)) {
+        printf("  applied before the module had the whole range\n");
+        ok = false;
+      }
+    } else if (frames.empty() && queue.empty()) {
+      if (++idle >= kTimeout) {
+        end_queued = true;
+        idle = 0;
+      }
+    } else {
+      idle = 0;
+    }
+  }
+
+  // One more pass to see that it's only applied once
+  for (int i = 0; i < 4; ++i)
+    RunModule();
+  usbMIDI.out.clear();
+
+  if (app_inits != 1) {
+    printf("  apps re-initialized %u times\n", app_inits);
+    ok = false;
+  }
+  // Without losses, a wrong range CRC has to bring every page of the range again
+  if (bad_end && !drop && !corrupt && naks < static_cast<unsigned>(last - first)) {
+    printf("  wrong range CRC only asked for %u of %u pages\n", naks, last - first);
+    ok = false;
+  }
+  if (memcmp(image + first * backup::PAGE_SIZE, EEPROM.cells + first * backup::PAGE_SIZE, (last - first) * backup::PAGE_SIZE)) {
+    printf("  module differs from the host copy\n");
+    ok = false;
+  }
+  if (memcmp(before, EEPROM.cells, first * backup::PAGE_SIZE) ||
+      memcmp(before + last * backup::PAGE_SIZE, EEPROM.cells + last * backup::PAGE_SIZE, (backup::PAGE_COUNT - last) * backup::PAGE_SIZE)) {
+    printf("  pages outside the range were written\n");
+    ok = false;
+  }
+  // Pages that failed their CRC were never written, and good pages only
+  // changed cells
+  if (EEPROM.writes - writes != changed) {
+    printf("  %zu cells written, %zu changed\n", EEPROM.writes - writes, changed);
+    ok = false;
+  }
+  Report(name, to_module, from_module, stats, ok);
+  return ok;
+}
+
+// The original format: the first byte is the page number, no CRC, no end frame
+bool TestLegacyRestore(const char *name) {
+  RandomImage(EEPROM.cells);
+  uint8_t image[EEPROMStorage::LENGTH];
+  RandomImage(image);
+  StartModule();
+  PressButton(OC::CONTROL_BUTTON_L);
+
+  Link link = {};
+  Stats stats = {};
+  bool ok = true;
+  for (uint8_t p = backup::CALIBRATION_PAGES; p < backup::PAGE_COUNT; ++p) {
+    Frame frame = { p };
+    frame.insert(frame.end(), image + p * backup::PAGE_SIZE, image + (p + 1) * backup::PAGE_SIZE);
+    SendToModule(frame, link);
+    ++stats.frames_to_module;
+    RunModule();
+    ++stats.steps;
+    if (app_inits && p != backup::PAGE_COUNT - 1) {
+      printf("  applied before the last page\n");
+      ok = false;
+    }
+  }
+  RunModule();
+  if (app_inits != 1) {
+    printf("  apps re-initialized %u times\n", app_inits);
+    ok = false;
+  }
+  const size_t start = backup::CALIBRATION_PAGES * backup::PAGE_SIZE;
+  if (memcmp(image + start, EEPROM.cells + start, EEPROMStorage::LENGTH - start)) {
+    printf("  module differs from the host copy\n");
+    ok = false;
+  }
+  Report(name, link, link, stats, ok);
+  return ok;
+}
+
+}; // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1)
+    random_state = strtoul(argv[1], nullptr, 0) | 1;
+
+  bool ok = true;
+  ok &= TestBackup("backup, data", false, false, 0, 0);
+  ok &= TestBackup("backup, calibration", true, false, 0, 0);
+  ok &= TestBackup("backup, data, delta", false, true, 0, 0);
+  ok &= TestBackup("backup, data, lossy", false, false, 10, 10);
+  ok &= TestBackup("backup, data, delta, lossy", false, true, 10, 10);
+  ok &= TestRestore("restore, data", false, 0, 0, false);
+  ok &= TestRestore("restore, calibration", true, 0, 0, false);
+  ok &= TestRestore("restore, data, lossy", false, 10, 10, false);
+  ok &= TestRestore("restore, calibration, lossy", true, 20, 20, false);
+  ok &= TestRestore("restore, data, wrong range CRC", false, 0, 0, true);
+  ok &= TestRestore("restore, data, wrong range CRC, lossy", false, 10, 10, true);
+  ok &= TestLegacyRestore("restore, original format");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,477 @@
+// Bit-exactness test for peaks::ByteBeat (peaks_bytebeat.cpp), which looks up
+// its equation in a function table and renders blocks with Render(), against
+// the per-sample switch it had before, which is kept here as the reference.
+//
+// The first test runs every equation with random parameters, loop and step
+// modes and gate sequences, changing the parameters now and then, through the
+// old ProcessSingleSample(), the new one, and Render() in blocks of random
+// size. All three have to produce the same samples.
+//
+// The second test runs the block pipeline of APP_BYTEBEATGEN, which renders
+// kBlockSize samples at a time and latches gate edges until the next block.
+// Its output has to match the old per-sample code when each rising edge is
+// moved to the start of the next block (a delay of up to kBlockSize - 1
+// ticks, merging edges within a block), and the parameters are only read at
+// the start of each block.
+//
+// The equations divide by parameters and by previous samples, which can be
+// zero; cortex_m4_divide.h makes that behave as on the module.
+//
+//   bytebeat_test [SEED]
+//   bytebeat_test --bench [SEED]   also time the old and new code
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "peaks_bytebeat.h"
+
+#include "cortex_m4_divide.h"
+
+namespace reference {
+
+using peaks::CONTROL_GATE_RISING;
+
+// peaks::ByteBeat before the function table
+class ByteBeat {
+ public:
+  void Init() {
+    equation_ = 0;
+    speed_ = 32678;
+    pitch_ = 1;
+    loopmode_ = false ;
+    loop_start_ = 0 ;
+    loop_end_ = 255 << 24 ;
+    phase_ = 0 ;
+    t_ = 0 ;
+    p0_ = 127;
+    p1_ = 127;
+    p2_ = 127;
+    stepmode_ = false ;
+    last_sample_ = 13 ;
+  }
+
+  void Configure(int32_t* parameter, bool stepmode, bool loopmode) {
+      equation_ = parameter[0];
+      equation_index_ = equation_ >> 12;
+      speed_ = parameter[1];
+      p0_ = parameter[2] >> 8;
+      p1_ = parameter[3] >> 8;
+      p2_ = parameter[4] >> 8;
+      loop_start_ = static_cast<uint32_t>((parameter[5] << 16) + (parameter[6] << 8) + parameter[7]);
+      loop_end_ = static_cast<uint32_t>((parameter[8] << 16) + (parameter[9] << 8) + parameter[10]);
+      pitch_ = parameter[11] >> 8;
+      stepmode_ = stepmode;
+      loopmode_ = loopmode;
+      // Quick and dirty log scaling sans LUT
+      uint8_t speed_rshift = (speed_ >> 13) + 1;
+      if (speed_rshift < 2) speed_rshift = 2 ;
+      bytepitch_ = (65535 - speed_) >> speed_rshift ; 
+      if (bytepitch_ < 1) {
+        bytepitch_ = 1;
+      }
+  }
+
+  uint16_t ProcessSingleSample(uint8_t control);
+
+ private:
+  uint16_t equation_ ;
+  uint16_t speed_;
+  uint16_t pitch_;
+  uint8_t p0_;
+  uint8_t p1_;
+  uint8_t p2_;
+  uint16_t last_sample_;
+  uint32_t t_; 
+  uint32_t phase_;
+  uint32_t loop_start_ ;
+  uint32_t loop_end_ ;
+  bool stepmode_ ;
+  bool loopmode_ ;
+  uint16_t equation_index_ ;
+  uint16_t bytepitch_ ;
+};
+
+uint16_t ByteBeat::ProcessSingleSample(uint8_t control) {
+
+  uint16_t sample = 0;
+   
+  if (control & CONTROL_GATE_RISING) {
+    if (stepmode_) {
+      ++t_ ;
+    } else {
+      phase_ = 0;
+      if (loopmode_) {
+        t_ = loop_start_ ;
+      } else {
+        t_ = 0 ;
+      }
+    }
+  }
+
+  if (!stepmode_) {
+    ++phase_ ; 
+  }    
+  
+  if (loopmode_ && (t_ < loop_start_ || t_ > loop_end_)) {
+     t_ = loop_start_ ;
+     phase_ = 0 ;
+  }
+
+  if (!stepmode_ && (phase_ % bytepitch_ == 0)) ++t_; 
+// These equations push the boundaries of precedence comprehension.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wparentheses"
+  uint8_t pitch = pitch_ ;
+  uint8_t p0 = p0_ ;
+  uint8_t p1 = p1_ ;
+  uint8_t p2 = p2_ ;
+    switch (equation_index_) {
+        case 0: // hope - pitch OK
+          // from http://royal-paw.com/2012/01/bytebeats-in-c-and-python-generative-symphonies-from-extremely-small-programs/
+          // (atmospheric, hopeful)
+          // sample = ( ( ((t_*3) & ((t_*pitch)>>10)) | ((t_*p0) & ((t_*pitch)>>10)) | ((t_*10) & (((t_*pitch)>>8)*p1) & p2) ) & 0xFF);
+          // sample = ( ( ((t_*3) & ((t_*pitch)>>10)) | ((t_*p0) & ((t_*pitch)>>10)) | ((t_*10) & ((t_>>8)*p1) & p2) ) & 0xFF);
+          sample = ( ( (((t_*pitch)*3) & (t_>>10)) | (((t_*pitch)*p0) & (t_>>10)) | ((t_*10) & ((t_>>8)*p1) & p2) ) & 0xFF);
+          break;
+        case 1: // love - pitch OK
+          // equation by stephth via https://www.youtube.com/watch?v=tCRPUv8V22o at 3:38
+          sample = (((((t_*pitch)*p0) & (t_>>4)) | ((t_*p2) & (t_>>7)) | ((t_*p1) & (t_>>10))) & 0xFF);
+          break;
+        case 2: // life - pitch OK
+          // This one is the second one listed at from http://xifeng.weebly.com/bytebeats.html
+          sample = ((( ((((((t_*pitch) >> p0) | (t_*pitch)) | ((t_*pitch) >> p0)) * p2) & ((5 * (t_*pitch)) | ((t_*pitch) >> p2)) ) | ((t_*pitch) ^ (t_ % p1)) ) & 0xFF));
+          break;
+       case 3:// age - pitch disabled
+          // Arp rotator (equation 9 from Equation Composer Ptah bank)
+          sample = (((t_)>>(p2>>4))&((t_)<<3)/((t_)*p1*((t_)>>11)%(3+(((t_)>>(16-(p0>>4)))%22))));
+          break ;
+        case 4: // clysm - pitch almost no effect
+          //  BitWiz Transplant via Equation Composer Ptah bank 
+          sample = ((t_*pitch)-(((t_*pitch)&p0)*p1-1668899)*(((t_*pitch)>>15)%15*(t_*pitch)))>>(((t_*pitch)>>12)%16)>>(p2%15);
+          break ;
+        case 5: // monk - pitch OK
+          // Vocaliser from Equation Composer Khepri bank         
+          sample = (((t_*pitch)%p0>>2)&p1)*(t_>>(p2>>5));
+          break;
+        case 6: // NERV - horrible!
+          // Chewie from Equation Composer Khepri bank         
+          sample = (p0-(((p2+1)/(t_*pitch))^p0|(t_*pitch)^922+p0))*(p2+1)/p0*(((t_*pitch)+p1)>>p1%19);
+          break;
+        case 7: // Trurl - pitch OK
+          // Tinbot from Equation Composer Sobek bank   
+          sample = ((t_*pitch)/(40+p0)*((t_*pitch)+(t_*pitch)|4-(p1+20)))+((t_*pitch)*(p2>>5));
+          break;
+        case 8: // Pirx  - pitch OK
+          // My Loud Friend from Equation Composer Ptah bank   
+          sample = ((((t_*pitch)>>((p0>>12)%12))%(t_>>((p1%12)+1))-(t_>>((t_>>(p2%10))%12)))/((t_>>((p0>>2)%15))%15))<<4;
+          break;
+        case 9: //Snaut
+          // GGT2 from Equation Composer Ptah bank
+          // sample = ((p0|(t_>>(t_>>13)%14))*((t_>>(p0%12))-p1&249))>>((t_>>13)%6)>>((p2>>4)%12);
+          // "A bit high-frequency, but keeper anyhow" from Equation Composer Khepri bank.
+          sample = ((t_*pitch)+last_sample_+p1/p0)%(p0|(t_*pitch)+p2);
+           break;
+        case 10: // Hari
+          // The Signs, from Equation Composer Ptah bank
+          sample = ((0&(251&((t_*pitch)/(100+p0))))|((last_sample_/(t_*pitch)|((t_*pitch)/(100*(p1+1))))*((t_*pitch)|p2)));
+          break;
+        case 11: // Kris - pitch OK
+         // Light Reactor from Equation Composer Ptah bank
+          sample = (((t_*pitch)>>3)*(p0-643|(325%t_|p1)&t_)-((t_>>6)*35/p2%t_))>>6;
+          break;
+        case 12: // Tichy
+          sample = (t_*pitch_)>>7 & t_>>7 | t_>>8;
+          // Alpha from Equation Composer Khepri bank
+          // sample = ((((t_*pitch)^(p0>>3)-456)*(p1+1))/((((t_*pitch)>>(p2>>3))%14)+1))+((t_*pitch)*((182>>((t_*pitch)>>15)%16))&1) ;
+          break;
+        case 13: // Bregg - pitch OK
+          // Hooks, from Equation Composer Khepri bank.
+          sample = ((t_*pitch)&(p0+2))-(t_/p1)/last_sample_/p2;
+          break;            
+        case 14: // Avon - pitch OK
+          // Widerange from Equation Composer Khepri bank
+          sample = (((p0^((t_*pitch)>>(p1>>3)))-(t_>>(p2>>2))-t_%(t_&p1)));
+          break;        
+        case 15: // Orac
+          // Abducted, from Equation Composer Ptah bank
+          sample = (p0+(t_*pitch)>>p1%12)|((last_sample_%(p0+(t_*pitch)>>p0%4))+11+p2^t_)>>(p2>>12);
+          break;
+        default:
+          sample = 0 ;
+          break;          
+  }
+#pragma GCC diagnostic pop
+  last_sample_ = sample ;
+  return sample << 8 ;
+}
+
+}; // namespace reference
+
+namespace {
+
+const size_t kBlockSize = 4; // As in APP_BYTEBEATGEN
+const int kParameters = 12;
+
+uint32_t random_state = 1;
+
+uint32_t xorshift() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+// Parameters as Configure() gets them from the app: 16 bits each, often at
+// either end of the range
+void RandomParameters(int32_t *parameter, int equation) {
+  for (int i = 0; i < kParameters; ++i) {
+    uint32_t r = xorshift();
+    switch (r % 8) {
+      case 0: parameter[i] = 0; break;
+      case 1: parameter[i] = 65535; break;
+      case 2: parameter[i] = (r >> 8) & 0x3ff; break;
+      default: parameter[i] = (r >> 8) & 0xffff;
+    }
+  }
+  parameter[0] = (equation << 12) | (xorshift() & 0xfff);
+}
+
+// Rising edges every so often, with the gate held for a while after each
+uint8_t NextControl(uint32_t &gate_ticks, uint32_t rate) {
+  uint8_t control = 0;
+  if (gate_ticks) {
+    --gate_ticks;
+    control |= peaks::CONTROL_GATE;
+    if (!gate_ticks) control = peaks::CONTROL_GATE_FALLING;
+  } else if (xorshift() % rate == 0) {
+    control = peaks::CONTROL_GATE_RISING | peaks::CONTROL_GATE;
+    gate_ticks = 1 + xorshift() % 16;
+  }
+  return control;
+}
+
+bool TestEquations(unsigned runs, unsigned ticks) {
+  unsigned failures = 0;
+  uint64_t samples = 0;
+  for (int equation = 0; equation < 16; ++equation) {
+    for (unsigned run = 0; run < runs && failures < 4; ++run) {
+      int32_t parameter[kParameters];
+      RandomParameters(parameter, equation);
+      bool step_mode = xorshift() % 4 == 0;
+      bool loop_mode = xorshift() % 2;
+      const uint32_t rate = 1 + xorshift() % 200;
+
+      reference::ByteBeat expected;
+      peaks::ByteBeat single, block;
+      expected.Init();
+      single.Init();
+      block.Init();
+      expected.Configure(parameter, step_mode, loop_mode);
+      single.Configure(parameter, step_mode, loop_mode);
+      block.Configure(parameter, step_mode, loop_mode);
+
+      uint32_t gate_ticks = 0;
+      for (unsigned t = 0; t < ticks; ) {
+        if (xorshift() % 64 == 0) {
+          RandomParameters(parameter, xorshift() % 8 ? equation : xorshift() % 16);
+          if (xorshift() % 4 == 0) step_mode = !step_mode;
+          if (xorshift() % 4 == 0) loop_mode = !loop_mode;
+          expected.Configure(parameter, step_mode, loop_mode);
+          single.Configure(parameter, step_mode, loop_mode);
+          block.Configure(parameter, step_mode, loop_mode);
+        }
+
+        uint8_t control[16];
+        uint16_t rendered[16];
+        const size_t size = 1 + xorshift() % 16;
+        for (size_t i = 0; i < size; ++i)
+          control[i] = NextControl(gate_ticks, rate);
+        block.Render(control, rendered, size);
+
+        for (size_t i = 0; i < size; ++i, ++t) {
+          uint16_t e = expected.ProcessSingleSample(control[i]);
+          uint16_t s = single.ProcessSingleSample(control[i]);
+          if (s != e || rendered[i] != e) {
+            printf("  equation %d, run %u, tick %u: expected %04x, ProcessSingleSample %04x, Render %04x\n",
+                   equation, run, t, e, s, rendered[i]);
+            ++failures;
+            t = ticks;
+            break;
+          }
+          ++samples;
+        }
+      }
+    }
+  }
+  printf("%-52s %9llu samples: %s\n", "function table and Render() vs. switch",
+         static_cast<unsigned long long>(samples), failures ? "FAIL" : "ok");
+  return !failures;
+}
+
+// ByteBeat::Update() and RenderBlock() in APP_BYTEBEATGEN, minus the settings
+struct BlockPipeline {
+  peaks::ByteBeat bytebeat;
+  uint8_t pending_gate_state;
+  uint16_t block[kBlockSize];
+  size_t block_pos;
+
+  void Init() {
+    bytebeat.Init();
+    pending_gate_state = 0;
+    memset(block, 0, sizeof(block));
+    block_pos = kBlockSize;
+  }
+
+  uint16_t Update(uint8_t control, int32_t *parameter, bool step_mode, bool loop_mode) {
+    pending_gate_state |= control;
+    if (block_pos >= kBlockSize) {
+      bytebeat.Configure(parameter, step_mode, loop_mode);
+      uint8_t block_control[kBlockSize] = { pending_gate_state };
+      pending_gate_state = 0;
+      bytebeat.Render(block_control, block, kBlockSize);
+      block_pos = 0;
+    }
+    return block[block_pos++];
+  }
+};
+
+bool TestBlockPipeline(unsigned runs, unsigned ticks) {
+  unsigned failures = 0, delayed_edges = 0, merged_edges = 0;
+  uint64_t samples = 0;
+  for (unsigned run = 0; run < runs && failures < 4; ++run) {
+    int32_t parameter[kParameters];
+    RandomParameters(parameter, xorshift() % 16);
+    bool step_mode = xorshift() % 4 == 0;
+    bool loop_mode = xorshift() % 2;
+    const uint32_t rate = 1 + xorshift() % 40;
+
+    BlockPipeline pipeline;
+    pipeline.Init();
+    reference::ByteBeat expected;
+    expected.Init();
+    int32_t block_parameter[kParameters];
+    bool block_step_mode = false, block_loop_mode = false;
+    bool edge_pending = false;
+
+    uint32_t gate_ticks = 0;
+    for (unsigned t = 0; t < ticks; ++t) {
+      // Parameters can change on any tick, as CVs do
+      if (xorshift() % 16 == 0) {
+        RandomParameters(parameter, xorshift() % 16);
+        if (xorshift() % 4 == 0) step_mode = !step_mode;
+        if (xorshift() % 4 == 0) loop_mode = !loop_mode;
+      }
+      const uint8_t control = NextControl(gate_ticks, rate);
+      const uint16_t actual = pipeline.Update(control, parameter, step_mode, loop_mode);
+
+      // The old code, run every tick, with the parameters and rising edges
+      // that the block sees
+      const bool block_start = t % kBlockSize == 0;
+      if (control & peaks::CONTROL_GATE_RISING) {
+        if (!block_start) ++delayed_edges;
+        if (edge_pending) ++merged_edges;
+        edge_pending = true;
+      }
+      uint8_t expected_control = 0;
+      if (block_start) {
+        memcpy(block_parameter, parameter, sizeof(block_parameter));
+        block_step_mode = step_mode;
+        block_loop_mode = loop_mode;
+        if (edge_pending) expected_control = peaks::CONTROL_GATE_RISING;
+        edge_pending = false;
+      }
+      expected.Configure(block_parameter, block_step_mode, block_loop_mode);
+      const uint16_t e = expected.ProcessSingleSample(expected_control);
+
+      if (actual != e) {
+        printf("  run %u, tick %u: expected %04x, block pipeline %04x\n", run, t, e, actual);
+        ++failures;
+        break;
+      }
+      ++samples;
+    }
+  }
+  printf("%-52s %9llu samples: %s\n", "block pipeline vs. switch, edges at block start",
+         static_cast<unsigned long long>(samples), failures ? "FAIL" : "ok");
+  printf("  %u rising edges delayed to the next block by up to %zu ticks, %u merged with an earlier one\n",
+         delayed_edges, kBlockSize - 1, merged_edges);
+  return !failures;
+}
+
+// Time per sample over all equations, with the parameters fixed and no gates,
+// for the old switch and for Render() in blocks of kBlockSize. Division by
+// zero is so slow here that parameters are chosen for which it doesn't happen.
+void Benchmark() {
+  const unsigned kTicks = 1 << 20;
+  double reference_ns = 0, render_ns = 0;
+  volatile uint16_t sink = 0;
+  int equations = 0;
+
+  for (int equation = 0; equation < 16; ++equation) {
+    int32_t parameter[kParameters];
+    bool found = false;
+    for (int attempt = 0; attempt < 100 && !found; ++attempt) {
+      RandomParameters(parameter, equation);
+      reference::ByteBeat probe;
+      probe.Init();
+      probe.Configure(parameter, false, false);
+      const unsigned errors = divide_errors;
+      uint16_t sum = 0;
+      for (unsigned t = 0; t < kTicks && errors == divide_errors; ++t)
+        sum += probe.ProcessSingleSample(0);
+      sink = sink + sum;
+      found = errors == divide_errors;
+    }
+    if (!found)
+      continue;
+
+    reference::ByteBeat expected;
+    peaks::ByteBeat block;
+    expected.Init();
+    block.Init();
+    expected.Configure(parameter, false, false);
+    block.Configure(parameter, false, false);
+
+    uint16_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < kTicks; ++t)
+      sum += expected.ProcessSingleSample(0);
+    auto middle = std::chrono::steady_clock::now();
+    const uint8_t control[kBlockSize] = { 0 };
+    uint16_t rendered[kBlockSize];
+    for (unsigned t = 0; t < kTicks; t += kBlockSize) {
+      block.Render(control, rendered, kBlockSize);
+      sum += rendered[0];
+    }
+    auto end = std::chrono::steady_clock::now();
+    sink = sink + sum;
+
+    reference_ns += std::chrono::duration<double, std::nano>(middle - start).count();
+    render_ns += std::chrono::duration<double, std::nano>(end - middle).count();
+    ++equations;
+  }
+
+  const double samples = static_cast<double>(equations) * kTicks;
+  printf("%d equations: switch %.2f ns/sample, Render() %.2f ns/sample, %.2fx\n",
+         equations, reference_ns / samples, render_ns / samples, reference_ns / render_ns);
+}
+
+}; // namespace
+
+int main(int argc, char **argv) {
+  bool bench = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--bench")) bench = true;
+    else random_state = strtoul(argv[i], nullptr, 0) | 1;
+  }
+  InstallDivideHandler();
+
+  bool ok = true;
+  ok &= TestEquations(50, 2000);
+  ok &= TestBlockPipeline(500, 2000);
+  if (bench)
+    Benchmark();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#ifndef HOST_CORTEX_M4_DIVIDE_H_
+#define HOST_CORTEX_M4_DIVIDE_H_
+
+// Division by zero as on the Cortex-M4, for tests of code that relies on it.
+// The M4 returns 0 for x / 0 and (as x - (x / 0) * 0) x for x % 0, but x86
+// traps, so on x86-64 Linux a SIGFPE handler finishes the faulting
+// instruction with the M4 results. Elsewhere the test dies on the first one.
+//
+// Tests that use this are built without the sanitizers, which would report
+// the division.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <signal.h>
+#include <ucontext.h>
+#endif
+
+namespace {
+
+volatile unsigned divide_errors = 0; // Divisions by zero so far
+
+#if defined(__x86_64__) && defined(__linux__)
+// Completes a DIV or IDIV that trapped with the Cortex-M4 results: a zero
+// quotient, and the dividend as the remainder
+void OnDivideError(int, siginfo_t *, void *context) {
+  greg_t *regs = static_cast<ucontext_t *>(context)->uc_mcontext.gregs;
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(regs[REG_RIP]);
+  bool word = false, wide = false;
+  if (*p == 0x66) { // Operand size prefix
+    word = true;
+    ++p;
+  }
+  if ((*p & 0xf0) == 0x40) wide = *p++ & 0x08; // REX
+  const uint8_t opcode = *p++;
+  const uint8_t modrm = *p++;
+  const uint8_t mod = modrm >> 6, reg = (modrm >> 3) & 0x07, rm = modrm & 0x07;
+  if ((opcode != 0xf6 && opcode != 0xf7) || (reg != 6 && reg != 7)) {
+    fprintf(stderr, "SIGFPE at an instruction other than DIV or IDIV\n");
+    abort();
+  }
+  if (mod != 3) {
+    if (rm == 4 && (*p++ & 0x07) == 5 && mod == 0) p += 4; // SIB with disp32
+    else if (rm == 5 && mod == 0) p += 4; // RIP relative
+    if (mod == 1) p += 1;
+    else if (mod == 2) p += 4;
+  }
+  const uint64_t dividend = regs[REG_RAX];
+  if (opcode == 0xf6) {
+    // AX / r/m8: quotient in AL, remainder in AH. The compiler only uses this
+    // for dividends that fit in 8 bits.
+    regs[REG_RAX] = (dividend & ~0xffffULL) | ((dividend & 0xff) << 8);
+  } else if (word) {
+    regs[REG_RDX] = (regs[REG_RDX] & ~0xffffULL) | (dividend & 0xffff);
+    regs[REG_RAX] = dividend & ~0xffffULL;
+  } else {
+    regs[REG_RDX] = wide ? dividend : static_cast<uint32_t>(dividend);
+    regs[REG_RAX] = 0;
+  }
+  regs[REG_RIP] = reinterpret_cast<greg_t>(p);
+  divide_errors = divide_errors + 1;
+}
+
+void InstallDivideHandler() {
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_sigaction = OnDivideError;
+  action.sa_flags = SA_SIGINFO;
+  sigaction(SIGFPE, &action, nullptr);
+}
+#else
+void InstallDivideHandler() { }
+#endif
+
+}; // namespace
+
+#endif // HOST_CORTEX_M4_DIVIDE_H_
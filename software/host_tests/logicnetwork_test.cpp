@@ -0,0 +1,197 @@
+// Equivalence test for LogicNetwork (neuralnet/LogicNetwork.h) against the
+// loop over LogicGate::Calculate() that Neural Net used before. Random
+// networks, including ones with feedback, are run on random input sequences
+// with both, and have to agree on every gate's state and the source state
+// after every tick. Gates are evaluated in index order by both, not in
+// topological order: a gate sees this tick's output of lower-numbered gates,
+// and last tick's output of higher-numbered ones.
+//
+// Patches are also edited while running, like from the UI, which recompiles
+// the network.
+//
+//   logicnetwork_test [SEED]
+//   logicnetwork_test --bench [SEED]   also time both evaluators
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include <Arduino.h>
+#include "src/drivers/display.h"
+#include "neuralnet/LogicGate.h"
+#include "neuralnet/LogicNetwork.h"
+
+HostMIDI usbMIDI;
+HostGraphics graphics;
+
+namespace {
+
+const int kGates = 6;
+
+uint32_t random_state = 1;
+
+uint32_t xorshift() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+int random_range(int low, int high) {
+  return low + static_cast<int>(xorshift() % (high - low + 1));
+}
+
+uint16_t SetSource(uint16_t source_state, byte b, bool v) {
+  if (v) source_state |= (0x01 << b);
+  else source_state &= ~(0x01 << b);
+  return source_state;
+}
+
+// As in NeuralNetwork::Controller() before LogicNetwork
+uint16_t Reference(LogicGate *gates, uint16_t source_state) {
+  for (byte n = 0; n < kGates; n++) {
+    bool set = gates[n].Calculate(source_state);
+    source_state = SetSource(source_state, 8 + n, set);
+  }
+  return source_state;
+}
+
+void RandomGate(LogicGate &gate) {
+  gate.state = 0;
+  gate.clocked = 0;
+  gate.type = random_range(LogicGateType::NONE, LogicGateType::TL_NEURON);
+  // Mostly inputs and other gates, sometimes ON and OFF
+  gate.source1 = random_range(0, LG_MAX_SOURCE);
+  gate.source2 = random_range(0, LG_MAX_SOURCE);
+  gate.source3 = random_range(0, LG_MAX_SOURCE);
+  gate.weight1 = random_range(-9, 9);
+  gate.weight2 = random_range(-9, 9);
+  gate.weight3 = random_range(-9, 9);
+  gate.threshold = random_range(-27, 27);
+}
+
+// Inputs mostly hold still between ticks, as clocks and gates do
+uint16_t NextInputs(uint16_t inputs) {
+  uint32_t r = xorshift();
+  if (r % 4 == 0) inputs ^= 1 << ((r >> 8) % 8);
+  if (r % 16 == 1) inputs = (r >> 16) & 0xff;
+  return inputs;
+}
+
+bool Compare(const LogicGate *expected, const LogicGate *actual, uint16_t expected_state, uint16_t actual_state,
+             unsigned network, unsigned tick) {
+  bool ok = expected_state == actual_state;
+  for (int g = 0; g < kGates; ++g) {
+    ok &= expected[g].state == actual[g].state;
+    ok &= expected[g].source_state == actual[g].source_state;
+  }
+  if (!ok) {
+    printf("  network %u, tick %u: source state %04x, expected %04x\n", network, tick, actual_state, expected_state);
+    for (int g = 0; g < kGates; ++g) {
+      printf("    gate %d: %-4s %2d %2d %2d state %d, expected %d\n", g, gate_name[expected[g].type],
+             expected[g].source1, expected[g].source2, expected[g].source3, actual[g].state, expected[g].state);
+    }
+  }
+  return ok;
+}
+
+bool TestEquivalence(unsigned networks, unsigned ticks) {
+  unsigned failures = 0, edits = 0;
+  for (unsigned n = 0; n < networks && failures < 4; ++n) {
+    LogicGate expected[kGates], actual[kGates];
+    for (int g = 0; g < kGates; ++g) {
+      RandomGate(expected[g]);
+      actual[g] = expected[g];
+    }
+    LogicNetwork network;
+    network.Compile(actual, kGates);
+
+    uint16_t inputs = xorshift() & 0xff;
+    uint16_t expected_state = 0, actual_state = 0;
+    for (unsigned t = 0; t < ticks; ++t) {
+      if (xorshift() % 64 == 0) {
+        // Edit a parameter of one gate
+        int g = xorshift() % kGates;
+        byte cursor = xorshift() % 8;
+        int direction = (xorshift() & 1) ? 1 : -1;
+        expected[g].UpdateValue(cursor, direction);
+        actual[g].UpdateValue(cursor, direction);
+        network.Compile(actual, kGates);
+        ++edits;
+      }
+
+      inputs = NextInputs(inputs);
+      expected_state = Reference(expected, (expected_state & 0xff00) | inputs);
+      actual_state = network.Evaluate((actual_state & 0xff00) | inputs);
+      if (!Compare(expected, actual, expected_state, actual_state, n, t)) {
+        ++failures;
+        break;
+      }
+    }
+  }
+  printf("%u random networks, %u ticks each, %u edits: %s\n", networks, ticks, edits, failures ? "FAIL" : "ok");
+  return !failures;
+}
+
+// Time per tick for all six gates, over a mix of networks. Inputs either
+// change every tick, which is the worst case for LogicNetwork, or mostly hold.
+void Benchmark(bool change_every_tick) {
+  const unsigned kNetworks = 1000, kTicks = 1000;
+  double reference_ns = 0, network_ns = 0;
+  volatile uint16_t sink = 0;
+
+  for (unsigned n = 0; n < kNetworks; ++n) {
+    LogicGate expected[kGates], actual[kGates];
+    for (int g = 0; g < kGates; ++g) {
+      RandomGate(expected[g]);
+      actual[g] = expected[g];
+    }
+    LogicNetwork network;
+    network.Compile(actual, kGates);
+
+    uint16_t inputs[kTicks];
+    uint16_t in = 0;
+    for (unsigned t = 0; t < kTicks; ++t) {
+      in = change_every_tick ? (in + 1 + xorshift() % 255) & 0xff : NextInputs(in);
+      inputs[t] = in;
+    }
+
+    uint16_t state = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < kTicks; ++t)
+      state = Reference(expected, (state & 0xff00) | inputs[t]);
+    auto middle = std::chrono::steady_clock::now();
+    sink = sink + state;
+    state = 0;
+    for (unsigned t = 0; t < kTicks; ++t)
+      state = network.Evaluate((state & 0xff00) | inputs[t]);
+    auto end = std::chrono::steady_clock::now();
+    sink = sink + state;
+
+    reference_ns += std::chrono::duration<double, std::nano>(middle - start).count();
+    network_ns += std::chrono::duration<double, std::nano>(end - middle).count();
+  }
+
+  const double ticks = kNetworks * kTicks;
+  printf("inputs %-22s LogicGate %6.1f ns/tick, LogicNetwork %6.1f ns/tick, %.1fx\n",
+         change_every_tick ? "change every tick:" : "mostly hold:",
+         reference_ns / ticks, network_ns / ticks, reference_ns / network_ns);
+}
+
+}; // namespace
+
+int main(int argc, char **argv) {
+  bool bench = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--bench")) bench = true;
+    else random_state = strtoul(argv[i], nullptr, 0) | 1;
+  }
+
+  bool ok = TestEquivalence(20000, 500);
+  if (bench) {
+    Benchmark(true);
+    Benchmark(false);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,260 @@
+// Bit-exactness test for util::LogisticMap (util/util_logistic_map.h), which
+// computes in uint32_t with multiply_u32xu32_rshift24(), against the int64_t
+// version it replaced, kept here as the reference. Every r and seed is
+// clocked for a while with both, and then r and the seed are changed on the
+// fly as in Quantermain, which sets r on every tick.
+//
+// The statistical check makes sure the fixed-point map still behaves like the
+// logistic map: orbits stay in (0, 1], r = 3 settles on 1 - 1/r, and for
+// r = 3.996 (the largest) the distribution of x is close to the invariant
+// density of r = 4.
+//
+//   logisticmap_test [SEED]
+//   logisticmap_test --bench [SEED]   also time Clock()
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "util/util_logistic_map.h"
+
+namespace reference {
+
+// util::LogisticMap before the 32-bit multiplies
+class LogisticMap {
+public:
+  static const int64_t kONE = 1 << 24;
+  static const int64_t kDefaultSeed = 1 << 16; // 1.0 = 1 << 24
+  static const int64_t kDefaultR = 3.6 * kONE;
+
+  void Init() {
+    x_ = seed_ = kDefaultSeed;
+    r_ = kDefaultR;
+  }
+
+  int64_t Clock() {
+    next_x_ = (r_ * ((x_ * (kONE - x_)) >> 24)) >> 24;
+    x_ = next_x_;
+    return x_ ;
+  }
+
+  void set_seed(uint8_t seed) {
+    if (seed_ != seed << 16) {
+      seed_ = seed << 16 ; // seed range 1 to 255 = 1/256 to 1
+      x_ = seed_;
+    }
+  }
+
+  void set_r(uint8_t r) {
+    r_ = ((3 << 8) + r) << 16;  // r needs to be between 3.0 and < 4.0
+  }
+
+  uint32_t get_register() const {
+    return x_;
+  }
+
+private:
+  int64_t seed_;
+  int64_t r_;
+  int64_t x_;
+  int64_t next_x_;
+};
+
+}; // namespace reference
+
+namespace {
+
+const uint32_t kONE = util::LogisticMap::kONE;
+
+uint32_t random_state = 1;
+
+uint32_t xorshift() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+bool Compare(int64_t expected, uint32_t actual, const reference::LogisticMap &e, const util::LogisticMap &a,
+             const char *when, int r, int seed, unsigned t) {
+  if (expected == actual && e.get_register() == a.get_register())
+    return true;
+  printf("  %s, r %d, seed %d, clock %u: %u, expected %lld\n", when, r, seed, t, actual,
+         static_cast<long long>(expected));
+  return false;
+}
+
+bool TestAllSettings(unsigned clocks) {
+  unsigned failures = 0;
+  for (int r = 0; r < 256 && failures < 4; ++r) {
+    for (int seed = 0; seed < 256 && failures < 4; ++seed) {
+      reference::LogisticMap expected;
+      util::LogisticMap actual;
+      expected.Init();
+      actual.Init();
+      expected.set_r(r);
+      actual.set_r(r);
+      expected.set_seed(seed);
+      actual.set_seed(seed);
+      for (unsigned t = 0; t < clocks; ++t) {
+        const int64_t e = expected.Clock();
+        const uint32_t a = actual.Clock();
+        if (!Compare(e, a, expected, actual, "fixed", r, seed, t)) {
+          ++failures;
+          break;
+        }
+      }
+    }
+  }
+  printf("%-44s %u clocks each: %s\n", "every r and seed", clocks, failures ? "FAIL" : "ok");
+  return !failures;
+}
+
+// As in QQ: r follows a CV and is set before every clock, and the seed is
+// reset now and then
+bool TestModulated(unsigned runs, unsigned clocks) {
+  unsigned failures = 0;
+  for (unsigned run = 0; run < runs && failures < 4; ++run) {
+    reference::LogisticMap expected;
+    util::LogisticMap actual;
+    expected.Init();
+    actual.Init();
+    int r = xorshift() & 0xff, seed = 0;
+    for (unsigned t = 0; t < clocks; ++t) {
+      const uint32_t random = xorshift();
+      if (random % 4 == 0) r = (r + (random >> 8) % 9 - 4) & 0xff;
+      if (random % 256 == 1) r = (random >> 8) & 0xff;
+      expected.set_r(r);
+      actual.set_r(r);
+      if (random % 512 == 2) {
+        seed = (random >> 16) & 0xff;
+        expected.set_seed(seed);
+        actual.set_seed(seed);
+      }
+      const int64_t e = expected.Clock();
+      const uint32_t a = actual.Clock();
+      if (!Compare(e, a, expected, actual, "modulated", r, seed, t)) {
+        ++failures;
+        break;
+      }
+    }
+  }
+  printf("%-44s %u runs: %s\n", "r and seed changing while running", runs, failures ? "FAIL" : "ok");
+  return !failures;
+}
+
+bool TestStatistics(unsigned clocks) {
+  const unsigned kSettle = 1000;
+  const int kBins = 16;
+  bool ok = true;
+
+  // Orbits of every r and seed stay in (0, 1]; x = 0 would be stuck for good
+  unsigned out_of_range = 0;
+  for (int r = 0; r < 256; ++r) {
+    for (int seed = 1; seed < 256; ++seed) {
+      util::LogisticMap map;
+      map.Init();
+      map.set_r(r);
+      map.set_seed(seed);
+      for (unsigned t = 0; t < clocks; ++t) {
+        const uint32_t x = map.Clock();
+        if (!x || x > kONE) {
+          ++out_of_range;
+          break;
+        }
+      }
+    }
+  }
+  ok &= !out_of_range;
+
+  // r = 3 settles on the fixed point 1 - 1/r, from any seed. It's the period
+  // doubling point, so it gets there slowly.
+  double fixed_point_error = 0;
+  for (int seed = 1; seed < 256; ++seed) {
+    util::LogisticMap map;
+    map.Init();
+    map.set_r(0);
+    map.set_seed(seed);
+    uint32_t x = 0;
+    for (unsigned t = 0; t < clocks; ++t)
+      x = map.Clock();
+    fixed_point_error = fmax(fixed_point_error, fabs(static_cast<double>(x) / kONE - 2.0 / 3.0));
+  }
+  ok &= fixed_point_error < 0.01;
+
+  // For r = 3.996, total variation distance of the distribution of x from
+  // the invariant density of r = 4, 1 / (pi * sqrt(x * (1 - x)))
+  unsigned histogram[kBins] = { 0 };
+  unsigned samples = 0;
+  for (int seed = 1; seed < 256; ++seed) {
+    util::LogisticMap map;
+    map.Init();
+    map.set_r(255);
+    map.set_seed(seed);
+    for (unsigned t = 0; t < kSettle + clocks; ++t) {
+      const uint32_t x = map.Clock();
+      if (t >= kSettle) {
+        ++histogram[std::min<uint32_t>(x / (kONE / kBins), kBins - 1)];
+        ++samples;
+      }
+    }
+  }
+  double distance = 0;
+  for (int b = 0; b < kBins; ++b) {
+    const double expected = (asin(sqrt((b + 1.0) / kBins)) - asin(sqrt(static_cast<double>(b) / kBins))) * 2 / M_PI;
+    distance += fabs(static_cast<double>(histogram[b]) / samples - expected) / 2;
+  }
+  ok &= distance < 0.1;
+
+  printf("%-44s %u out of range, r = 3 within %.4f of 2/3, r = 3.996 at %.3f from r = 4: %s\n", "statistics",
+         out_of_range, fixed_point_error, distance, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// Time per Clock(), which depends on the previous one, so this is latency
+template <typename MAP>
+void TimeClock(const char *name, unsigned clocks) {
+  MAP map;
+  map.Init();
+  map.set_r(255);
+  uint64_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+#if defined(__x86_64__) || defined(__i386__)
+  const uint64_t start_cycles = __rdtsc();
+#endif
+  for (unsigned t = 0; t < clocks; ++t)
+    sum += map.Clock();
+#if defined(__x86_64__) || defined(__i386__)
+  const double cycles = static_cast<double>(__rdtsc() - start_cycles) / clocks;
+#else
+  const double cycles = 0;
+#endif
+  const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / clocks;
+  printf("%-8s %.2f ns/clock, %.1f TSC cycles/clock (%d)\n", name, ns, cycles, static_cast<int>(sum & 1));
+}
+
+}; // namespace
+
+int main(int argc, char **argv) {
+  bool bench = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--bench")) bench = true;
+    else random_state = strtoul(argv[i], nullptr, 0) | 1;
+  }
+
+  bool ok = true;
+  ok &= TestAllSettings(2000);
+  ok &= TestModulated(1000, 20000);
+  ok &= TestStatistics(2000);
+  if (bench) {
+    TimeClock<reference::LogisticMap>("int64", 1 << 26);
+    TimeClock<util::LogisticMap>("uint32", 1 << 26);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,289 @@
+// Tests for streams::LorenzEngine (streams_lorenz_generator.h).
+//
+// The Lorenz app runs the exact integrator through streams::LorenzGenerator,
+// which has to produce the same outputs as the two hand-copied int64
+// integrators it had before, kept here as the reference.
+//
+// LowerRenz runs the 32-bit fast path, which truncates some derivatives, so
+// its orbits part from the exact ones after a while, as any change to a
+// chaotic system would. For the LowerRenz rate and rho settings, the
+// distributions of its outputs over a long run have to stay close to the
+// exact path's: the total variation distance of their histograms below
+// kMaxDistance, and the means within kMaxMeanDifference DAC codes. For
+// comparison, the exact path's own first and second half differ by about
+// as much at high rates, and more at low ones.
+//
+//   lorenz_test [SEED]
+//   lorenz_test --bench [SEED]   also time both integrators
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+#include "streams_lorenz_generator.h"
+
+namespace reference {
+
+// The integration in streams::LorenzGenerator::Process() before
+// LorenzEngine, for one channel, with the outputs before they're mapped
+class LorenzGenerator {
+public:
+  void Init() {
+    Lx1_ = 0.1 * (1 << 24);
+    Ly1_ = 0;
+    Lz1_ = 0;
+    Rx1_ = 0.1 * (1 << 24);
+    Ry1_ = 0;
+    Rz1_ = 0;
+  }
+
+  void set_rho1(int16_t rho) {
+    rho1_ = (rho * (1 << 13)) + 24.0 * (1 << 24) ; // was 12
+    c1_ = (rho + (6 << 3)) * (1 << 13) ; // was 13
+  }
+
+  // Outputs in the order of LORENZ_OUTPUT_X1 ... ROSSLER_OUTPUT_Z1
+  void Process(int32_t freq1, bool reset1, uint8_t freq_range1, int32_t *scaled) {
+    static const int64_t sigma = 10.0 * (1 << 24);
+    static const int64_t beta = 8.0 / 3.0 * (1 << 24);
+    static const int64_t a = 0.1 * (1 << 24);
+    static const int64_t b = 0.1 * (1 << 24);
+
+    int32_t rate1 =  (freq1 >> 8);
+    if (rate1 < 0) rate1 = 0;
+    if (rate1 > 255) rate1 = 255;
+
+    if (reset1) Init() ;
+
+    // Lorenz 1
+    int64_t Ldt1 = static_cast<int64_t>(streams::lut_lorenz_rate[rate1] >> (5 - freq_range1)); // was 5
+    int32_t Lx1 = Lx1_ + (Ldt1 * ((sigma * (Ly1_ - Lx1_)) >> 24) >> 24);
+    int32_t Ly1 = Ly1_ + (Ldt1 * ((Lx1_ * (rho1_ - Lz1_) >> 24) - Ly1_) >> 24);
+    int32_t Lz1 = Lz1_ + (Ldt1 * ((Lx1_ * int64_t(Ly1_) >> 24) - (beta * Lz1_ >> 24)) >> 24);
+    Lx1_ = Lx1;
+    Ly1_ = Ly1;
+    Lz1_ = Lz1;
+    scaled[2] = ((Lz1 * 3) >> 16);
+    scaled[0] = ((Lx1 * 3) >> 16) + 32769;
+    scaled[1] = ((Ly1 * 3) >> 16) + 32769;
+    // Rossler 1
+    int64_t Rdt1 = static_cast<int64_t>(streams::lut_lorenz_rate[rate1] >> 0);
+    int32_t Rx1 = Rx1_ + ((Rdt1 * (-Ry1_ - Rz1_ )) >> 24);
+    int32_t Ry1 = Ry1_ + ((Rdt1 * (Rx1_ + ((a * Ry1_) >> 24))) >> 24);
+    int32_t Rz1 = Rz1_ + ((Rdt1 * (b + ((Rz1_ * (Rx1_ - c1_)) >> 24)))  >> 24);
+    Rx1_ = Rx1;
+    Ry1_ = Ry1;
+    Rz1_ = Rz1;
+    scaled[5] = (Rz1 >> 14);
+    scaled[3] = (Rx1 >> 14) + 32769;
+    scaled[4] = (Ry1 >> 14) + 32769;
+  }
+
+private:
+  int32_t Lx1_, Ly1_, Lz1_;
+  int32_t Rx1_, Ry1_, Rz1_;
+  int64_t rho1_, c1_;
+};
+
+}; // namespace reference
+
+namespace {
+
+const double kMaxDistance = 0.1;
+const double kMaxMeanDifference = 1000; // DAC codes, 1.5% of the range
+
+uint32_t random_state = 1;
+
+uint32_t xorshift() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+// Channel 1 and 2 outputs of LorenzGenerator that map to the reference's
+const uint8_t kDirectOutputs[2][6] = {
+  { streams::LORENZ_OUTPUT_X1, streams::LORENZ_OUTPUT_Y1, streams::LORENZ_OUTPUT_Z1,
+    streams::ROSSLER_OUTPUT_X1, streams::ROSSLER_OUTPUT_Y1, streams::ROSSLER_OUTPUT_Z1 },
+  { streams::LORENZ_OUTPUT_X2, streams::LORENZ_OUTPUT_Y2, streams::LORENZ_OUTPUT_Z2,
+    streams::ROSSLER_OUTPUT_X2, streams::ROSSLER_OUTPUT_Y2, streams::ROSSLER_OUTPUT_Z2 },
+};
+
+// As in the Lorenz app: the frequencies and rhos follow the settings and CVs,
+// and the channels are reset now and then
+bool TestExact(unsigned runs, unsigned steps) {
+  unsigned failures = 0;
+  for (unsigned run = 0; run < runs && failures < 4; ++run) {
+    reference::LorenzGenerator expected[2];
+    streams::LorenzGenerator actual;
+    int32_t freq[2], rho[2];
+    uint8_t range[2];
+    for (int c = 0; c < 2; ++c) {
+      expected[c].Init();
+      actual.Init(c);
+      freq[c] = xorshift() & 0xffff;
+      rho[c] = xorshift() & 0x7fff;
+      range[c] = xorshift() % 5;
+    }
+    // Two outputs of each channel, different ones each run
+    uint8_t outputs[4];
+    for (int i = 0; i < 4; ++i)
+      outputs[i] = xorshift() % 6;
+    actual.set_out_a(kDirectOutputs[0][outputs[0]]);
+    actual.set_out_b(kDirectOutputs[0][outputs[1]]);
+    actual.set_out_c(kDirectOutputs[1][outputs[2]]);
+    actual.set_out_d(kDirectOutputs[1][outputs[3]]);
+
+    for (unsigned t = 0; t < steps; ++t) {
+      bool reset[2] = { false, false };
+      for (int c = 0; c < 2; ++c) {
+        const uint32_t r = xorshift();
+        if (r % 16 == 0) freq[c] = (freq[c] + (r >> 8) % 1025 - 512) & 0xffff;
+        if (r % 64 == 1) rho[c] = (r >> 8) & 0x7fff;
+        if (r % 1024 == 2) range[c] = (r >> 8) % 5;
+        reset[c] = r % 4096 == 3;
+        expected[c].set_rho1(rho[c]);
+      }
+      actual.set_rho1(rho[0]);
+      actual.set_rho2(rho[1]);
+
+      int32_t scaled[2][6];
+      expected[0].Process(freq[0], reset[0], range[0], scaled[0]);
+      expected[1].Process(freq[1], reset[1], range[1], scaled[1]);
+      actual.Process(freq[0], freq[1], reset[0], reset[1], range[0], range[1]);
+
+      for (int i = 0; i < 4; ++i) {
+        const uint16_t e = scaled[i >> 1][outputs[i]];
+        if (actual.dac_code(i) != e) {
+          printf("  run %u, step %u: output %d is %u, expected %u\n", run, t, i, actual.dac_code(i), e);
+          ++failures;
+          t = steps;
+          break;
+        }
+      }
+    }
+  }
+  printf("%-40s %u runs: %s\n", "Lorenz app, exact vs. int64", runs, failures ? "FAIL" : "ok");
+  return !failures;
+}
+
+struct OutputStats {
+  static const int kBins = 32;
+  double histogram[kBins];
+  double sum;
+  unsigned count;
+
+  void Add(int32_t value) {
+    int bin = value * kBins / 65536;
+    ++histogram[bin < 0 ? 0 : (bin >= kBins ? kBins - 1 : bin)];
+    sum += value;
+    ++count;
+  }
+
+  double mean() const {
+    return sum / count;
+  }
+
+  double Distance(const OutputStats &other) const {
+    double distance = 0;
+    for (int b = 0; b < kBins; ++b)
+      distance += fabs(histogram[b] / count - other.histogram[b] / other.count) / 2;
+    return distance;
+  }
+};
+
+// LowerRenz's settings, as HEM_LowerRenz and LorenzGeneratorManager set them
+bool TestFast(unsigned steps) {
+  const int kFreqs[] = { 0, 64, 128, 160, 192, 224, 255 };
+  const int kRhos[] = { 4, 32, 64, 96, 127 };
+  bool ok = true;
+  double worst_distance = 0, worst_mean = 0;
+  unsigned first_divergence = steps;
+
+  for (int freq : kFreqs) {
+    for (int rho : kRhos) {
+      streams::LorenzEngine<1> exact, fast;
+      exact.Init();
+      fast.Init();
+      fast.set_fast(true);
+      const int32_t f = ((freq + 1) << 8) - 1; // SCALE8_16
+      const int16_t r = std::min(((rho + 1) << 8) - 1, 0x7fff); // int16_t in SetRho()
+      exact.set_rate(0, f, 2);
+      fast.set_rate(0, f, 2);
+      exact.set_rho(0, r);
+      fast.set_rho(0, r);
+
+      OutputStats exact_stats[2] = {}, fast_stats[2] = {};
+      for (unsigned t = 0; t < steps; ++t) {
+        exact.Process();
+        fast.Process();
+        const int32_t e[2] = { exact.lorenz_x(0), exact.lorenz_y(0) };
+        const int32_t a[2] = { fast.lorenz_x(0), fast.lorenz_y(0) };
+        if (t < first_divergence && (abs(e[0] - a[0]) > 655 || abs(e[1] - a[1]) > 655))
+          first_divergence = t;
+        for (int o = 0; o < 2; ++o) {
+          exact_stats[o].Add(e[o]);
+          fast_stats[o].Add(a[o]);
+        }
+      }
+
+      for (int o = 0; o < 2; ++o) {
+        const double distance = exact_stats[o].Distance(fast_stats[o]);
+        const double mean = fabs(exact_stats[o].mean() - fast_stats[o].mean());
+        if (distance > kMaxDistance || mean > kMaxMeanDifference) {
+          printf("  freq %d, rho %d, %c: distance %.3f, mean %.0f vs. %.0f\n", freq, rho, o ? 'y' : 'x', distance,
+                 fast_stats[o].mean(), exact_stats[o].mean());
+          ok = false;
+        }
+        worst_distance = std::max(worst_distance, distance);
+        worst_mean = std::max(worst_mean, mean);
+      }
+    }
+  }
+  printf("%-40s %u steps: distance <= %.3f, means within %.0f, 1%% apart after %u: %s\n",
+         "LowerRenz, fast vs. exact", steps, worst_distance, worst_mean, first_divergence, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+template <bool FAST>
+double TimeProcess(unsigned steps) {
+  streams::LorenzEngine<2> engine;
+  engine.Init();
+  engine.set_fast(FAST);
+  for (int i = 0; i < 2; ++i) {
+    engine.set_rate(i, 0xc000, 2);
+    engine.set_rho(i, 0x4000);
+  }
+  int32_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned t = 0; t < steps; ++t) {
+    engine.Process();
+    sum += engine.lorenz_x(0);
+  }
+  auto end = std::chrono::steady_clock::now();
+  volatile int32_t sink = sum;
+  (void)sink;
+  return std::chrono::duration<double, std::nano>(end - start).count() / steps;
+}
+
+}; // namespace
+
+int main(int argc, char **argv) {
+  bool bench = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--bench")) bench = true;
+    else random_state = strtoul(argv[i], nullptr, 0) | 1;
+  }
+
+  bool ok = true;
+  ok &= TestExact(200, 20000);
+  ok &= TestFast(2000000);
+  if (bench) {
+    const double exact = TimeProcess<false>(1 << 24), fast = TimeProcess<true>(1 << 24);
+    printf("LorenzEngine<2>::Process(): exact %.1f ns, fast %.1f ns, %.2fx\n", exact, fast, exact / fast);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+// The parts of the Teensy core that the tested headers use. USB MIDI is a
+// queue of SysEx messages to the module and a list of those it sent.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+typedef uint8_t byte;
+
+template <typename T, typename L, typename H>
+inline T constrain(T x, L low, H high) {
+  return x < low ? low : (x > high ? high : x);
+}
+
+class HostMIDI {
+public:
+  std::deque<std::vector<uint8_t>> in;
+  std::vector<std::vector<uint8_t>> out;
+
+  bool read() {
+    if (in.empty())
+      return false;
+    // The Teensy library's receive buffer is 60 bytes, and HSMIDI.h reads
+    // past the end of short messages
+    sysex_.assign(64, 0xf7);
+    std::copy(in.front().begin(), in.front().end(), sysex_.begin());
+    in.pop_front();
+    return true;
+  }
+
+  uint8_t getType() { return 7; }
+  uint8_t *getSysExArray() { return sysex_.data(); }
+
+  void sendSysEx(uint32_t length, const uint8_t *data) {
+    out.emplace_back(data, data + length);
+  }
+
+  void send_now() { }
+
+private:
+  std::vector<uint8_t> sysex_;
+};
+
+extern HostMIDI usbMIDI;
+
+#endif // HOST_ARDUINO_H_
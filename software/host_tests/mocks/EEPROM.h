@@ -0,0 +1,49 @@
+#ifndef HOST_EEPROM_H_
+#define HOST_EEPROM_H_
+
+// Teensy EEPROM library, backed by an array that counts the cells written
+
+#include <stddef.h>
+#include <stdint.h>
+
+class EEPROMClass {
+public:
+  static const size_t LENGTH = 2048;
+
+  uint8_t cells[LENGTH];
+  size_t writes = 0;
+
+  uint8_t read(int address) const {
+    return cells[address];
+  }
+
+  void write(int address, uint8_t value) {
+    cells[address] = value;
+    ++writes;
+  }
+
+  void update(int address, uint8_t value) {
+    if (cells[address] != value)
+      write(address, value);
+  }
+};
+
+extern EEPROMClass EEPROM;
+
+struct EERef {
+  int index;
+
+  operator uint8_t() const { return EEPROM.read(index); }
+  EERef &operator=(uint8_t value) { EEPROM.write(index, value); return *this; }
+  EERef &update(uint8_t value) { EEPROM.update(index, value); return *this; }
+};
+
+struct EEPtr {
+  int index;
+
+  EEPtr(int index_) : index(index_) { }
+  EERef operator*() { return EERef{index}; }
+  EEPtr operator++(int) { EEPtr p = *this; ++index; return p; }
+};
+
+#endif // HOST_EEPROM_H_
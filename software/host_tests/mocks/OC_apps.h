@@ -0,0 +1,20 @@
+#ifndef HOST_OC_APPS_H_
+#define HOST_OC_APPS_H_
+
+namespace OC {
+
+enum AppEvent {
+  APP_EVENT_SUSPEND,
+  APP_EVENT_RESUME,
+  APP_EVENT_SCREENSAVER_ON,
+  APP_EVENT_SCREENSAVER_OFF
+};
+
+namespace apps {
+  void Init(bool reset_settings);
+  void FlushSettings();
+};
+
+}; // namespace OC
+
+#endif // HOST_OC_APPS_H_
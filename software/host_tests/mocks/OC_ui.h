@@ -0,0 +1,17 @@
+#ifndef HOST_OC_UI_H_
+#define HOST_OC_UI_H_
+
+#include "UI/ui_events.h"
+
+namespace OC {
+
+enum UiControl {
+  CONTROL_BUTTON_UP   = 0x1,
+  CONTROL_BUTTON_DOWN = 0x2,
+  CONTROL_BUTTON_L    = 0x4,
+  CONTROL_BUTTON_R    = 0x8,
+};
+
+}; // namespace OC
+
+#endif // HOST_OC_UI_H_
@@ -0,0 +1,14 @@
+#ifndef HOST_DSPINST_H_
+#define HOST_DSPINST_H_
+
+// The parts of the Teensy audio library's DSP instructions that the tested
+// headers use, with the same truncation as the Cortex-M4 instructions.
+
+#include <stdint.h>
+
+// smmul: (a * b) >> 32
+static inline int32_t multiply_32x32_rshift32(int32_t a, int32_t b) {
+  return static_cast<int32_t>((static_cast<int64_t>(a) * b) >> 32);
+}
+
+#endif // HOST_DSPINST_H_
@@ -0,0 +1,20 @@
+#ifndef HOST_DISPLAY_H_
+#define HOST_DISPLAY_H_
+
+// Drawing is ignored
+
+#include <stdint.h>
+
+class HostGraphics {
+public:
+  void drawLine(int, int, int, int) { }
+  void drawRect(int, int, int, int) { }
+  void drawBitmap8(int, int, int, const uint8_t *) { }
+  void setPrintPos(int, int) { }
+  void print(const char *) { }
+  void print(int) { }
+};
+
+extern HostGraphics graphics;
+
+#endif // HOST_DISPLAY_H_
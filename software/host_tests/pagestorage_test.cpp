@@ -0,0 +1,246 @@
+// Power-cut test for PageStorage (util/util_pagestorage.h). A save is cut
+// short after every possible number of byte writes, optionally tearing the
+// byte being written, and the storage is then loaded as on the next boot. The
+// load has to return either the old or the new data, and never anything else.
+//
+// The regions are laid out like the global settings and app data in
+// OC_config.h (a single page with a few bytes to spare), plus one with several
+// pages. Saves that change more bytes than fit in a single page's journal
+// can lose the data, but still mustn't load a mix.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util/util_pagestorage.h"
+
+void serial_printf(const char *fmt, ...) { }
+
+namespace {
+
+uint32_t random_state = 1;
+
+uint32_t xorshift() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+// EEPROM that loses power after a given number of byte writes
+struct SimStorage {
+  static const size_t LENGTH = 2048;
+
+  static uint8_t memory[LENGTH];
+  static long writes_left; // < 0: no limit
+  static bool tear; // Write garbage to the byte at which power is lost
+  static size_t writes;
+
+  static void update(size_t addr, const void *data, size_t length) {
+    const uint8_t *src = (const uint8_t *)data;
+    for (size_t i = 0; i < length; ++i) {
+      if (memory[addr + i] != src[i])
+        write(addr + i, src + i, 1);
+    }
+  }
+
+  static void write(size_t addr, const void *data, size_t length) {
+    const uint8_t *src = (const uint8_t *)data;
+    for (size_t i = 0; i < length; ++i) {
+      ++writes;
+      if (!writes_left)
+        continue;
+      if (1 == writes_left && tear) {
+        memory[addr + i] = xorshift();
+        writes_left = 0;
+        continue;
+      }
+      memory[addr + i] = src[i];
+      if (writes_left > 0)
+        --writes_left;
+    }
+  }
+
+  static void read(size_t addr, void *data, size_t length) {
+    memcpy(data, memory + addr, length);
+  }
+};
+
+uint8_t SimStorage::memory[SimStorage::LENGTH];
+long SimStorage::writes_left = -1;
+bool SimStorage::tear = false;
+size_t SimStorage::writes = 0;
+
+template <size_t SIZE>
+struct Data {
+  static const uint32_t FOURCC = ::FOURCC<'T', 'S', 'T', SIZE & 0xff>::value;
+  uint8_t bytes[SIZE];
+
+  bool operator==(const Data &other) const {
+    return !memcmp(bytes, other.bytes, SIZE);
+  }
+};
+
+struct Result {
+  unsigned cuts;
+  unsigned old_data;
+  unsigned new_data;
+  unsigned not_loaded;
+  unsigned failures;
+};
+
+// Same as CommitSettings
+const size_t kCommitBytes = 4;
+
+template <typename STORAGE, typename DATA>
+bool RunCut(const DATA &a, const DATA &b, long cut, bool tear, Result &result) {
+  // Start out with a saved
+  memset(SimStorage::memory, 0xff, SimStorage::LENGTH);
+  SimStorage::writes_left = -1;
+  {
+    STORAGE storage;
+    DATA loaded;
+    storage.Load(loaded);
+    storage.Save(a);
+  }
+
+  SimStorage::writes = 0;
+  SimStorage::writes_left = cut;
+  SimStorage::tear = tear;
+  {
+    STORAGE storage;
+    DATA loaded;
+    if (!storage.Load(loaded) || !(loaded == a)) {
+      ++result.failures;
+      return false;
+    }
+    storage.BeginSave(b);
+    while (storage.Commit(kCommitBytes)) { }
+  }
+  const bool complete = SimStorage::writes_left != 0;
+
+  // Next boot
+  SimStorage::writes_left = -1;
+  STORAGE storage;
+  DATA loaded;
+  memset(&loaded, 0, sizeof(loaded));
+  ++result.cuts;
+  if (!storage.Load(loaded)) {
+    ++result.not_loaded;
+  } else if (loaded == a) {
+    ++result.old_data;
+  } else if (loaded == b) {
+    ++result.new_data;
+  } else {
+    printf("  cut after %ld writes%s: loaded a mix of old and new data\n", cut, tear ? " (torn)" : "");
+    ++result.failures;
+  }
+  if (complete && !(loaded == b)) {
+    printf("  uninterrupted save not loaded\n");
+    ++result.failures;
+  }
+
+  // Storage has to be usable again afterwards
+  DATA c = b;
+  c.bytes[0] ^= 0x5a;
+  storage.Save(c);
+  STORAGE reloaded;
+  if (!reloaded.Load(loaded) || !(loaded == c)) {
+    printf("  cut after %ld writes%s: save after recovery failed\n", cut, tear ? " (torn)" : "");
+    ++result.failures;
+  }
+  return complete;
+}
+
+template <typename STORAGE, typename DATA>
+bool Test(const char *name, size_t changes, bool atomic) {
+  DATA a, b;
+  for (auto &byte : a.bytes) byte = xorshift();
+  b = a;
+  if (changes) {
+    for (size_t i = 0; i < changes; ++i)
+      b.bytes[xorshift() % sizeof(b.bytes)] ^= 1 + xorshift() % 255;
+  } else {
+    for (auto &byte : b.bytes) byte = xorshift();
+  }
+
+  Result result = {};
+  for (int tear = 0; tear < 2; ++tear) {
+    for (long cut = 0; ; ++cut) {
+      if (RunCut<STORAGE>(a, b, cut, tear, result))
+        break;
+    }
+  }
+
+  if (atomic && result.not_loaded) {
+    printf("  %u cuts lost the data\n", result.not_loaded);
+    ++result.failures;
+  }
+  printf("%-44s %5u cuts: %5u old, %5u new, %5u not loaded: %s\n", name,
+         result.cuts, result.old_data, result.new_data, result.not_loaded,
+         result.failures ? "FAIL" : "ok");
+  return !result.failures;
+}
+
+// A page written before the checksum covered the header
+template <typename STORAGE, typename DATA, size_t BASE_ADDR>
+bool TestLegacyChecksum(const char *name) {
+  DATA a;
+  for (auto &byte : a.bytes) byte = xorshift();
+
+  struct {
+    uint32_t fourcc;
+    uint32_t generation;
+    uint16_t size;
+    uint16_t checksum;
+    DATA data;
+  } __attribute__((aligned(2))) page;
+  static_assert(sizeof(page) == STORAGE::PAGESIZE, "page layout");
+
+  page.fourcc = DATA::FOURCC;
+  page.generation = 7;
+  page.size = sizeof(DATA);
+  page.data = a;
+  uint16_t c = 0;
+  for (size_t i = 0; i < sizeof(page) - 12; ++i)
+    c += ((const uint8_t *)&page.data)[i];
+  page.checksum = c ^ 0xffff;
+
+  memset(SimStorage::memory, 0xff, SimStorage::LENGTH);
+  memcpy(SimStorage::memory + BASE_ADDR, &page, sizeof(page));
+  STORAGE storage;
+  DATA loaded;
+  bool ok = storage.Load(loaded) && loaded == a;
+  printf("%-44s %s\n", name, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// Layouts as in OC_config.h
+typedef Data<720> Settings;
+typedef Data<1008> AppData;
+typedef Data<100> Small;
+typedef PageStorage<SimStorage, 128, 960, Settings> SettingsStorage;
+typedef PageStorage<SimStorage, 960, 2048, AppData> AppDataStorage;
+typedef PageStorage<SimStorage, 0, 400, Small> MultiPageStorage;
+
+static_assert(1 == SettingsStorage::PAGES && SettingsStorage::JOURNAL_LENGTH, "journaled");
+static_assert(1 == AppDataStorage::PAGES && AppDataStorage::JOURNAL_LENGTH, "journaled");
+static_assert(MultiPageStorage::PAGES > 1 && !MultiPageStorage::JOURNAL_LENGTH, "not journaled");
+
+}; // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1)
+    random_state = strtoul(argv[1], nullptr, 0) | 1;
+
+  bool ok = true;
+  ok &= Test<SettingsStorage, Settings>("settings, 1 byte changed", 1, true);
+  ok &= Test<SettingsStorage, Settings>("settings, 8 bytes changed", 8, true);
+  ok &= Test<SettingsStorage, Settings>("settings, all changed (no journal)", 0, false);
+  ok &= Test<AppDataStorage, AppData>("app data, 1 byte changed", 1, true);
+  ok &= Test<AppDataStorage, AppData>("app data, 6 bytes changed", 6, true);
+  ok &= Test<AppDataStorage, AppData>("app data, all changed (no journal)", 0, false);
+  ok &= Test<MultiPageStorage, Small>("multiple pages, 1 byte changed", 1, true);
+  ok &= Test<MultiPageStorage, Small>("multiple pages, all changed", 0, true);
+  ok &= TestLegacyChecksum<SettingsStorage, Settings, 128>("settings, checksum without header");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,550 @@
+// Equivalence test for VectorOscillator (vector_osc/HSVectorOscillator.h),
+// which caches per-segment tables and binary-searches the segment in
+// Phase(), against the version that worked everything out on each call,
+// kept here as the reference.
+//
+// Random oscillators are run with both, comparing every Next() and a Phase()
+// at a random angle on each tick, while segments, scale, frequency and
+// sustain/release change now and then, as from the apps. Segment times go up
+// to 255, so the running total often doesn't fit in a byte and Phase() takes
+// its linear fallback. Phase() is also compared at every angle, for random
+// oscillators and for ones whose total time is always over 255.
+//
+// Both versions divide by zero for a zero frequency or total time;
+// cortex_m4_divide.h makes that behave as on the module. An oscillator
+// without segments isn't compared, since the old code read before the
+// segment array; the new one has to output its offset.
+//
+//   vectorosc_test [SEED]
+//   vectorosc_test --bench [SEED]   also time Phase() and Next()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include <Arduino.h>
+#include "cortex_m4_divide.h"
+#include "vector_osc/HSVectorOscillator.h"
+
+namespace reference {
+
+// VectorOscillator before the segment tables
+class VectorOscillator {
+public:
+    /* Oscillator defaults to cycling. Turn off cycling for EGs, etc */
+    void Cycle(bool cycle_ = 1) {cycle = cycle_;}
+
+    /* Oscillator defaults to non-sustaining. Turing on for EGs, etc. */
+    void Sustain(bool sustain_ = 1) {sustain = sustain_;}
+
+    /* Move to the release stage after sustain */
+    void Release() {
+        sustained = 0;
+        segment_index = segment_count - 1;
+        rise = calculate_rise(segment_index);
+//        if (rise == 0) countdown = 1;
+    }
+
+    /* The offset amount will be added to each voltage output */
+    void Offset(int32_t offset_) {offset = offset_;}
+
+    /* Add a new segment to the end */
+    void SetSegment(HS::VOSegment segment) {
+        if (segment_count < HS::VO_MAX_SEGMENTS) {
+            memcpy(&segments[segment_count], &segment, sizeof(segments[segment_count]));
+            total_time += segments[segment_count].time;
+            segment_count++;
+        }
+    }
+
+    /* Update an existing segment */
+    void SetSegment(byte ix, HS::VOSegment segment) {
+        ix = constrain(ix, 0, segment_count - 1);
+        total_time -= segments[ix].time;
+        memcpy(&segments[ix], &segment, sizeof(segments[ix]));
+        total_time += segments[ix].time;
+        if (ix == segment_count) segment_count++;
+    }
+
+    HS::VOSegment GetSegment(byte ix) {
+        ix = constrain(ix, 0, segment_count - 1);
+        return segments[ix];
+    }
+
+    void SetScale(uint16_t scale_) {scale = scale_;}
+
+    /* frequency is centihertz (e.g., 440 Hz is 44000) */
+    void SetFrequency(uint32_t frequency_) {
+        frequency = frequency_;
+        rise = calculate_rise(segment_index);
+    }
+
+    bool GetEOC() {return eoc;}
+
+    byte TotalTime() {return total_time;}
+
+    byte SegmentCount() {return segment_count;}
+
+    void Start() {
+        Reset();
+        eoc = 0;
+    }
+
+    void Reset() {
+        segment_index = 0;
+        signal = scale_level(segments[segment_count - 1].level);
+        rise = calculate_rise(segment_index);
+        sustained = 0;
+        eoc = !cycle;
+    }
+
+    int32_t Next() {
+    		// For non-cycling waveforms, send the level of the last step if eoc
+    		if (eoc && cycle == 0) {
+    			vosignal_t nr_signal = scale_level(segments[segment_count - 1].level);
+    			return signal2int(nr_signal) + offset;
+    		}
+        if (!sustained) { // Observe sustain state
+			eoc = 0;
+			if (validate()) {
+				if (rise) {
+					signal += rise;
+					if (rise >= 0 && signal >= target) advance_segment();
+					if (rise < 0 && signal <= target) advance_segment();
+				} else {
+					if (countdown) {
+						--countdown;
+						if (countdown == 0) advance_segment();
+					}
+				}
+			}
+        }
+        return signal2int(signal) + offset;
+    }
+
+    /* Get the value of the waveform at a specific phase. Degrees are expressed in tenths of a degree */
+    int32_t Phase(int degrees) {
+    		degrees = degrees % 3600;
+    		degrees = abs(degrees);
+
+    		// I need to find out which segment the specified phase occurs in
+    		byte time_index = Proportion(degrees, 3600, total_time);
+    		byte segment = 0;
+    		byte time = 0;
+    		for (byte ix = 0; ix < segment_count; ix++)
+    		{
+    			time += segments[ix].time;
+    			if (time > time_index) {
+    				segment = ix;
+    				break;
+    			}
+    		}
+
+    		// Where does this segment start, and how many degrees does it span?
+    		int start_degree = Proportion(time - segments[segment].time, total_time, 3600);
+    		int segment_degrees = Proportion(segments[segment].time, total_time, 3600);
+
+    		// Start and end point of the total segment
+    		int start = signal2int(scale_level(segment == 0 ? segments[segment_count - 1].level : segments[segment - 1].level));
+    		int end = signal2int(scale_level(segments[segment].level));
+
+    		// Determine the signal based on the levels and the position within the segment
+    		int signal = Proportion(degrees - start_degree, segment_degrees, end - start) + start;
+
+        return signal + offset;
+    }
+
+private:
+    VOSegment segments[12]; // Array of segments in this Oscillator
+    byte segment_count = 0; // Number of segments
+    int total_time = 0; // Sum of time values for all segments
+    vosignal_t signal = 0; // Current scaled signal << 10 for more precision
+    vosignal_t target = 0; // Target scaled signal. When the target is reached, the Oscillator moves to the next segment.
+    bool eoc = 1; // The most recent tick's next() read was the end of a cycle
+    byte segment_index = 0; // Which segment the Oscillator is currently traversing
+    vosignal_t rise; // The amount (per tick) the signal must rise to reach the target
+    uint32_t frequency; // In centihertz
+    uint16_t scale; // The maximum (and minimum negative) output for this Oscillator
+    uint32_t countdown; // Ticks left for a segment with a rise of 0
+    bool cycle = 1; // Waveform will cycle
+    int32_t offset = 0; // Amount added to each voltage output (e.g., to make it unipolar)
+    bool sustain = 0; // Waveform stops when it reaches the end of the penultimate stage
+    bool sustained = 0; // Current state of sustain. Only active when sustain = 1
+
+    /*
+     * The Oscillator can only oscillate if the following conditions are true:
+     *     (1) The frequency must be greater than 0
+     *     (2) There must be more than one steps
+     *     (3) The total time must be greater than 0
+     *     (4) The scale is greater than 0
+     */
+    bool validate() {
+        bool valid = 1;
+        if (frequency == 0) valid = 0;
+        if (segment_count < 2) valid = 0;
+        if (total_time == 0) valid = 0;
+        if (scale == 0) valid = 0;
+        return valid;
+    }
+
+    int32_t Proportion(int numerator, int denominator, int max_value) {
+        vosignal_t proportion = int2signal((int32_t)numerator) / (int32_t)denominator;
+        int32_t scaled = signal2int(proportion * max_value);
+        return scaled;
+    }
+
+    /*
+     * Provide a signal value based on a segment level. The segment level is internally
+     * 0-255, and this is converted to a bipolar value by subtracting 128.
+     */
+    vosignal_t scale_level(byte level) {
+        int b_level = constrain(level, 0, 255) - 128;
+        int scaled = Proportion(b_level, 127, scale);
+        vosignal_t scaled_level = int2signal(scaled);
+        return scaled_level;
+    }
+
+    void advance_segment() {
+        if (sustain && segment_index == segment_count - 2) {
+            sustained = 1;
+        } else {
+            if (++segment_index >= segment_count) {
+                if (cycle) Reset();
+                eoc = 1;
+            } else rise = calculate_rise(segment_index);
+            sustained = 0;
+        }
+    }
+
+    vosignal_t calculate_rise(byte ix) {
+        // Determine the target level for this segment
+        byte level = segments[ix].level;
+        int time = static_cast<uint32_t>(segments[ix].time);
+        target = scale_level(level);
+
+        // Determine the starting level of this segment to get the total segment rise
+        if (ix > 0) ix--;
+        else ix = segment_count - 1;
+        level = segments[ix].level;
+        vosignal_t starting = scale_level(level);
+
+        // How many ticks should a complete cycle last? cycle_ticks is 10 times that number.
+        int32_t cycle_ticks = 16666667 / frequency;
+
+        // How many ticks should the current segment last?
+        int32_t segment_ticks = Proportion(time, total_time, cycle_ticks);
+
+        // The total difference between the target and the current signal, divided by how many ticks
+        // it should take to get there, is the rise. The / 10 is to cancel the extra precision
+        // from the previous two calculations.
+        vosignal_t new_rise = 0;
+        if (segment_ticks > 0) {
+            new_rise = ((target - starting) * 10) / segment_ticks;
+            if (new_rise == 0) {
+                uint32_t prev_countdown = countdown;
+                countdown = segment_ticks / 10;
+                if (prev_countdown > 0 && prev_countdown < countdown) countdown = prev_countdown;
+            }
+
+            // The following line is here to deal with the cases where the signal is coming from a different
+            // direction than it would be coming from if it were coming from the previous segment. This can
+            // only happen when the Vector Oscillator is being used as an envelope generator with Sustain/Release,
+            // and the envelope is ungated prior to the sustain (penultimate) segment, and one of these happens:
+            //
+            // (1) The signal level at release is lower than the final signal level, but the sustain segment's
+            //     level is higher, OR
+            // (2) The signal level at release is higher than the final signal level, but the sustain segment's
+            //     level is lower.
+            //
+            // This scenario would result in a rise with the wrong polarity; that is, the signal would move away
+            // from the target instead of toward it. The remedy, as the Third Doctor would say, is to Reverse
+            // The Polarity. So I test for a difference in sign via multiplication. A negative result (value < 0)
+            // indicates that the rise is the reverse of what it should be:
+            else if ((signal2int(target) - signal2int(starting)) * (signal2int(target) - signal2int(signal)) < 0) new_rise = -new_rise;
+        } else {
+            signal = target;
+            countdown = 1;
+        }
+
+        return new_rise;
+    }
+};
+
+}; // namespace reference
+
+namespace {
+
+uint32_t random_state = 1;
+
+uint32_t xorshift() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+// Levels are often at either end or in the middle, times are short or long
+VOSegment RandomSegment(bool long_times) {
+  VOSegment segment;
+  uint32_t r = xorshift();
+  switch (r % 8) {
+    case 0: segment.level = 0; break;
+    case 1: segment.level = 255; break;
+    case 2: segment.level = 128; break;
+    default: segment.level = r >> 8;
+  }
+  r = xorshift();
+  if (r % 8 == 0) segment.time = 0;
+  else segment.time = long_times ? r >> 8 : (r >> 8) % 24;
+  return segment;
+}
+
+int32_t RandomScale() {
+  uint32_t r = xorshift();
+  if (r % 16 == 0) return 0;
+  return r % 2 ? 7680 : (r >> 8) % 9000; // HEMISPHERE_MAX_CV, or anything
+}
+
+uint32_t RandomFrequency() {
+  uint32_t r = xorshift();
+  if (r % 32 == 0) return 0;
+  return 1 + (r >> 8) % (r % 4 ? 2000 : 200000); // Centihertz, mostly LFO rates
+}
+
+int RandomDegrees() {
+  uint32_t r = xorshift();
+  return r % 4 ? (r >> 8) % 3600 : static_cast<int>((r >> 8) % 20000) - 10000;
+}
+
+// Applies the same change to both
+struct Pair {
+  reference::VectorOscillator expected;
+  VectorOscillator actual;
+
+  Pair() : expected(), actual() { }
+
+  void SetSegment(VOSegment segment) {
+    expected.SetSegment(segment);
+    actual.SetSegment(segment);
+  }
+  void SetSegment(byte ix, VOSegment segment) {
+    expected.SetSegment(ix, segment);
+    actual.SetSegment(ix, segment);
+  }
+  void SetScale(uint16_t scale) {
+    expected.SetScale(scale);
+    actual.SetScale(scale);
+  }
+  void SetFrequency(uint32_t frequency) {
+    expected.SetFrequency(frequency);
+    actual.SetFrequency(frequency);
+  }
+  void Configure(bool cycle, bool sustain, int32_t offset) {
+    expected.Cycle(cycle);
+    actual.Cycle(cycle);
+    expected.Sustain(sustain);
+    actual.Sustain(sustain);
+    expected.Offset(offset);
+    actual.Offset(offset);
+  }
+  void Start() {
+    expected.Start();
+    actual.Start();
+  }
+  void Reset() {
+    expected.Reset();
+    actual.Reset();
+  }
+  void Release() {
+    expected.Release();
+    actual.Release();
+  }
+};
+
+// A random oscillator with at least one segment, started
+void RandomOscillator(Pair &pair, bool long_times) {
+  const int segments = 1 + xorshift() % HS::VO_MAX_SEGMENTS;
+  for (int s = 0; s < segments; ++s)
+    pair.SetSegment(RandomSegment(long_times));
+  pair.SetScale(RandomScale());
+  pair.SetFrequency(RandomFrequency());
+  pair.Configure(xorshift() % 4, xorshift() % 4 == 0, xorshift() % 4 ? 0 : (xorshift() % 15360) - 7680);
+  pair.Start();
+}
+
+bool ComparePhase(Pair &pair, int degrees, unsigned oscillator, const char *when) {
+  const int32_t e = pair.expected.Phase(degrees);
+  const int32_t a = pair.actual.Phase(degrees);
+  if (e != a) {
+    printf("  oscillator %u, %s: Phase(%d) %d, expected %d\n", oscillator, when, degrees, a, e);
+    return false;
+  }
+  return true;
+}
+
+bool TestRandom(unsigned oscillators, unsigned ticks) {
+  unsigned failures = 0, edits = 0;
+  for (unsigned n = 0; n < oscillators && failures < 4; ++n) {
+    Pair pair;
+    const bool long_times = xorshift() % 2;
+    RandomOscillator(pair, long_times);
+
+    for (unsigned t = 0; t < ticks; ++t) {
+      const uint32_t r = xorshift();
+      if (r % 128 == 0) {
+        ++edits;
+        switch ((r >> 8) % 8) {
+          case 0: pair.SetSegment(xorshift() % pair.actual.SegmentCount(), RandomSegment(long_times)); break;
+          case 1: pair.SetSegment(RandomSegment(long_times)); break;
+          case 2: pair.SetScale(RandomScale()); break;
+          case 3: pair.SetFrequency(RandomFrequency()); break;
+          case 4: pair.Release(); break;
+          case 5: pair.Reset(); break;
+          case 6: pair.Start(); break;
+          default: pair.SetSegment(0, RandomSegment(long_times));
+        }
+      }
+
+      const int32_t e = pair.expected.Next();
+      const int32_t a = pair.actual.Next();
+      if (e != a || pair.expected.GetEOC() != pair.actual.GetEOC()) {
+        printf("  oscillator %u, tick %u: Next() %d, expected %d\n", n, t, a, e);
+        ++failures;
+        break;
+      }
+      if (!ComparePhase(pair, RandomDegrees(), n, "running")) {
+        ++failures;
+        break;
+      }
+    }
+    if (pair.actual.TotalTime() != pair.expected.TotalTime() || pair.actual.SegmentCount() != pair.expected.SegmentCount())
+      ++failures;
+  }
+  printf("%-48s %7u oscillators, %u edits: %s\n", "random oscillators, Next() and Phase()",
+         oscillators, edits, failures ? "FAIL" : "ok");
+  return !failures;
+}
+
+// Phase() at every tenth of a degree, and a few out of range
+bool TestPhaseSweep(unsigned oscillators, bool long_times, const char *name) {
+  unsigned failures = 0, wrapped = 0;
+  for (unsigned n = 0; n < oscillators && failures < 4; ++n) {
+    Pair pair;
+    if (long_times) {
+      // Always more than 255 in total
+      const int segments = 2 + xorshift() % (HS::VO_MAX_SEGMENTS - 1);
+      for (int s = 0; s < segments; ++s) {
+        VOSegment segment = RandomSegment(true);
+        segment.time = 256 / segments + 1 + xorshift() % (256 - 256 / segments);
+        pair.SetSegment(segment);
+      }
+    } else {
+      RandomOscillator(pair, xorshift() % 2);
+    }
+    pair.SetScale(RandomScale());
+
+    // TotalTime() is a byte too; count the ones whose running total wraps
+    int total = 0;
+    for (byte s = 0; s < pair.actual.SegmentCount(); ++s)
+      total += pair.actual.GetSegment(s).time;
+    if (total > 255) ++wrapped;
+
+    for (int degrees = -3610; degrees < 3610 && !failures; ++degrees)
+      failures += !ComparePhase(pair, degrees, n, "sweep");
+    for (int i = 0; i < 16 && !failures; ++i)
+      failures += !ComparePhase(pair, static_cast<int>(xorshift() >> 1) * (i % 2 ? -1 : 1), n, "sweep");
+  }
+  printf("%-48s %7u oscillators, %u over 255: %s\n", name, oscillators, wrapped, failures ? "FAIL" : "ok");
+  return !failures;
+}
+
+// No segments: outputs the offset, and mustn't read outside the segments
+bool TestEmpty() {
+  bool ok = true;
+  for (int cycle = 0; cycle < 2; ++cycle) {
+    VectorOscillator osc = VectorOscillator();
+    osc.Cycle(cycle);
+    osc.Offset(123);
+    osc.SetScale(7680);
+    osc.SetFrequency(100);
+    osc.Start();
+    for (int t = 0; t < 100; ++t) {
+      ok &= osc.Next() == 123;
+      ok &= osc.Phase(t * 36) == 123;
+    }
+    osc.Release();
+    osc.Reset();
+    ok &= osc.Next() == 123;
+    ok &= osc.SegmentCount() == 0 && osc.TotalTime() == 0;
+  }
+  printf("%-48s %s\n", "no segments", ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// Time per call, for oscillators with the maximum number of segments and
+// nonzero times and frequencies, so that nothing divides by zero
+template <typename OSC>
+double TimePhase(OSC *osc, unsigned count, const int *degrees, unsigned calls, int32_t &sum) {
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < calls; ++i)
+    sum += osc[i % count].Phase(degrees[i % 4096]);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+}
+
+template <typename OSC>
+double TimeNext(OSC *osc, unsigned count, unsigned calls, int32_t &sum) {
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < calls; ++i)
+    sum += osc[i % count].Next();
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+}
+
+void Benchmark() {
+  const unsigned kOscillators = 64, kCalls = 1 << 24;
+  static reference::VectorOscillator expected[kOscillators];
+  static VectorOscillator actual[kOscillators];
+  for (unsigned n = 0; n < kOscillators; ++n) {
+    Pair pair;
+    for (int s = 0; s < HS::VO_MAX_SEGMENTS; ++s) {
+      VOSegment segment = RandomSegment(false);
+      segment.time = 1 + segment.time % 20;
+      pair.SetSegment(segment);
+    }
+    pair.SetScale(7680);
+    pair.SetFrequency(1 + xorshift() % 2000);
+    pair.Start();
+    expected[n] = pair.expected;
+    actual[n] = pair.actual;
+  }
+  int degrees[4096];
+  for (auto &d : degrees) d = xorshift() % 3600;
+
+  int32_t sum = 0;
+  const double expected_phase = TimePhase(expected, kOscillators, degrees, kCalls, sum);
+  const double actual_phase = TimePhase(actual, kOscillators, degrees, kCalls, sum);
+  const double expected_next = TimeNext(expected, kOscillators, kCalls, sum);
+  const double actual_next = TimeNext(actual, kOscillators, kCalls, sum);
+  printf("Phase(): before %.1f ns, tables %.1f ns, %.1fx\n", expected_phase, actual_phase, expected_phase / actual_phase);
+  printf("Next():  before %.1f ns, tables %.1f ns, %.1fx (%d)\n", expected_next, actual_next, expected_next / actual_next, sum & 1);
+}
+
+}; // namespace
+
+int main(int argc, char **argv) {
+  bool bench = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--bench")) bench = true;
+    else random_state = strtoul(argv[i], nullptr, 0) | 1;
+  }
+  InstallDivideHandler();
+
+  bool ok = true;
+  ok &= TestRandom(4000, 2000);
+  ok &= TestPhaseSweep(2000, false, "Phase() at every angle");
+  ok &= TestPhaseSweep(1000, true, "Phase() at every angle, total time over 255");
+  ok &= TestEmpty();
+  if (bench)
+    Benchmark();
+  return ok ? 0 : 1;
+}
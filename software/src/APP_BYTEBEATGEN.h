@@ -81,6 +81,7 @@ public:
 
   static constexpr size_t kHistoryDepth = 64;
   static constexpr int kMaxByteBeatParameters = 12;
+  static constexpr size_t kBlockSize = 4;
 
   void Init(OC::DigitalInput default_trigger);
 
@@ -272,6 +273,42 @@ public:
   template <DAC_CHANNEL dac_channel>
   void Update(uint32_t triggers, const int32_t cvs[ADC_CHANNEL_LAST]) {
 
+    OC::DigitalInput trigger_input = get_trigger_input();
+    if (triggers & DIGITAL_INPUT_MASK(trigger_input))
+      pending_gate_state_ |= peaks::CONTROL_GATE_RISING;
+
+    bool gate_raised = OC::DigitalInputs::read_immediate(trigger_input);
+    if (gate_raised)
+      pending_gate_state_ |= peaks::CONTROL_GATE;
+    else if (gate_raised_)
+      pending_gate_state_ |= peaks::CONTROL_GATE_FALLING;
+    gate_raised_ = gate_raised;
+
+    // Samples are rendered kBlockSize at a time and then played out one per
+    // ISR; parameters and any gate edges seen since the last block take
+    // effect at the start of the next one.
+    if (block_pos_ >= kBlockSize) {
+      RenderBlock(cvs);
+      block_pos_ = 0;
+    }
+
+    // TODO Scale range or offset?
+    uint16_t b = block_[block_pos_++];
+    #ifdef BUCHLA_4U
+      uint32_t value = OC::DAC::get_zero_offset(dac_channel) + b;
+    #else
+      uint32_t value = OC::DAC::get_zero_offset(dac_channel) + (int16_t)b;
+    #endif
+    OC::DAC::set<dac_channel>(value);
+
+
+    b >>= 8;
+    if (b != history_.last()) // This make the effect a bit different
+      history_.Push(b);
+  }
+
+  void RenderBlock(const int32_t cvs[ADC_CHANNEL_LAST]) {
+
     int32_t s[kMaxByteBeatParameters];
     s[0] = SCALE8_16(static_cast<int32_t>(get_equation() << 4));
     s[1] = SCALE8_16(static_cast<int32_t>(get_speed()));
@@ -298,31 +335,9 @@ public:
        
     bytebeat_.Configure(s, get_step_mode(), get_loop_mode()) ; 
 
-    OC::DigitalInput trigger_input = get_trigger_input();
-    uint8_t gate_state = 0;
-    if (triggers & DIGITAL_INPUT_MASK(trigger_input))
-      gate_state |= peaks::CONTROL_GATE_RISING;
-
-    bool gate_raised = OC::DigitalInputs::read_immediate(trigger_input);
-    if (gate_raised)
-      gate_state |= peaks::CONTROL_GATE;
-    else if (gate_raised_)
-      gate_state |= peaks::CONTROL_GATE_FALLING;
-    gate_raised_ = gate_raised;
-
-    // TODO Scale range or offset?
-    uint16_t b = bytebeat_.ProcessSingleSample(gate_state);
-    #ifdef BUCHLA_4U
-      uint32_t value = OC::DAC::get_zero_offset(dac_channel) + b;
-    #else
-      uint32_t value = OC::DAC::get_zero_offset(dac_channel) + (int16_t)b;
-    #endif
-    OC::DAC::set<dac_channel>(value);
-
-
-    b >>= 8;
-    if (b != history_.last()) // This make the effect a bit different
-      history_.Push(b);
+    uint8_t control[kBlockSize] = { pending_gate_state_ };
+    pending_gate_state_ = 0;
+    bytebeat_.Render(control, block_, kBlockSize);
   }
 
   inline void ReadHistory(uint8_t *history) const {
@@ -332,6 +347,9 @@ public:
 private:
   peaks::ByteBeat bytebeat_;
   bool gate_raised_;
+  uint8_t pending_gate_state_;
+  uint16_t block_[kBlockSize];
+  size_t block_pos_;
   int32_t s_[kMaxByteBeatParameters];
 
   int num_enabled_settings_;
@@ -345,6 +363,9 @@ void ByteBeat::Init(OC::DigitalInput default_trigger) {
   apply_value(BYTEBEAT_SETTING_TRIGGER_INPUT, default_trigger);
   bytebeat_.Init();
   gate_raised_ = false;
+  pending_gate_state_ = 0;
+  memset(block_, 0, sizeof(block_));
+  block_pos_ = kBlockSize;
   update_enabled_settings();
   history_.Init(0);
 }
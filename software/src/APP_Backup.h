@@ -26,8 +26,76 @@
 #include "OC_apps.h"
 #include "OC_ui.h"
 #include "src/drivers/display.h"
+#include "util/EEPROMStorage.h"
+#include "util/util_crc32.h"
+#include "util/util_ringbuffer.h"
 #include "HSMIDI.h"
 
+/* Backup / Restore streaming protocol
+ *
+ * EEPROM is transferred in 32-byte pages, one page per SysEx frame. Every frame
+ * starts with a command byte. Command bytes are all >= 'A', which is how they are
+ * told apart from the original format, whose first byte was the page number (0-63).
+ * Old backup files can therefore still be restored.
+ *
+ *   'D' page d0..d31 crc0..crc3   Page data with CRC32 (LSB first) of the page number
+ *                                 and the 32 data bytes
+ *   'A' page                      Acknowledge a good page
+ *   'N' page                      Page was bad or missing, please (re)send it
+ *   'H' first h0..h31             Host's CRC32s of eight pages, starting at first
+ *   'S' mode                      Host requests a backup (mode 0 = data, 1 = calibration)
+ *   'E' count crc0..crc3          End of stream: number of pages sent and CRC32 of the
+ *                                 entire range, including pages skipped by delta mode
+ *
+ * Backup: the module streams 'D' frames from loop() and afterwards answers 'N'
+ * requests for as long as the app is open. If the host sent 'H' frames beforehand,
+ * pages whose CRC matches the host's copy are skipped (delta backup).
+ *
+ * Restore: each 'D' frame is checked against its CRC. Good pages are written with
+ * EEPROM.update(), so only changed cells are actually written, and answered with
+ * 'A'; bad pages are answered with 'N'. The host sends the whole range, so the
+ * count in its 'E' frame also tells the range: the data pages if it's their number,
+ * otherwise that many pages from page 0 (calibration, or a full dump). On 'E' the
+ * apps are re-initialized if every page of the range arrived and the range matches
+ * the CRC. Otherwise the module answers 'N' for each missing page, or for the whole
+ * range if the CRC doesn't match, and waits for the next 'E'. A legacy dump is
+ * applied after its last page.
+ *
+ * A host that ignores 'A' and 'N' (e.g. a plain SysEx librarian) still works; it
+ * just doesn't get retransmits. The largest frame is 38 bytes unpacked, 49 on the
+ * wire, which fits the 60-byte limit of the Teensy USB MIDI receive buffer.
+ */
+namespace backup {
+static constexpr uint8_t PAGE_SIZE = 32;
+static constexpr uint8_t PAGE_COUNT = EEPROMStorage::LENGTH / PAGE_SIZE;
+static constexpr uint8_t CALIBRATION_PAGES = EEPROM_CALIBRATIONDATA_END / PAGE_SIZE;
+static constexpr uint8_t HASHES_PER_FRAME = 8;
+
+enum Command : uint8_t {
+    CMD_ACK = 'A',
+    CMD_PAGE = 'D',
+    CMD_END = 'E',
+    CMD_HASHES = 'H',
+    CMD_NAK = 'N',
+    CMD_REQUEST = 'S',
+};
+
+inline uint32_t get_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline void put_u32(uint8_t *p, uint32_t v) {
+    for (uint8_t i = 0; i < 4; i++) p[i] = (v >> (i * 8)) & 0xff;
+}
+
+inline uint32_t page_crc(uint8_t p) {
+    util::CRC32 crc;
+    uint16_t address = p * PAGE_SIZE;
+    for (uint8_t b = 0; b < PAGE_SIZE; b++) crc.Update(EEPROM.read(address++));
+    return crc.value();
+}
+}; // namespace backup
+
 class Backup: public SystemExclusiveHandler {
 public:
     void Init() {
@@ -37,10 +105,76 @@ public:
     void Resume() {
         receiving = 0;
         packet = 0;
+        sending = 0;
+        reinit = 0;
+        pages_sent = 0;
+        acked = 0;
+        resent = 0;
+        errors = 0;
+        end_pending = 0;
+        nak_page = 0;
+        nak_end = 0;
+        ClearSkipPages();
+        ClearReceivedPages();
+        outbox.Init();
     }
 
+    // Also listens while sending, for the host's 'A' and 'N' frames
     void Controller() {
-        if (receiving) ListenForSysEx();
+        ListenForSysEx();
+    }
+
+    // Frames are sent from the main loop, a few per call, so the display keeps updating
+    void Loop() {
+        if (reinit) {
+            reinit = 0;
+            receiving = 0;
+            OC::apps::Init(0);
+            return;
+        }
+
+        if (end_pending) {
+            CheckRestore();
+            end_pending = 0;
+        }
+
+        // Retransmit requests for the pages still missing at the end of a restore
+        for (uint8_t n = 0; n < 4 && nak_page < nak_end; nak_page++)
+        {
+            if (!PageFlag(received_pages, nak_page)) {
+                SendCommand(backup::CMD_NAK, nak_page);
+                n++;
+            }
+        }
+
+        // Acknowledgements and retransmit requests queued by the ISR
+        for (uint8_t n = 0; n < 4 && outbox.readable(); n++)
+        {
+            uint8_t msg = outbox.Read();
+            uint8_t p = msg & (backup::PAGE_COUNT - 1);
+            if (msg & OUTBOX_RESEND) {
+                SendPage(p);
+                resent++;
+            }
+            else SendCommand((msg & OUTBOX_NAK) ? backup::CMD_NAK : backup::CMD_ACK, p);
+        }
+
+        if (sending) {
+            for (uint8_t n = 0; n < 4 && next_page < end_page; n++)
+            {
+                uint8_t p = next_page++;
+                packet = p;
+                if (!SkipPage(p)) {
+                    SendPage(p);
+                    pages_sent++;
+                }
+            }
+            if (next_page >= end_page) {
+                SendEnd();
+                sending = 0;
+                ClearSkipPages();
+            }
+        }
     }
     
     void View() {
@@ -48,63 +182,234 @@ public:
     }
     
     void ToggleReceiveMode() {
+        if (sending) return;
         receiving = 1 - receiving;
         packet = 0;
+        acked = 0;
+        errors = 0;
+        end_pending = 0;
+        nak_end = 0;
+        ClearReceivedPages();
     }
     
     void ToggleCalibration() {
-        if (!receiving) {
+        if (!receiving && !sending) {
             calibration = 1 - calibration;
             packet = 0;
         }
     }
 
     void OnSendSysEx() {
-        if (!receiving) {
+        if (!receiving && !sending) {
             packet = 0;
-            uint8_t V[33];
-            
-            byte start = calibration ? 0 : (EEPROM_CALIBRATIONDATA_END / 32);
-            byte end = calibration ?  (EEPROM_CALIBRATIONDATA_END / 32) : 64;
-            for (byte p = start; p < end; p++)
-            {
-                uint16_t address = p * 32;
-                uint8_t ix = 0;
-                V[ix++] = p; // Packet number
-                packet = p;
-                
-                // Wrap into 32-byte packets
-                for (byte b = 0; b < 32; b++) V[ix++] = EEPROM.read(address++);
-                
-                UnpackedData unpacked;
-                unpacked.set_data(ix, V);
-                PackedData packed = unpacked.pack();
-                SendSysEx(packed, 'B');
-            }
+            next_page = calibration ? 0 : backup::CALIBRATION_PAGES;
+            end_page = calibration ? backup::CALIBRATION_PAGES : backup::PAGE_COUNT;
+            pages_sent = 0;
+            acked = 0;
+            resent = 0;
+            sending = 1;
         }
     }
     
     void OnReceiveSysEx() {
-        uint8_t V[33];
+        uint8_t V[SYSEX_DATA_MAX_SIZE];
         if (ExtractSysExData(V, 'B')) {
-            uint8_t ix = 0;
-            uint8_t p = V[ix++]; // Get packet number
-            packet = p;
-            uint16_t address = p * 32;
-            for (byte b = 0; b < 32; b++) EEPROM.write(address++, V[ix++]);
-
-            // Reset on last packet
-            if (p == ((EEPROM_CALIBRATIONDATA_END / 32) - 1) || p == 63) {
-                receiving = 0;
-                OC::apps::Init(0);
+            if (V[0] < backup::PAGE_COUNT) {
+                if (receiving) ReceiveLegacyPage(V);
+                return;
+            }
+
+            uint8_t p = V[1] & (backup::PAGE_COUNT - 1);
+            switch (V[0]) {
+            case backup::CMD_PAGE:
+                if (receiving) ReceivePage(p, V + 1);
+                break;
+            case backup::CMD_END:
+                // The whole range is checked from Loop(), it takes too long for the ISR
+                if (receiving && !end_pending) {
+                    end_count = V[1];
+                    end_crc = backup::get_u32(V + 2);
+                    end_pending = 1;
+                }
+                break;
+            case backup::CMD_ACK:
+                acked++;
+                break;
+            case backup::CMD_NAK:
+                if (!receiving) QueueOutbox(p | OUTBOX_RESEND);
+                break;
+            case backup::CMD_HASHES:
+                if (!receiving && !sending) CompareHashes(p, V + 2);
+                break;
+            case backup::CMD_REQUEST:
+                if (!receiving && !sending) {
+                    calibration = V[1] ? 1 : 0;
+                    OnSendSysEx();
+                }
+                break;
             }
         }
     }
         
 private:
+    // Outbox entries are a page number plus flags, handed from the ISR to Loop()
+    static constexpr uint8_t OUTBOX_NAK = 0x40;
+    static constexpr uint8_t OUTBOX_RESEND = 0x80;
+
     bool calibration = 0;
     bool receiving = 0;
+    volatile bool sending = 0;
+    volatile bool reinit = 0;
+    volatile bool end_pending = 0; // An 'E' frame arrived during restore
+    uint8_t end_count; // Number of pages the host sent, from its 'E' frame
+    uint32_t end_crc; // CRC32 of the whole range, from the host's 'E' frame
+    uint8_t nak_page; // Next page to request again after an incomplete restore
+    uint8_t nak_end;
     uint8_t packet = 0;
+    uint8_t next_page;
+    uint8_t end_page;
+    uint8_t pages_sent;
+    uint8_t acked; // Pages acknowledged by the host during backup, or written during restore
+    uint8_t resent;
+    uint8_t errors; // Pages that failed the CRC check during restore
+    uint32_t skip_pages[2]; // Pages that match the host copy, for delta backup
+    uint32_t received_pages[2]; // Pages written since restore started
+    util::RingBuffer<uint8_t, 64> outbox;
+
+    static bool PageFlag(const uint32_t *flags, uint8_t p) {
+        return (flags[p >> 5] >> (p & 0x1f)) & 0x01;
+    }
+
+    void ClearSkipPages() {
+        skip_pages[0] = 0;
+        skip_pages[1] = 0;
+    }
+
+    void ClearReceivedPages() {
+        received_pages[0] = 0;
+        received_pages[1] = 0;
+    }
+
+    bool SkipPage(uint8_t p) {
+        return PageFlag(skip_pages, p);
+    }
+
+    void QueueOutbox(uint8_t msg) {
+        if (outbox.writable()) outbox.Write(msg);
+    }
+
+    void CompareHashes(uint8_t first, const uint8_t *hashes) {
+        for (uint8_t h = 0; h < backup::HASHES_PER_FRAME; h++)
+        {
+            uint8_t p = first + h;
+            if (p >= backup::PAGE_COUNT) break;
+            uint32_t bit = 0x01 << (p & 0x1f);
+            if (backup::get_u32(hashes + h * 4) == backup::page_crc(p)) skip_pages[p >> 5] |= bit;
+            else skip_pages[p >> 5] &= ~bit;
+        }
+    }
+
+    // The CRC covers the page number too, so a page can't be written to the wrong place
+    void ReceivePage(uint8_t p, const uint8_t *frame) {
+        const uint8_t *data = frame + 1;
+        packet = p;
+        if (util::CRC32::Compute(frame, backup::PAGE_SIZE + 1) != backup::get_u32(data + backup::PAGE_SIZE)) {
+            errors++;
+            QueueOutbox(p | OUTBOX_NAK);
+            return;
+        }
+
+        // update() only writes cells whose contents differ
+        uint16_t address = p * backup::PAGE_SIZE;
+        for (uint8_t b = 0; b < backup::PAGE_SIZE; b++) EEPROM.update(address++, data[b]);
+        received_pages[p >> 5] |= 0x01 << (p & 0x1f);
+        acked++;
+        QueueOutbox(p);
+    }
+
+    void CheckRestore() {
+        uint8_t first = 0;
+        if (end_count == backup::PAGE_COUNT - backup::CALIBRATION_PAGES) first = backup::CALIBRATION_PAGES;
+        uint8_t last = first + end_count;
+        if (!end_count || last > backup::PAGE_COUNT) {
+            errors++;
+            return;
+        }
+
+        bool complete = 1;
+        for (uint8_t p = first; p < last; p++)
+        {
+            if (!PageFlag(received_pages, p)) complete = 0;
+        }
+        if (complete) {
+            util::CRC32 crc;
+            for (uint16_t address = first * backup::PAGE_SIZE; address < last * backup::PAGE_SIZE; address++)
+            {
+                crc.Update(EEPROM.read(address));
+            }
+            if (crc.value() == end_crc) {
+                reinit = 1;
+                return;
+            }
+
+            // Every page passed its own check, so it isn't known which one is wrong
+            errors++;
+            for (uint8_t p = first; p < last; p++)
+            {
+                received_pages[p >> 5] &= ~(0x01 << (p & 0x1f));
+            }
+        }
+        nak_page = first;
+        nak_end = last;
+    }
+
+    void ReceiveLegacyPage(const uint8_t *V) {
+        uint8_t p = V[0];
+        packet = p;
+        uint16_t address = p * backup::PAGE_SIZE;
+        for (uint8_t b = 0; b < backup::PAGE_SIZE; b++) EEPROM.update(address++, V[b + 1]);
+
+        // Reset on last packet
+        if (p == (backup::CALIBRATION_PAGES - 1) || p == (backup::PAGE_COUNT - 1)) reinit = 1;
+    }
+
+    void SendCommand(uint8_t cmd, uint8_t p) {
+        uint8_t V[2] = {cmd, p};
+        UnpackedData unpacked;
+        unpacked.set_data(2, V);
+        SendSysEx(unpacked.pack(), 'B');
+    }
+
+    void SendPage(uint8_t p) {
+        uint8_t V[backup::PAGE_SIZE + 6];
+        uint8_t ix = 0;
+        V[ix++] = backup::CMD_PAGE;
+        V[ix++] = p;
+        uint16_t address = p * backup::PAGE_SIZE;
+        for (uint8_t b = 0; b < backup::PAGE_SIZE; b++) V[ix++] = EEPROM.read(address++);
+        backup::put_u32(V + ix, util::CRC32::Compute(V + 1, backup::PAGE_SIZE + 1));
+        ix += 4;
+
+        UnpackedData unpacked;
+        unpacked.set_data(ix, V);
+        SendSysEx(unpacked.pack(), 'B');
+    }
+
+    void SendEnd() {
+        util::CRC32 crc;
+        uint8_t first = calibration ? 0 : backup::CALIBRATION_PAGES;
+        for (uint16_t address = first * backup::PAGE_SIZE; address < end_page * backup::PAGE_SIZE; address++)
+        {
+            crc.Update(EEPROM.read(address));
+        }
+        uint8_t V[6];
+        V[0] = backup::CMD_END;
+        V[1] = pages_sent;
+        backup::put_u32(V + 2, crc.value());
+        UnpackedData unpacked;
+        unpacked.set_data(6, V);
+        SendSysEx(unpacked.pack(), 'B');
+    }
     
     void DrawInterface() {
         graphics.drawLine(0, 10, 127, 10);
@@ -119,16 +424,33 @@ private:
 
                 // Progress bar
                 graphics.drawRect(0, 33, (packet + 4) * 2, 8);
+                if (errors) {
+                    graphics.setPrintPos(0, 45);
+                    graphics.print("CRC errors: ");
+                    graphics.print(errors);
+                }
             }
             else graphics.print("Listening...");
+        } else if (sending) {
+            graphics.print("Sending...");
+            graphics.drawRect(0, 33, (packet + 4) * 2, 8);
         } else {
-            if (packet > 0) graphics.print("Done!");
+            if (packet > 0) {
+                graphics.print("Done! ");
+                graphics.print(pages_sent);
+                graphics.print(" pages");
+                if (resent) {
+                    graphics.print(", ");
+                    graphics.print(resent);
+                    graphics.print(" resent");
+                }
+            }
             else graphics.print("Restore or Backup?");
         }
         
         graphics.setPrintPos(0, 55);
         if (receiving) graphics.print("[CANCEL]");
-        else {
+        else if (!sending) {
             graphics.print("[RESTORE]");
             graphics.setPrintPos(78, 55);
             graphics.print("[BACKUP]");
@@ -152,9 +474,13 @@ size_t Backup_save(void *storage) {return 0;}
 size_t Backup_restore(const void *storage) {return 0;}
 
 void Backup_handleAppEvent(OC::AppEvent event) {
-    if (event == OC::APP_EVENT_RESUME) Backup_instance.Resume();
+    if (event == OC::APP_EVENT_RESUME) {
+        // Dumps and restores must see the EEPROM as it will stay
+        OC::apps::FlushSettings();
+        Backup_instance.Resume();
+    }
 }
-void Backup_loop() {} // Deprecated
+void Backup_loop() {Backup_instance.Loop();}
 void Backup_screensaver() {Backup_instance.View();}
 void Backup_handleEncoderEvent(const UI::Event &event) {
     Backup_instance.ToggleCalibration();
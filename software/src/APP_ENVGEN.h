@@ -32,6 +32,7 @@
 #include "OC_ADC.h"
 #include "util/util_math.h"
 #include "util/util_settings.h"
+#include "util/util_trigger_delay.h"
 #include "peaks_multistage_envelope.h"
 #include "bjorklund.h"
 #include "OC_euclidean_mask_draw.h"
@@ -149,10 +150,6 @@ public:
     uint32_t delay;
     uint32_t time_left;
 
-    inline void Activate(uint32_t t) {
-      delay = time_left = t;
-    }
-
     inline void Reset() {
       delay = time_left = 0;
     }
@@ -545,15 +542,13 @@ public:
       uint32_t delay = static_cast<uint32_t>(s[CV_MAPPING_DELAY_MSEC] * 1000U);
       if (delay_mode && delay) {
         triggered = false;
-        if (TRIGGER_DELAY_QUEUE == delay_mode) {
-          if (delayed_triggers_free_ < get_trigger_delay_count())
-            delayed_triggers_[delayed_triggers_free_].Activate(delay);
-        } else { // TRIGGER_DELAY_RING
+        // Due on the tick where the remaining time drops to <= one tick
+        const uint32_t delay_ticks = (delay + OC_CORE_TIMER_RATE - 1) / OC_CORE_TIMER_RATE;
+        if (delayed_triggers_.size() < get_trigger_delay_count()) {
+          delayed_triggers_.Push(delay_ticks, delay);
+        } else if (TRIGGER_DELAY_RING == delay_mode) {
           // Assume these are mostly in order, so the "next" is also the oldest
-          if (delayed_triggers_free_ < get_trigger_delay_count())
-            delayed_triggers_[delayed_triggers_free_].Activate(delay);
-          else
-            delayed_triggers_[delayed_triggers_next_].Activate(delay);
+          delayed_triggers_.ReplaceNext(delay_ticks, delay);
         }
       }
     }
@@ -585,8 +580,20 @@ public:
     return env_.RenderPreview(values, segment_start_points, loop_points, current_phase);
   }
 
-  uint16_t RenderFastPreview(int16_t *values) const {
-    return env_.RenderFastPreview(values);
+  uint16_t RenderFastPreview(int16_t *values, bool full = false) const {
+    return env_.RenderFastPreview(values, full);
+  }
+
+  void GetPreviewShape(peaks::PreviewShape &shape) const {
+    env_.GetPreviewShape(shape);
+  }
+
+  uint16_t PreviewPhase() const {
+    return env_.PreviewPhase();
+  }
+
+  uint16_t FastPreviewLength() const {
+    return env_.FastPreviewLength();
   }
 
   uint8_t getTriggerState() const {
@@ -594,7 +601,13 @@ public:
   }
 
   inline void get_next_trigger(DelayedTrigger &trigger) const {
-    trigger = delayed_triggers_[delayed_triggers_next_];
+    if (delayed_triggers_.empty()) {
+      trigger.Reset();
+    } else {
+      const DelayedTriggerQueue::Event &next = delayed_triggers_.next();
+      trigger.delay = next.value;
+      trigger.time_left = delayed_triggers_.ticks_left(next) * OC_CORE_TIMER_RATE;
+    }
   }
 
 #ifdef ENVGEN_DEBUG
@@ -634,9 +647,9 @@ private:
   uint8_t s_euclidean_fill_;
   uint8_t s_euclidean_offset_;  
   
-  DelayedTrigger delayed_triggers_[kMaxDelayedTriggers];
-  size_t delayed_triggers_free_;
-  size_t delayed_triggers_next_;
+  // Pending delayed triggers, the value is the delay (for display)
+  typedef util::DelayQueue<uint32_t, kMaxDelayedTriggers> DelayedTriggerQueue;
+  DelayedTriggerQueue delayed_triggers_;
 
   int num_enabled_settings_;
   EnvelopeSettings enabled_settings_[ENV_SETTING_LAST];
@@ -646,31 +659,10 @@ private:
   bool DelayedTriggers() {
     bool triggered = false;
 
-    delayed_triggers_free_ = kMaxDelayedTriggers;
-    delayed_triggers_next_ = 0;
-    uint32_t min_time_left = -1;
-
-    size_t i = kMaxDelayedTriggers;
-    while (i--) {
-      DelayedTrigger &trigger = delayed_triggers_[i];
-      uint32_t time_left = trigger.time_left;
-      if (time_left) {
-        if (time_left > OC_CORE_TIMER_RATE) {
-          time_left -= OC_CORE_TIMER_RATE;
-          if (time_left < min_time_left) {
-            min_time_left = time_left;
-            delayed_triggers_next_ = i;
-          }
-          trigger.time_left = time_left;
-        } else {
-          trigger.Reset();
-          delayed_triggers_free_ = i;
-          triggered = true;
-        }
-      } else {
-        delayed_triggers_free_ = i;
-      }
-    }
+    delayed_triggers_.Tick();
+    uint32_t delay;
+    while (delayed_triggers_.Pop(delay))
+      triggered = true;
 
     return triggered;
   }
@@ -686,8 +678,7 @@ void EnvelopeGenerator::Init(OC::DigitalInput default_trigger) {
   euclidean_counter_ = 0;
   euclidean_reset_counter_ = 0;
   
-  memset(delayed_triggers_, 0, sizeof(delayed_triggers_));
-  delayed_triggers_free_ = delayed_triggers_next_ = 0;
+  delayed_triggers_.Init();
 
   trigger_display_.Init();
 
@@ -895,6 +886,26 @@ uint16_t preview_segment_starts[peaks::kMaxNumSegments];
 uint16_t preview_loop_points[peaks::kMaxNumSegments];
 static constexpr uint16_t kPreviewTerminator = 0xffff;
 
+// The previews are only re-rendered when the envelope shape changes; the
+// envelope parameters are set from the ISR each tick, so just compare them.
+struct PreviewCache {
+  peaks::PreviewShape shape;
+  const EnvelopeGenerator *env;
+  uint16_t width;
+
+  bool Update(const EnvelopeGenerator &e) {
+    peaks::PreviewShape current;
+    e.GetPreviewShape(current);
+    if (env == &e && current == shape)
+      return false;
+    env = &e;
+    shape = current;
+    return true;
+  }
+};
+
+PreviewCache preview_cache;
+
 settings::value_attr segment_editing_attr = { 128, 0, 255, "DOH!", NULL, settings::STORAGE_TYPE_U16 };
 
 void ENVGEN_menu_preview() {
@@ -911,8 +922,13 @@ void ENVGEN_menu_preview() {
 
   // Current envelope shape
   uint16_t current_phase = 0;
+  if (preview_cache.Update(env))
+    preview_cache.width = env.RenderPreview(preview_values, preview_segment_starts, preview_loop_points, current_phase);
+  else
+    current_phase = env.PreviewPhase();
+
   weegfx::coord_t x = 0;
-  weegfx::coord_t w = env.RenderPreview(preview_values, preview_segment_starts, preview_loop_points, current_phase);
+  weegfx::coord_t w = preview_cache.width;
   const int16_t *data = preview_values;
   while (x <= static_cast<weegfx::coord_t>(current_phase)) {
     const int16_t value = *data++ >> 10;
@@ -1197,14 +1213,19 @@ void ENVGEN_handleEncoderEvent(const UI::Event &event) {
   }
 }
 
-int16_t fast_preview_values[peaks::kFastPreviewWidth + 32];
+int16_t fast_preview_values[4][peaks::kFastPreviewWidth];
+PreviewCache fast_preview_cache[4];
 
 template <int index, weegfx::coord_t startx, weegfx::coord_t y>
 void RenderFastPreview() {
-  uint16_t w = envgen.envelopes_[index].RenderFastPreview(fast_preview_values);
+  const EnvelopeGenerator &env = envgen.envelopes_[index];
+  if (fast_preview_cache[index].Update(env))
+    env.RenderFastPreview(fast_preview_values[index], true);
+
+  uint16_t w = env.FastPreviewLength();
   CONSTRAIN(w, 0, peaks::kFastPreviewWidth); // Just-in-case
   weegfx::coord_t x = startx;
-  const int16_t *values = fast_preview_values;
+  const int16_t *values = fast_preview_values[index];
   while (w--) {
     const int16_t value = 1 + ((*values++ >> 10) & 0x1f);
     graphics.drawVLine(x++, y + 32 - value, value);
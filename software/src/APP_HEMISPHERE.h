@@ -21,10 +21,12 @@
 #ifndef _HEM_APP_HEMISPHERE_H_
 #define _HEM_APP_HEMISPHERE_H_
 
+#include <new>
 #include "OC_DAC.h"
 #include "OC_digital_inputs.h"
 #include "OC_visualfx.h"
 #include "OC_apps.h"
+#include "OC_deferred.h"
 #include "OC_ui.h"
 
 #include "HEM_ClockSetup.h"
@@ -37,14 +39,76 @@
 #include "HSMIDI.h"
 #include "HSClockManager.h"
 
+#define HEMISPHERE_DOUBLE_CLICK_TIME 8000
+
+////////////////////////////////////////////////////////////////////////////////
+//// Applet Arena
+////////////////////////////////////////////////////////////////////////////////
+namespace HS {
+
+constexpr size_t max_of(const size_t *values, size_t count, size_t m = 0) {
+    return count == 0 ? m : max_of(values + 1, count - 1, values[0] > m ? values[0] : m);
+}
+
+#define DECLARE_APPLET(id, categories, class_name) sizeof(class_name)
+constexpr size_t applet_sizes[] = HEMISPHERE_APPLETS;
+#undef DECLARE_APPLET
+#define DECLARE_APPLET(id, categories, class_name) alignof(class_name)
+constexpr size_t applet_alignments[] = HEMISPHERE_APPLETS;
+#undef DECLARE_APPLET
+
+const size_t kAppletArenaSize = max_of(applet_sizes, sizeof(applet_sizes) / sizeof(size_t));
+const size_t kAppletArenaAlign = max_of(applet_alignments, sizeof(applet_alignments) / sizeof(size_t));
+
+struct AppletArena {
+    alignas(kAppletArenaAlign) uint8_t storage[kAppletArenaSize];
+};
+
+AppletArena applet_arena[2];
+
+inline void *AppletStorage(bool hemisphere) {
+    return applet_arena[hemisphere].storage;
+}
+
+/* Value-initialized, so the applet starts out zeroed just like the static instances
+ * used to. Applets don't own anything, so the outgoing one is simply overwritten.
+ */
+template <class T>
+void ConstructApplet(bool hemisphere) {
+    static_assert(sizeof(T) <= kAppletArenaSize, "Applet doesn't fit in the applet arena");
+    new (AppletStorage(hemisphere)) T();
+}
+
+// Same order as HEMISPHERE_APPLETS, so it's indexed like available_applets
+#define DECLARE_APPLET(id, categories, class_name) ConstructApplet<class_name>
+void (* const applet_constructors[HEMISPHERE_AVAILABLE_APPLETS])(bool) = HEMISPHERE_APPLETS;
+#undef DECLARE_APPLET
+
+#ifdef HEMISPHERE_APPLET_FOOTPRINT
+/* Build with -DHEMISPHERE_APPLET_FOOTPRINT for a footprint report. Each applet shows up as
+ * a warning like "applet_footprint() [with T = Euclid; unsigned int bytes = 312]",
+ * followed by the arena itself, which is what both hemispheres actually cost.
+ */
+template <class T, size_t bytes>
+__attribute__((deprecated("applet footprint"))) inline int applet_footprint() { return bytes; }
+
+#define DECLARE_APPLET(id, categories, class_name) applet_footprint<class_name, sizeof(class_name)>()
+inline void ReportAppletFootprints() {
+    const int footprints[] = HEMISPHERE_APPLETS;
+    (void)footprints;
+    applet_footprint<AppletArena, sizeof(applet_arena)>();
+}
+#undef DECLARE_APPLET
+#endif
+
+}; // namespace HS
+
 #define DECLARE_APPLET(id, categories, class_name) \
 { id, categories, class_name ## _Start, class_name ## _Controller, class_name ## _View, \
   class_name ## _OnButtonPress, class_name ## _OnEncoderMove, class_name ## _ToggleHelpScreen, \
   class_name ## _OnDataRequest, class_name ## _OnDataReceive \
 }
 
-#define HEMISPHERE_DOUBLE_CLICK_TIME 8000
-
 typedef struct Applet {
   int id;
   uint8_t categories;
@@ -77,8 +141,10 @@ class HemisphereManager : public SystemExclusiveHandler,
     public settings::SettingsBase<HemisphereManager, HEMISPHERE_SETTING_LAST> {
 public:
     void Init() {
+        my_applet[0] = my_applet[1] = -1; // Nothing resident yet
         select_mode = -1; // Not selecting
         midi_in_hemisphere = -1; // No MIDI In
+        sysex_resume_pending = 0;
         Applet applets[] = HEMISPHERE_APPLETS;
         memcpy(&available_applets, &applets, sizeof(applets));
         ClockSetup = DECLARE_APPLET(9999, 0x01, ClockSetup);
@@ -101,10 +167,20 @@ public:
     }
 
     void SetApplet(int hemisphere, int index) {
-        my_applet[hemisphere] = index;
+        // The ISR mustn't run a half-built or half-started applet, and the
+        // outgoing applet's queued jobs mustn't run on the new one. This is
+        // only called from loop(), so none of its jobs can be running.
+        uint32_t primask;
+        asm volatile("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+        if (index != my_applet[hemisphere]) {
+            OC::Deferred::Cancel(HS::AppletStorage(hemisphere), HS::kAppletArenaSize);
+            HS::applet_constructors[index](hemisphere);
+            my_applet[hemisphere] = index;
+        }
         if (midi_in_hemisphere == hemisphere) midi_in_hemisphere = -1;
         if (available_applets[index].id & 0x80) midi_in_hemisphere = hemisphere;
         available_applets[index].Start(hemisphere);
+        asm volatile("msr primask, %0" :: "r" (primask) : "memory");
         apply_value(hemisphere, available_applets[index].id);
     }
 
@@ -130,11 +206,14 @@ public:
             }
         }
 
+        cv_m->Update();
+
         if (clock_setup) ClockSetup.Controller(LEFT_HEMISPHERE, clock_m->IsForwarded());
 
         for (int h = 0; h < 2; h++)
         {
             int index = my_applet[h];
+            OC_TRACE_SCOPE(TRACE_APPLET_ISR, (h << 8) | available_applets[index].id);
             available_applets[index].Controller(h, clock_m->IsForwarded());
         }
     }
@@ -208,7 +287,7 @@ public:
     void DelegateEncoderMovement(const UI::Event &event) {
         int h = (event.control == OC::CONTROL_ENCODER_L) ? LEFT_HEMISPHERE : RIGHT_HEMISPHERE;
         if (clock_setup) {
-            ClockSetup.OnEncoderMove(LEFT_HEMISPHERE, event.value);
+            ClockSetup.OnEncoderMove(LEFT_HEMISPHERE, event.accelerated);
         } else if (select_mode == h) {
             ChangeApplet(event.value);
         } else {
@@ -296,6 +375,16 @@ public:
             values_[HEMISPHERE_RIGHT_DATA_L] = ((uint16_t)V[5] << 8) + V[4];
             values_[HEMISPHERE_LEFT_DATA_H] = ((uint16_t)V[7] << 8) + V[6];
             values_[HEMISPHERE_RIGHT_DATA_H] = ((uint16_t)V[9] << 8) + V[8];
+
+            // This runs in the ISR. The applets are swapped from loop(), where
+            // they can't be in the middle of a deferred job.
+            sysex_resume_pending = 1;
+        }
+    }
+
+    void Loop() {
+        if (sysex_resume_pending) {
+            sysex_resume_pending = 0;
             Resume();
         }
     }
@@ -308,9 +397,11 @@ private:
     bool clock_setup;
     int help_hemisphere; // Which of the hemispheres (if any) is in help mode, or -1 if none
     int midi_in_hemisphere; // Which of the hemispheres (if any) is using MIDI In
+    volatile bool sysex_resume_pending; // Settings received by SysEx, to be applied by Loop()
     uint32_t click_tick; // Measure time between clicks for double-click
     int first_click; // The first button pushed of a double-click set, to see if the same one is pressed
     ClockManager *clock_m = clock_m->get();
+    CVInputManager *cv_m = cv_m->get();
 
     void DrawClockSetup() {
 
@@ -391,7 +482,9 @@ void HEMISPHERE_handleAppEvent(OC::AppEvent event) {
     }
 }
 
-void HEMISPHERE_loop() {} // Essentially deprecated in favor of ISR
+void HEMISPHERE_loop() {
+    manager.Loop();
+}
 
 void HEMISPHERE_menu() {
     manager.DrawViews();
@@ -32,6 +32,7 @@
 #include "HSMIDI.h"
 #include <stdint.h>
 #include "neuralnet/LogicGate.h"
+#include "neuralnet/LogicNetwork.h"
 
 // 9 sets of 24 bytes allocated for storage
 #define NN_SETTING_LAST 216
@@ -60,12 +61,12 @@ public:
         }
         
         // Process neurons
-        for (byte n = 0; n < 6; n++)
-        {
-            byte ix = (setup * 6) + n;
-            bool set = neuron[ix].Calculate(tmp_source_state);
-            tmp_source_state = SetSource(tmp_source_state, 8 + n, set);
+        if (network_dirty || network_setup != setup) {
+            network_dirty = 0;
+            network_setup = setup;
+            network.Compile(&neuron[setup * 6], 6);
         }
+        tmp_source_state = network.Evaluate(tmp_source_state);
         
         // Set outputs based on assigned neuron's last state
         for (byte o = 0; o < 4; o++)
@@ -151,6 +152,7 @@ public:
             b = V[ix++]; // Output 3 and 4
             output_neuron[o + 2] = (b >> 4) & 0x0f;
             output_neuron[o + 3] = b & 0x0f;
+            network_dirty = 1;
         }
 
     }
@@ -167,6 +169,7 @@ public:
                 output_neuron[(target * 4) + 0] = output_neuron[(source * 4) + o];
 
             setup = target;
+            network_dirty = 1;
         }
         copy_mode = 0;
     }
@@ -230,6 +233,7 @@ public:
         if (selected < 6) {
             byte ix = (setup * 6) + selected;
             neuron[ix].UpdateValue(cursor, direction);
+            network_dirty = 1;
         } else {
             byte ix = (setup * 4) + cursor;
             output_neuron[ix] = constrain(output_neuron[ix] + direction, 0, 5);
@@ -247,6 +251,9 @@ private:
     int copy_setup_target; // Which setup is being copied TO?
     
     LogicGate neuron[24]; // Four sets of six neurons
+    LogicNetwork network; // Compiled form of the current setup's neurons
+    volatile bool network_dirty = 1; // Recompile the network on the next tick
+    int network_setup = 0; // Setup that the network was compiled from
     int output_neuron[16]; // Four sets of four output assignments
     bool input_state[8];
     
@@ -433,7 +440,7 @@ private:
             if (neuron[n].threshold == -128) neuron[n].threshold = 0;
         }
         for (byte o = 0; o < 16; o++) output_neuron[o] = values_[ix++];
-            
+        network_dirty = 1;
     }
     
     void SaveToEEPROMStage() {
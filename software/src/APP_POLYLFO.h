@@ -171,6 +171,17 @@ public:
   bool frozen_;
   uint8_t freq_mult_;
 
+  // The LFO is rendered in blocks of kBlockSize frames, and the DAC is fed one
+  // frame per ISR from the block. Settings and CV mapping are only evaluated
+  // once per block. Clocks are latched until the next block is rendered, so
+  // they're at most kBlockSize ISRs (240us) late.
+  static constexpr uint8_t kBlockSize = 4;
+
+  uint16_t block_[kBlockSize][frames::kNumChannels];
+  uint8_t block_pos_;
+  bool reset_pending_;
+  bool tempo_sync_pending_;
+
   // ISR update is at 16.666kHz, we don't need it that fast so smooth the values to ~1Khz
   static constexpr int32_t kSmoothing = 16;
 
@@ -185,6 +196,10 @@ void PolyLfo::Init() {
   lfo.Init();
   frozen_= false;
   freq_mult_ = 0x3; // == x2 / default
+  memset(block_, 0, sizeof(block_));
+  block_pos_ = kBlockSize;
+  reset_pending_ = false;
+  tempo_sync_pending_ = false;
 }
 
 const char* const freq_range_names[12] = {
@@ -241,16 +256,8 @@ struct {
 
 } poly_lfo_state;
 
-void FASTRUN POLYLFO_isr() {
-
-  bool reset_phase = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
+void FASTRUN POLYLFO_renderBlock() {
   bool freeze = OC::DigitalInputs::read_immediate<OC::DIGITAL_INPUT_2>();
-  bool tempo_sync = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_3>();
- 
-  poly_lfo.cv_freq.push(OC::ADC::value<ADC_CHANNEL_1>());
-  poly_lfo.cv_shape.push(OC::ADC::value<ADC_CHANNEL_2>());
-  poly_lfo.cv_spread.push(OC::ADC::value<ADC_CHANNEL_3>());
-  poly_lfo.cv_mappable.push(OC::ADC::value<ADC_CHANNEL_4>());
 
   // Range in settings is (0-256] so this gets scaled to (0,65535]
   // CV value is 12 bit so also needs scaling
@@ -337,13 +344,40 @@ void FASTRUN POLYLFO_isr() {
   int8_t freq_mult = digitalReadFast(TR4) ? 0xFF : poly_lfo.tr4_multiplier();
   poly_lfo.set_freq_mult(freq_mult);
 
-  if (!freeze && !poly_lfo.frozen())
-    poly_lfo.lfo.Render(freq, reset_phase, tempo_sync, freq_mult);
+  if (!freeze && !poly_lfo.frozen()) {
+    poly_lfo.lfo.RenderBlock(freq, poly_lfo.reset_pending_, poly_lfo.tempo_sync_pending_, freq_mult,
+                             &poly_lfo.block_[0][0], PolyLfo::kBlockSize);
+  } else {
+    // Hold the last rendered values
+    for (uint8_t f = 0; f < PolyLfo::kBlockSize; ++f) {
+      for (uint8_t i = 0; i < frames::kNumChannels; ++i)
+        poly_lfo.block_[f][i] = poly_lfo.lfo.dac_code(i);
+    }
+  }
+  poly_lfo.reset_pending_ = false;
+  poly_lfo.tempo_sync_pending_ = false;
+}
+
+void FASTRUN POLYLFO_isr() {
+
+  poly_lfo.reset_pending_ |= OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
+  poly_lfo.tempo_sync_pending_ |= OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_3>();
+ 
+  poly_lfo.cv_freq.push(OC::ADC::value<ADC_CHANNEL_1>());
+  poly_lfo.cv_shape.push(OC::ADC::value<ADC_CHANNEL_2>());
+  poly_lfo.cv_spread.push(OC::ADC::value<ADC_CHANNEL_3>());
+  poly_lfo.cv_mappable.push(OC::ADC::value<ADC_CHANNEL_4>());
+
+  if (poly_lfo.block_pos_ >= PolyLfo::kBlockSize) {
+    POLYLFO_renderBlock();
+    poly_lfo.block_pos_ = 0;
+  }
 
-  OC::DAC::set<DAC_CHANNEL_A>(poly_lfo.lfo.dac_code(0));
-  OC::DAC::set<DAC_CHANNEL_B>(poly_lfo.lfo.dac_code(1));
-  OC::DAC::set<DAC_CHANNEL_C>(poly_lfo.lfo.dac_code(2));
-  OC::DAC::set<DAC_CHANNEL_D>(poly_lfo.lfo.dac_code(3));
+  const uint16_t *frame = poly_lfo.block_[poly_lfo.block_pos_++];
+  OC::DAC::set<DAC_CHANNEL_A>(frame[0]);
+  OC::DAC::set<DAC_CHANNEL_B>(frame[1]);
+  OC::DAC::set<DAC_CHANNEL_C>(frame[2]);
+  OC::DAC::set<DAC_CHANNEL_D>(frame[3]);
 }
 
 void POLYLFO_init() {
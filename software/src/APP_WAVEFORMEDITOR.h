@@ -131,6 +131,7 @@ public:
                 HS::user_waveforms[seg_ix].level = V[ix++];
                 HS::user_waveforms[seg_ix].time = V[ix++];
             }
+            WaveformManager::Rebuild();
 
             waveform_number = 0;
             Resume();
@@ -277,7 +277,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-ADSREG ADSREG_instance[2];
+HS::AppletInstance<ADSREG> ADSREG_instance;
 
 void ADSREG_Start(bool hemisphere) {
     ADSREG_instance[hemisphere].BaseStart(hemisphere);
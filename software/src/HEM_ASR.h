@@ -154,7 +154,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-ASR_Hemi ASR_instance[2];
+HS::AppletInstance<ASR_Hemi> ASR_instance;
 
 void ASR_Hemi_Start(bool hemisphere) {ASR_instance[hemisphere].BaseStart(hemisphere);}
 void ASR_Hemi_Controller(bool hemisphere, bool forwarding) {ASR_instance[hemisphere].BaseController(forwarding);}
@@ -257,7 +257,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-AnnularFusion AnnularFusion_instance[2];
+HS::AppletInstance<AnnularFusion> AnnularFusion_instance;
 
 void AnnularFusion_Start(bool hemisphere) {
     AnnularFusion_instance[hemisphere].BaseStart(hemisphere);
@@ -112,7 +112,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Binary Binary_instance[2];
+HS::AppletInstance<Binary> Binary_instance;
 
 void Binary_Start(bool hemisphere) {
     Binary_instance[hemisphere].BaseStart(hemisphere);
@@ -112,7 +112,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Brancher Brancher_instance[2];
+HS::AppletInstance<Brancher> Brancher_instance;
 
 void Brancher_Start(bool hemisphere) {
     Brancher_instance[hemisphere].BaseStart(hemisphere);
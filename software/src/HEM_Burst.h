@@ -209,7 +209,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Burst Burst_instance[2];
+HS::AppletInstance<Burst> Burst_instance;
 
 void Burst_Start(bool hemisphere) {
     Burst_instance[hemisphere].BaseStart(hemisphere);
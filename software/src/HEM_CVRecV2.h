@@ -203,7 +203,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-CVRecV2 CVRecV2_instance[2];
+HS::AppletInstance<CVRecV2> CVRecV2_instance;
 
 void CVRecV2_Start(bool hemisphere) {CVRecV2_instance[hemisphere].BaseStart(hemisphere);}
 void CVRecV2_Controller(bool hemisphere, bool forwarding) {CVRecV2_instance[hemisphere].BaseController(forwarding);}
@@ -147,7 +147,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Calculate Calculate_instance[2];
+HS::AppletInstance<Calculate> Calculate_instance;
 
 void Calculate_Start(bool hemisphere) {
     Calculate_instance[hemisphere].BaseStart(hemisphere);
@@ -208,7 +208,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Carpeggio Carpeggio_instance[2];
+HS::AppletInstance<Carpeggio> Carpeggio_instance;
 
 void Carpeggio_Start(bool hemisphere) {
     Carpeggio_instance[hemisphere].BaseStart(hemisphere);
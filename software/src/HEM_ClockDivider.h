@@ -169,7 +169,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-ClockDivider ClockDivider_instance[2];
+HS::AppletInstance<ClockDivider> ClockDivider_instance;
 
 void ClockDivider_Start(bool hemisphere) {
     ClockDivider_instance[hemisphere].BaseStart(hemisphere);
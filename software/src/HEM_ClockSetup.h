@@ -53,14 +53,13 @@ public:
         }
 
         if (cursor == 1) { // Set tempo
-            uint16_t bpm = clock_m->GetTempo();
-            bpm += direction;
-            clock_m->SetTempoBPM(bpm);
+            int bpm = clock_m->GetTempo() + direction;
+            clock_m->SetTempoBPM(constrain(bpm, CLOCK_TEMPO_MIN, CLOCK_TEMPO_MAX));
         }
 
         if (cursor == 2) { // Set multiplier
             int8_t mult = clock_m->GetMultiply();
-            mult += direction;
+            mult += direction > 0 ? 1 : -1;
             clock_m->SetMultiply(mult);
         }
     }
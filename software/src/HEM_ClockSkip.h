@@ -121,7 +121,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-ClockSkip ClockSkip_instance[2];
+HS::AppletInstance<ClockSkip> ClockSkip_instance;
 
 void ClockSkip_Start(bool hemisphere) {
     ClockSkip_instance[hemisphere].BaseStart(hemisphere);
@@ -113,7 +113,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Compare Compare_instance[2];
+HS::AppletInstance<Compare> Compare_instance;
 
 void Compare_Start(bool hemisphere) {
     Compare_instance[hemisphere].BaseStart(hemisphere);
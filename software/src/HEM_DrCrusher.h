@@ -143,7 +143,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-DrCrusher DrCrusher_instance[2];
+HS::AppletInstance<DrCrusher> DrCrusher_instance;
 
 void DrCrusher_Start(bool hemisphere) {DrCrusher_instance[hemisphere].BaseStart(hemisphere);}
 void DrCrusher_Controller(bool hemisphere, bool forwarding) {DrCrusher_instance[hemisphere].BaseController(forwarding);}
@@ -341,7 +341,7 @@ private:
     }
 };
 
-DrumMap DrumMap_instance[2];
+HS::AppletInstance<DrumMap> DrumMap_instance;
 
 void DrumMap_Start(bool hemisphere) {DrumMap_instance[hemisphere].BaseStart(hemisphere);}
 void DrumMap_Controller(bool hemisphere, bool forwarding) {DrumMap_instance[hemisphere].BaseController(forwarding);}
@@ -170,7 +170,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-DualQuant DualQuant_instance[2];
+HS::AppletInstance<DualQuant> DualQuant_instance;
 
 void DualQuant_Start(bool hemisphere) {
     DualQuant_instance[hemisphere].BaseStart(hemisphere);
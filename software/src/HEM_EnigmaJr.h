@@ -212,7 +212,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-EnigmaJr EnigmaJr_instance[2];
+HS::AppletInstance<EnigmaJr> EnigmaJr_instance;
 
 void EnigmaJr_Start(bool hemisphere) {EnigmaJr_instance[hemisphere].BaseStart(hemisphere);}
 void EnigmaJr_Controller(bool hemisphere, bool forwarding) {EnigmaJr_instance[hemisphere].BaseController(forwarding);}
@@ -42,6 +42,7 @@ public:
             pattern[ch] = EuclideanPattern(length[ch] - 1, beats[ch], 0);;
         }
         step = 0;
+        WakeOn(WAKE_CLOCK_1 | WAKE_CLOCK_2); // Nothing happens between clocks
     }
 
     void Controller() {
@@ -246,7 +247,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Euclid Euclid_instance[2];
+HS::AppletInstance<Euclid> Euclid_instance;
 
 void Euclid_Start(bool hemisphere) {
     Euclid_instance[hemisphere].BaseStart(hemisphere);
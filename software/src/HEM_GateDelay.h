@@ -151,7 +151,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-GateDelay GateDelay_instance[2];
+HS::AppletInstance<GateDelay> GateDelay_instance;
 
 void GateDelay_Start(bool hemisphere) {
     GateDelay_instance[hemisphere].BaseStart(hemisphere);
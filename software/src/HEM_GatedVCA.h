@@ -97,7 +97,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-GatedVCA GatedVCA_instance[2];
+HS::AppletInstance<GatedVCA> GatedVCA_instance;
 
 void GatedVCA_Start(bool hemisphere) {
     GatedVCA_instance[hemisphere].BaseStart(hemisphere);
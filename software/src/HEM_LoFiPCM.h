@@ -178,7 +178,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-LoFiPCM LoFiPCM_instance[2];
+HS::AppletInstance<LoFiPCM> LoFiPCM_instance;
 
 void LoFiPCM_Start(bool hemisphere) {
     LoFiPCM_instance[hemisphere].BaseStart(hemisphere);
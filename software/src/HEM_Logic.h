@@ -155,7 +155,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Logic Logic_instance[2];
+HS::AppletInstance<Logic> Logic_instance;
 
 void Logic_Start(bool hemisphere) {
     Logic_instance[hemisphere].BaseStart(hemisphere);
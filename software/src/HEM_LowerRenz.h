@@ -139,7 +139,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-LowerRenz LowerRenz_instance[2];
+HS::AppletInstance<LowerRenz> LowerRenz_instance;
 
 void LowerRenz_Start(bool hemisphere) {
     LowerRenz_instance[hemisphere].BaseStart(hemisphere);
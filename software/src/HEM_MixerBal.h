@@ -102,7 +102,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-MixerBal MixerBal_instance[2];
+HS::AppletInstance<MixerBal> MixerBal_instance;
 
 void MixerBal_Start(bool hemisphere) {
     MixerBal_instance[hemisphere].BaseStart(hemisphere);
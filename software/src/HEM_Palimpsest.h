@@ -179,7 +179,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Palimpsest Palimpsest_instance[2];
+HS::AppletInstance<Palimpsest> Palimpsest_instance;
 
 void Palimpsest_Start(bool hemisphere) {
     Palimpsest_instance[hemisphere].BaseStart(hemisphere);
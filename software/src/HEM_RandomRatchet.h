@@ -75,9 +75,17 @@ public:
         cursor = 0;
         last_number_cv_tick = 0;
         edit_param = -1;
+        last_controller_tick = OC::CORE::ticks;
+        WakeOn(WAKE_CLOCK_1 | WAKE_CLOCK_2 | WAKE_CV_1 | WAKE_CV_2 | WAKE_TIMER);
     }
 
     void Controller() {
+        // The applet sleeps between clocks, CV changes and burst triggers, so timing is based
+        // on the ticks since the previous call rather than on the number of calls
+        int elapsed = OC::CORE::ticks - last_controller_tick;
+        last_controller_tick = OC::CORE::ticks;
+        ticks_since_clock += elapsed - 1;
+
         last_number_cv_tick = OC::CORE::ticks;
         processCV();
 
@@ -98,8 +106,8 @@ public:
         getEffectiveSpacing(&ch2);
 
         // Handle a burst set in progress
-        handleBurst(&ch1, 0);
-        handleBurst(&ch2, 1);
+        handleBurst(&ch1, 0, elapsed);
+        handleBurst(&ch2, 1, elapsed);
 
         // Handle the triggering of a new burst set.
         //
@@ -122,6 +130,14 @@ public:
                 }   
             }
         }
+
+        // Sleep until the next trigger of a burst set in progress
+        int next = -1;
+        for (int i = 0; i < 2; i++) {
+            channel *ch = channels[i];
+            if (ch->bursts_to_go > 0 && (next < 0 || ch->burst_countdown < next)) next = ch->burst_countdown;
+        }
+        if (next >= 0) WakeIn(next > 0 ? next : 1);
     }
 
     void View() {
@@ -238,6 +254,7 @@ private:
     int cursor;                 // Cursor position
     int edit_param;             // Current parameter selected for editing
     int ticks_since_clock;      // Time since the last clock.
+    uint32_t last_controller_tick; // For the time between Controller() calls
     int last_number_cv_tick;    // The last time the number was changed via CV. This is used to
                                 // decide whether the ADC delay should be used when clocks come in.                       
     typedef struct {
@@ -391,9 +408,9 @@ private:
         }
     }
 
-    void handleBurst(channel *ch, int clockOut) {
+    void handleBurst(channel *ch, int clockOut, int elapsed) {
         if (ch->bursts_to_go > 0) {
-            if (--(ch->burst_countdown) <= 0) {
+            if ((ch->burst_countdown -= elapsed) <= 0) {
                 if (ch->effective_spacing < HEM_RR_SPACING_MIN) ch->effective_spacing = HEM_RR_SPACING_MIN;
                 ClockOut(clockOut);
                 if (--(ch->bursts_to_go) > 0) ch->burst_countdown = ch->effective_spacing * 17; // Reset for next burst
@@ -461,7 +478,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-RandomRatchet RandomRatchet_Instance[2];
+HS::AppletInstance<RandomRatchet> RandomRatchet_Instance;
 
 void RandomRatchet_Start(bool hemisphere) {
     RandomRatchet_Instance[hemisphere].BaseStart(hemisphere);
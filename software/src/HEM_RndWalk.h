@@ -292,7 +292,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-RndWalk RndWalk_instance[2];
+HS::AppletInstance<RndWalk> RndWalk_instance;
 
 void RndWalk_Start(bool hemisphere) {
     RndWalk_instance[hemisphere].BaseStart(hemisphere);
@@ -162,7 +162,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-ScaleDuet ScaleDuet_instance[2];
+HS::AppletInstance<ScaleDuet> ScaleDuet_instance;
 
 void ScaleDuet_Start(bool hemisphere) {
     ScaleDuet_instance[hemisphere].BaseStart(hemisphere);
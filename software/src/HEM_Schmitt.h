@@ -163,7 +163,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Schmitt Schmitt_instance[2];
+HS::AppletInstance<Schmitt> Schmitt_instance;
 
 void Schmitt_Start(bool hemisphere) {
     Schmitt_instance[hemisphere].BaseStart(hemisphere);
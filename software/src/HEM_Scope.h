@@ -21,8 +21,13 @@
 #include <Arduino.h>
 #include "OC_core.h"
 #include "HemisphereApplet.h"
+#include "util/util_scope.h"
 
-const uint8_t HEM_PPQN_VALUES[] = {1, 2, 4, 8, 16, 24};
+#define HEM_SCOPE_DEFAULT_DECIMATION 8 // 64 columns * 256 ticks ~= 1s per screen
+
+// Plot area. In Y-T mode each input gets half of it.
+#define HEM_SCOPE_TOP 25
+#define HEM_SCOPE_HEIGHT 28
 
 class Scope : public HemisphereApplet {
 public:
@@ -34,9 +39,13 @@ public:
     void Start() {
         last_bpm_tick = OC::CORE::ticks;
         bpm = 0;
-        sample_ticks = 320;
         freeze = 0;
+        xy = 0;
+        cursor = 0;
         last_scope_tick = 0;
+        capture.Init(HEM_SCOPE_DEFAULT_DECIMATION);
+        drawn_frame = capture.frames();
+        drawn_xy = xy;
     }
 
     void Controller() {
@@ -50,23 +59,25 @@ public:
 
         if (Clock(1)) {
             if (last_scope_tick) {
-                int cycle_ticks = OC::CORE::ticks - last_scope_tick;
-                sample_ticks = cycle_ticks / 64;
-                sample_ticks = constrain(sample_ticks, 2, 64000);
+                // Smallest decimation at which one cycle fits on the screen
+                uint32_t cycle_ticks = OC::CORE::ticks - last_scope_tick;
+                uint8_t decimation = 0;
+                while (decimation < ScopeCapture::kMaxDecimation && (ScopeCapture::kWidth << decimation) < cycle_ticks)
+                    decimation++;
+                if (decimation != capture.decimation()) capture.set_decimation(decimation);
             }
             last_scope_tick = OC::CORE::ticks;
         }
 
         if (!freeze) {
-            last_cv = In(1);
-
-            if (--sample_countdown < 1) {
-                sample_countdown = sample_ticks;
-                if (++sample_num > 63) sample_num = 0;
-                int sample = Proportion(In(0), HEMISPHERE_MAX_CV, 128);
-                sample = constrain(sample, -128, 127) + 127;
-                snapshot[sample_num] = (uint8_t)sample;
+            uint8_t samples[2];
+            ForEachChannel(ch)
+            {
+                // +/- 8192 (about 5.3V) to 8 bits, no division
+                int sample = (In(ch) - HEMISPHERE_CENTER_CV + 8192) >> 6;
+                samples[ch] = constrain(sample, 0, 255);
             }
+            capture.Push(samples);
 
             ForEachChannel(ch) Out(ch, In(ch));
         }
@@ -74,93 +85,156 @@ public:
 
     void View() {
         gfxHeader(applet_name());
+        DrawSettings();
+        DrawCapture();
         DrawBPM();
-        DrawInput1();
-        DrawInput2();
         if (freeze) {
-            gfxInvert(0, 24, 64, 40);
+            gfxInvert(0, HEM_SCOPE_TOP, 64, HEM_SCOPE_HEIGHT);
         }
     }
 
     void OnButtonPress() {
-        freeze = 1 - freeze;
+        if (++cursor > 2) cursor = 0;
+        ResetCursor();
     }
 
     void OnEncoderMove(int direction) {
-        if (sample_ticks < 32) sample_ticks += direction;
-        else sample_ticks += direction * 10;
-        sample_ticks = constrain(sample_ticks, 2, 64000);
-        last_encoder_move = OC::CORE::ticks;
+        if (cursor == 0) {
+            int decimation = constrain(capture.decimation() + direction, 0, ScopeCapture::kMaxDecimation);
+            capture.set_decimation(decimation);
+        }
+        if (cursor == 1) xy = 1 - xy;
+        if (cursor == 2) freeze = 1 - freeze;
+        ResetCursor();
     }
         
     uint32_t OnDataRequest() {
         uint32_t data = 0;
-        // example: pack property_name at bit 0, with size of 8 bits
-        // Pack(data, PackLocation {0,8}, property_name); 
+        Pack(data, PackLocation {0,4}, capture.decimation());
+        Pack(data, PackLocation {4,1}, xy);
         return data;
     }
 
     void OnDataReceive(uint32_t data) {
-        // example: unpack value at bit 0 with size of 8 bits to property_name
-        // property_name = Unpack(data, PackLocation {0,8}); 
+        capture.set_decimation(Unpack(data, PackLocation {0,4}));
+        xy = Unpack(data, PackLocation {4,1});
     }
 
 protected:
     void SetHelp() {
         //                               "------------------" <-- Size Guide
-        help[HEMISPHERE_HELP_DIGITALS] = "Clk 1=BPM 2=Cycle1";
+        help[HEMISPHERE_HELP_DIGITALS] = "Clk 1=BPM 2=Cycle";
         help[HEMISPHERE_HELP_CVS]      = "1=CV1 2=CV2";
         help[HEMISPHERE_HELP_OUTS]     = "A=CV1 B=CV2";
-        help[HEMISPHERE_HELP_ENCODER]  = "T=SmplRate P=Freez";
+        help[HEMISPHERE_HELP_ENCODER]  = "Rate/Mode/Freeze";
         //                               "------------------" <-- Size Guide
     }
     
 private:
+    typedef util::ScopeCapture<64, 2> ScopeCapture;
+
     // BPM Calcultion
     int last_bpm_tick;
     int bpm;
 
-    // CV monitor
-    int last_cv;
+    // Settings
+    int cursor; // 0 = Rate, 1 = Mode, 2 = Freeze
     bool freeze;
+    bool xy; // Plot CV1 against CV2 instead of against time
 
     // Scope
-    uint8_t snapshot[64];
-    int sample_ticks; // Ticks between samples
-    int sample_countdown; // Last time a sample was taken
-    int sample_num; // Current sample number at the start
-    int last_encoder_move; // The last the the sample_ticks value was changed
-    int last_scope_tick; // Used to auto-calculate sample countdown
+    ScopeCapture capture;
+    uint32_t last_scope_tick; // Used to auto-calculate the decimation
+
+    // Line geometry of the last complete capture, rebuilt only when there is a new one.
+    // Y-T: the rows to draw in each column, per channel. X-Y: x in [0], y in [1].
+    uint8_t geometry_a[2][64];
+    uint8_t geometry_b[2][64];
+    uint32_t drawn_frame;
+    bool drawn_xy;
+
+    void DrawSettings() {
+        // Time per screen, 64 columns * 2^decimation ticks * 60us
+        uint32_t ms = (3840U << capture.decimation()) / 1000;
+        if (ms < 1000) {
+            gfxPrint(1, 15, ms);
+            gfxPrint("m");
+        } else {
+            gfxPrint(1, 15, ms / 1000);
+            gfxPrint("s");
+        }
+        gfxPrint(31, 15, xy ? "XY" : "YT");
+        gfxPrint(45, 15, freeze ? "Hld" : "Run");
 
-    // Icons
+        if (cursor == 0) gfxCursor(1, 23, 24);
+        if (cursor == 1) gfxCursor(31, 23, 12);
+        if (cursor == 2) gfxCursor(45, 23, 18);
+    }
 
-    void DrawBPM() {
-        gfxPrint(9, 15, "BPM ");
-        gfxPrint(bpm / 4);
-        gfxLine(0, 24, 63, 24);
+    void DrawCapture() {
+        if (capture.frames() != drawn_frame || xy != drawn_xy) {
+            drawn_frame = capture.frames();
+            drawn_xy = xy;
+            if (xy) BuildXY();
+            else BuildYT();
+        }
 
-        if (OC::CORE::ticks - last_bpm_tick < 1666) gfxBitmap(1, 15, 8, CLOCK_ICON);
+        if (xy) {
+            for (int x = 1; x < 64; x++)
+            {
+                gfxLine(geometry_a[0][x - 1], geometry_a[1][x - 1], geometry_a[0][x], geometry_a[1][x]);
+            }
+        } else {
+            ForEachChannel(ch)
+            {
+                for (int x = 0; x < 64; x++)
+                {
+                    gfxRect(x, geometry_a[ch][x], 1, geometry_b[ch][x] - geometry_a[ch][x] + 1);
+                }
+            }
+        }
+
+        // Progress of the capture that's under way
+        gfxLine(0, 53, capture.position(), 53);
+        gfxDottedLine(capture.position(), 53, 63, 53);
     }
 
-    void DrawInput1() {
-        for (int s = 0; s < 64; s++)
+    // Each column is drawn from its max to its min, stretched so that it meets the
+    // previous column
+    void BuildYT() {
+        const int height = HEM_SCOPE_HEIGHT / 2;
+        ForEachChannel(ch)
         {
-            int x = s + sample_num;
-            if (x > 63) x -= 64;
-            int l = Proportion(snapshot[x], 255, 28);
-            gfxPixel(x, (28 - l) + 24);
+            const int bottom = HEM_SCOPE_TOP + (height * ch) + height - 1;
+            ScopeCapture::Column prev = capture.column(ch, 0);
+            for (int x = 0; x < 64; x++)
+            {
+                ScopeCapture::Column c = capture.column(ch, x);
+                uint8_t lo = c.min > prev.max ? prev.max : c.min;
+                uint8_t hi = c.max < prev.min ? prev.min : c.max;
+                geometry_a[ch][x] = bottom - ((hi * height) >> 8);
+                geometry_b[ch][x] = bottom - ((lo * height) >> 8);
+                prev = c;
+            }
         }
+    }
 
-        if (OC::CORE::ticks - last_encoder_move < 16667) {
-            gfxPrint(1, 26, sample_ticks);
+    // One point per column, at the middle of each channel's range
+    void BuildXY() {
+        const int bottom = HEM_SCOPE_TOP + HEM_SCOPE_HEIGHT - 1;
+        for (int x = 0; x < 64; x++)
+        {
+            ScopeCapture::Column cx = capture.column(0, x);
+            ScopeCapture::Column cy = capture.column(1, x);
+            geometry_a[0][x] = (cx.min + cx.max) >> 3;
+            geometry_a[1][x] = bottom - ((((cy.min + cy.max) >> 1) * HEM_SCOPE_HEIGHT) >> 8);
         }
     }
 
-    void DrawInput2() {
-        gfxLine(0, 53, 63, 53);
-        gfxBitmap(1, 55, 8, CV_ICON);
-        gfxPos(12, 55);
-        gfxPrintVoltage(last_cv);
+    void DrawBPM() {
+        gfxPrint(12, 55, "BPM ");
+        gfxPrint(bpm / 4);
+        if (OC::CORE::ticks - last_bpm_tick < 1666) gfxBitmap(1, 55, 8, CLOCK_ICON);
     }
 };
 
@@ -173,7 +247,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Scope Scope_instance[2];
+HS::AppletInstance<Scope> Scope_instance;
 
 void Scope_Start(bool hemisphere) {
     Scope_instance[hemisphere].BaseStart(hemisphere);
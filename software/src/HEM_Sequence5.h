@@ -161,7 +161,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Sequence5 Sequence5_instance[2];
+HS::AppletInstance<Sequence5> Sequence5_instance;
 
 void Sequence5_Start(bool hemisphere) {
     Sequence5_instance[hemisphere].BaseStart(hemisphere);
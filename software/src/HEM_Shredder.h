@@ -305,7 +305,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Shredder Shredder_instance[2];
+HS::AppletInstance<Shredder> Shredder_instance;
 
 void Shredder_Start(bool hemisphere) {Shredder_instance[hemisphere].BaseStart(hemisphere);}
 void Shredder_Controller(bool hemisphere, bool forwarding) {Shredder_instance[hemisphere].BaseController(forwarding);}
@@ -157,7 +157,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Shuffle Shuffle_instance[2];
+HS::AppletInstance<Shuffle> Shuffle_instance;
 
 void Shuffle_Start(bool hemisphere) {
     Shuffle_instance[hemisphere].BaseStart(hemisphere);
@@ -168,7 +168,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-SkewedLFO SkewedLFO_instance[2];
+HS::AppletInstance<SkewedLFO> SkewedLFO_instance;
 
 void SkewedLFO_Start(bool hemisphere) {
     SkewedLFO_instance[hemisphere].BaseStart(hemisphere);
@@ -155,7 +155,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Slew Slew_instance[2];
+HS::AppletInstance<Slew> Slew_instance;
 
 void Slew_Start(bool hemisphere) {
     Slew_instance[hemisphere].BaseStart(hemisphere);
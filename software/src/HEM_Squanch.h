@@ -38,6 +38,7 @@ public:
         quantizer.Init();
         scale = 5;
         quantizer.Configure(OC::Scales::GetScale(scale), 0xffff);
+        SubscribeCV(1, CV_STEPPED);
     }
 
     void Controller() {
@@ -53,7 +54,8 @@ public:
             {
                 // For the B/D output, CV 2 is used to shift the output; for the A/C
                 // output, the output is raised by one octave when Digital 2 is gated.
-                int32_t shift_alt = (ch == 1) ? DetentedIn(1) : Gate(1) * (12 << 7);
+                // The CV shift is in whole semitones, so the output stays in tune.
+                int32_t shift_alt = (ch == 1) ? SteppedIn(1) : Gate(1) * (12 << 7);
 
                 int32_t quantized = quantizer.Process(pitch, 0, shift[ch]);
                 Out(ch, quantized + shift_alt);
@@ -169,7 +171,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Squanch Squanch_instance[2];
+HS::AppletInstance<Squanch> Squanch_instance;
 
 void Squanch_Start(bool hemisphere) {Squanch_instance[hemisphere].BaseStart(hemisphere);}
 void Squanch_Controller(bool hemisphere, bool forwarding) {Squanch_instance[hemisphere].BaseController(forwarding);}
@@ -362,7 +362,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Stairs Stairs_instance[2];
+HS::AppletInstance<Stairs> Stairs_instance;
 
 void Stairs_Start(bool hemisphere) {
     Stairs_instance[hemisphere].BaseStart(hemisphere);
@@ -111,7 +111,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Switch Switch_instance[2];
+HS::AppletInstance<Switch> Switch_instance;
 
 void Switch_Start(bool hemisphere) {
     Switch_instance[hemisphere].BaseStart(hemisphere);
@@ -32,6 +32,7 @@
 #include "braids_quantizer.h"
 #include "braids_quantizer_scales.h"
 #include "OC_scales.h"
+#include "OC_deferred.h"
 
 #define ACID_HALF_STEPS 16
 #define ACID_MAX_STEPS 32
@@ -81,6 +82,8 @@ class TB_3PO : public HemisphereApplet
       //transpose_note_in = 0;    
 
       lock_seed = 0;
+      regenerate_job.Init(RegenerateJob, this);
+      next_pattern_ready = false;
       reseed();
       regenerate_all();
 
@@ -90,6 +93,9 @@ class TB_3PO : public HemisphereApplet
     {
       // Track timing to set gate timing at ~32nd notes per recent clocks
       int this_tick = OC::CORE::ticks;
+
+      // Swap in a freshly generated pattern, if there is one
+      pick_up_regeneration();
       
       // Regenerate / Reset
       if (Clock(1) || manual_reset_flag) 
@@ -253,10 +259,8 @@ class TB_3PO : public HemisphereApplet
       Out(1, curr_gate_cv);
 
 
-      // Timesliced generation of new patterns, if triggered
-      // Do this last to not interfere with the body of the time for this hemisphere's update
-      // (This is speculation without knowing how to best profile performance on this system)
-      update_regeneration();   
+      // Hand off generation of new patterns, if triggered
+      update_regeneration();
     }
 
     void View() {
@@ -485,7 +489,24 @@ class TB_3PO : public HemisphereApplet
     
     uint8_t rand_apply_anim = 0;  // Countdown to animate icons for when regenerate occurs
 
-    uint8_t regenerate_phase = 0;  // Split up random generation over multiple frames
+    // Pattern generation, run from loop() via the deferred job queue
+    struct AcidPattern {
+      uint32_t gates;
+      uint32_t slides;
+      uint32_t accents;
+      uint32_t oct_ups;
+      uint32_t oct_downs;
+      uint8_t notes[ACID_MAX_STEPS];
+      uint16_t seed;        // Inputs, snapshot when the job is posted
+      uint8_t density;
+      uint8_t scale_size;
+    };
+
+    OC::DeferredJob regenerate_job;
+    AcidPattern next_pattern;  // Only touched by the job until next_pattern_ready is set
+    volatile bool next_pattern_ready = false;
+    uint8_t regenerate_pending = 0;  // Post the job as soon as it's free
+    uint32_t rand_state;  // For rand_range(), only used by the job
   
     // Get the cv value to use for a given step including root + transpose values
     int get_pitch_for_step(int step_num)
@@ -535,69 +556,109 @@ class TB_3PO : public HemisphereApplet
       seed = random(0, 65535); // 16 bits
     }
     
-  	// Trigger generating the sequence deterministically using the seed (over the next couple of Controller() calls)
+  	// Trigger generating the sequence deterministically using the seed (picked up a few ms later)
   	void regenerate_all()
   	{
-      regenerate_phase = 1;  // Set to regenerate on loop
+      regenerate_pending = 1;  // Set to regenerate on loop
       rand_apply_anim = 40;  // Show that regenerate started (anim for this many display updates)
   	}
 
     void regenerate_if_density_or_scale_changed()
     {
       // Skip if density has not changed, or if currently regenerating
-      if(regenerate_phase == 0)
+      if(!regenerate_pending && !regenerate_job.queued() && !next_pattern_ready)
       {
         if(density != current_pattern_density || scale_size != current_pattern_scale_size)
         {
-          regenerate_phase = 1;  // regenerate all since pitches take density into account
+          regenerate_pending = 1;  // regenerate all since pitches take density into account
         }
       }
     }
 
-    // Amortize random generation over multiple frames
-    // Without having profiled this properly, I'm less concerned about overrunning isr times alloted to this app if it's amortized
+    // Generation is handed off to the deferred job queue rather than run in the ISR. The inputs are
+    // snapshot into next_pattern when posting, and the finished pattern is picked up at the start of the
+    // next Controller() call after the job has run.
     void update_regeneration()
     {
-      if(regenerate_phase == 0)
+      if(!regenerate_pending || regenerate_job.queued() || next_pattern_ready)
       {
         return;
       }
-      
-      randomSeed(seed+regenerate_phase);  // Ensure random()'s seed at each phase for determinism (note: offset to decouple phase behavior correllations that would result)
-      
-      switch(regenerate_phase)
+
+      next_pattern.seed = seed;
+      next_pattern.density = density;
+      next_pattern.scale_size = scale_size;
+      if(OC::Deferred::Post(&regenerate_job))
       {
-        // 1st set of 16 steps
-        case 1: regenerate_pitches(); ++regenerate_phase; break;
-        //case 2: apply_density(); regenerate_phase = 0; break;
-        case 2: apply_density(); ++regenerate_phase;break;
-        // 2nd set of 16 steps
-        case 3: regenerate_pitches(); ++regenerate_phase; break;      
-        // After doing the 2nd set of bitvectors, swap the low and high 16 bits to align the first 16 steps to the steps they would have had
-        // when this app only rendered 16 steps
-        //case 4: apply_density(); restore_legacy_byte_orders(); regenerate_phase = 0; break;
-        case 4: apply_density(); regenerate_phase = 0; break;
-        default: break;
+        regenerate_pending = 0;
       }
     }
 
-      
+    static void RegenerateJob(void *context)
+    {
+      TB_3PO *self = static_cast<TB_3PO *>(context);
+      AcidPattern &p = self->next_pattern;
+
+      // Same phases as when this was timesliced in Controller(), each with its own seed offset for determinism
+      // (note: offset to decouple phase behavior correllations that would result)
+      for(int phase = 1; phase <= 4; ++phase)
+      {
+        self->rand_seed(p.seed + phase);
+        if(phase & 1)
+        {
+          self->regenerate_pitches(p, phase);
+        }
+        else
+        {
+          self->apply_density(p, phase);
+        }
+      }
+      self->next_pattern_ready = true;
+    }
+
+    void pick_up_regeneration()
+    {
+      if(!next_pattern_ready)
+      {
+        return;
+      }
+
+      gates = next_pattern.gates;
+      slides = next_pattern.slides;
+      accents = next_pattern.accents;
+      oct_ups = next_pattern.oct_ups;
+      oct_downs = next_pattern.oct_downs;
+      memcpy(notes, next_pattern.notes, sizeof(notes));
+
+      // Handle size as semitone scale for display if 'off'
+      if(scale_size == 0)
+      {
+        scale_size = 12;
+      }
+
+      // Track the values used to render the pattern (to detect changes)
+      current_pattern_density = next_pattern.density;
+      current_pattern_scale_size = next_pattern.scale_size;
+
+      next_pattern_ready = false;
+    }
+
     // Generate the notes sequence based on the seed and modified by density
-    void regenerate_pitches()
+    void regenerate_pitches(AcidPattern &p, int phase)
     {
 
       // 32 steps are computed across two passes of this function
       // Determine if the first 16 or second 16 steps are being handled here
-      bool bFirstHalf = regenerate_phase < 3;
+      bool bFirstHalf = phase < 3;
 
       // How much pitch variety to use from the available pitches (one of the factors of the 'density' control when < centerpoint)
-      int pitch_change_dens = get_pitch_change_density();   
+      int pitch_change_dens = get_pitch_change_density(p.density);   
       int available_pitches = 0;
-      if(scale_size > 0)
+      if(p.scale_size > 0)
       {
         if(pitch_change_dens > 7)
         {
-          available_pitches = scale_size-1;
+          available_pitches = p.scale_size-1;
         }
         else if(pitch_change_dens < 2)
         {
@@ -606,14 +667,14 @@ class TB_3PO : public HemisphereApplet
         }
         else  // Range 3-7
         {
-          int range_from_scale = scale_size - 3;
+          int range_from_scale = p.scale_size - 3;
           if(range_from_scale < 4)  // Ok to saturate at full note count
           {
             range_from_scale = 4;
           }
           // Range from 2 pitches to just <= full scale available
           available_pitches = 3 + Proportion(pitch_change_dens-3, 4, range_from_scale);
-          available_pitches = constrain(available_pitches, 1, scale_size -1);
+          available_pitches = constrain(available_pitches, 1, p.scale_size -1);
         }
       }
 
@@ -621,8 +682,8 @@ class TB_3PO : public HemisphereApplet
       if(bFirstHalf)
       {
         // Clear only on the first pass (otherwise, resume with current value)
-        oct_ups = 0;
-        oct_downs = 0;
+        p.oct_ups = 0;
+        p.oct_downs = 0;
       }
 
       // Do either the first or second set of steps on this pass
@@ -634,85 +695,85 @@ class TB_3PO : public HemisphereApplet
         int force_repeat_note_prob = 50 - (pitch_change_dens * 6);
         if(s > 0 && rand_bit(force_repeat_note_prob))
         {
-          notes[s] = notes[s-1];
+          p.notes[s] = p.notes[s-1];
         }
         else
         {
           // Grab a random note index from the scale's available pitches
           // Since this starts at 0, the root note will always be included, and adjacent scale notes are included as the range grows
-          notes[s] = random(0,available_pitches+1);  // Looking at the source, random(min,max) appears to return the range: min to max-1
+          p.notes[s] = rand_range(0,available_pitches+1);  // Looking at the source, random(min,max) appears to return the range: min to max-1
 
           // Random oct up or down (Treating octave based on the scale's number of notes)
-          oct_ups <<= 1;
-          oct_downs <<= 1;
+          p.oct_ups <<= 1;
+          p.oct_downs <<= 1;
 
           if(rand_bit(40))
           {
             if(rand_bit(50))
             {
-              oct_ups |= 0x1;
+              p.oct_ups |= 0x1;
             }
             else
             {
-              oct_downs |= 0x1;
+              p.oct_downs |= 0x1;
             }
           }
         }      
       }
 
       // Handle size as semitone scale for display if 'off'
-      if(scale_size == 0)
+      if(p.scale_size == 0)
       {
-        scale_size = 12;
+        p.scale_size = 12;
       }
-
-      current_pattern_scale_size = scale_size;
   	}
     
   	// Change pattern density without affecting pitches
-  	void apply_density()
+  	void apply_density(AcidPattern &p, int phase)
   	{
   		int latest_slide = 0; // Track previous bit for some algos
       int latest_accent = 0; // Track previous bit for some algos
   		
       // Get gate probability from the 'density' value
-      int on_off_dens = get_on_off_density();
+      int on_off_dens = get_on_off_density(p.density);
       int densProb = 10 + on_off_dens * 14;  // Should start >0 and reach 100+
 
       // Clear if this is the first 16 steps to generate (otherwise append to these bit vectors for the 2nd set of 16)
-      bool bFirstHalf = regenerate_phase < 3;
+      bool bFirstHalf = phase < 3;
       if(bFirstHalf)
       {
-        gates = 0;
-        slides = 0;
-        accents = 0;
+        p.gates = 0;
+        p.slides = 0;
+        p.accents = 0;
       }
 
      // Apply to each step
      // Do half of the steps on each pass of this func
      for(int i=0; i< ACID_HALF_STEPS; ++i)
   		{
-        gates <<= 1;        
-  			gates |= rand_bit(densProb);
+        p.gates <<= 1;        
+  			p.gates |= rand_bit(densProb);
 
         // Less probability of consecutive slides
-        slides <<= 1;
+        p.slides <<= 1;
         latest_slide = rand_bit((latest_slide ? 10 : 18));
-        slides |= latest_slide;
+        p.slides |= latest_slide;
         
         // Less probability of consecutive accents
-        accents <<= 1;
+        p.accents <<= 1;
         latest_accent = rand_bit((latest_accent ? 7 : 16));
-        accents |= latest_accent;       
+        p.accents |= latest_accent;       
   		}
 
-      // Track the value of density used to render the pattern (to detect changes)
-      current_pattern_density = density;
-
   	}
  
     // Get on/off likelihood from the current value of 'density'
     int get_on_off_density()
+    {
+      return get_on_off_density(density);
+    }
+
+    int get_on_off_density(uint8_t density)
     {
       // density has a range 0-14
       // Convert density to a bipolar value from -7..+7, with the +-7 extremes in either direction 
@@ -725,6 +786,11 @@ class TB_3PO : public HemisphereApplet
     // The density slider's center and right half indicate full pitch change range
     // The further the slider is to the left of the centerpoint, the less pitches should change
     int get_pitch_change_density()
+    {
+      return get_pitch_change_density(density);
+    }
+
+    int get_pitch_change_density(uint8_t density)
     {
       // Smaller values indicate fewer pitches should be drawn from
       return constrain(density, 0,8);  // Note that the right half of the slider is clamped to full range
@@ -763,9 +829,37 @@ class TB_3PO : public HemisphereApplet
     // Pass in a probability 0-100 to get that % chance to return 1
   	int rand_bit(int prob)
   	{
-  		return (random(1, 100) <= prob) ? 1 : 0;
+  		return (rand_range(1, 100) <= prob) ? 1 : 0;
   	}
 
+    // The generator behind Teensyduino's randomSeed()/random() (as in avr-libc), kept locally so that
+    // generation can run outside the ISR without other applets' random() calls changing the result.
+    void rand_seed(uint32_t s)
+    {
+      if(s > 0)
+      {
+        rand_state = s;
+      }
+    }
+
+    int32_t rand_range(int32_t howsmall, int32_t howbig)
+    {
+      if(howsmall >= howbig)
+      {
+        return howsmall;
+      }
+
+      int32_t x = rand_state;
+      if(x == 0) x = 123459876;
+      int32_t hi = x / 127773;
+      int32_t lo = x % 127773;
+      x = 16807 * lo - 2836 * hi;
+      if(x < 0) x += 0x7FFFFFFF;
+      rand_state = x;
+
+      return (static_cast<uint32_t>(x) % static_cast<uint32_t>(howbig - howsmall)) + howsmall;
+    }
+
 
     void set_quantizer_scale(int new_scale)
     {
@@ -994,7 +1088,7 @@ class TB_3PO : public HemisphereApplet
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-TB_3PO TB_3PO_instance[2];
+HS::AppletInstance<TB_3PO> TB_3PO_instance;
 
 void TB_3PO_Start(bool hemisphere) {
     TB_3PO_instance[hemisphere].BaseStart(hemisphere);
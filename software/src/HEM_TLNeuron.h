@@ -164,7 +164,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-TLNeuron TLNeuron_instance[2];
+HS::AppletInstance<TLNeuron> TLNeuron_instance;
 
 void TLNeuron_Start(bool hemisphere) {
     TLNeuron_instance[hemisphere].BaseStart(hemisphere);
@@ -52,6 +52,11 @@ public:
         quantizer.Init();
         scale = OC::Scales::SCALE_SEMI;
         quantizer.Configure(OC::Scales::GetScale(scale), 0xffff); // Semi-tone
+
+        // The register only moves on a clock. CV 1 is checked when it changes, so that the
+        // length on the display follows it.
+        WakeOn(WAKE_CLOCK_1 | WAKE_CV_1);
+        Wake(); // Set the outputs from the new register without waiting for a clock
     }
 
     void Controller() {
@@ -108,6 +113,7 @@ public:
             if (scale >= TM_MAX_SCALE) scale = 0;
             if (scale < 0) scale = TM_MAX_SCALE - 1;
             quantizer.Configure(OC::Scales::GetScale(scale), 0xffff);
+            Wake(); // Requantize the output now
         }
     }
 
@@ -126,6 +132,7 @@ public:
         length = Unpack(data, PackLocation {23,4}) + 1;
         scale = Unpack(data, PackLocation {27,6});
         quantizer.Configure(OC::Scales::GetScale(scale), 0xffff);
+        Wake();
     }
 
 protected:
@@ -196,7 +203,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-TM TM_instance[2];
+HS::AppletInstance<TM> TM_instance;
 
 void TM_Start(bool hemisphere) {
     TM_instance[hemisphere].BaseStart(hemisphere);
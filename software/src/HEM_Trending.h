@@ -48,6 +48,7 @@ public:
         }
         sample_countdown = 0;
         sensitivity = 40;
+        ForEachChannel(ch) SubscribeCV(ch, CV_SMOOTHED);
     }
 
     void Controller() {
@@ -82,7 +83,7 @@ public:
             ForEachChannel(ch)
             {
                 bool changed = Changed(ch);
-                signal[ch] = In(ch);
+                signal[ch] = SmoothedIn(ch); // So that noise doesn't register as movement
                 if (Observe(ch, signal[ch], last_signal[ch])) last_signal[ch] = signal[ch];
                 if (assign[ch] == Trend::changedvalue && changed) fire[ch] = 1;
             }
@@ -196,7 +197,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Trending Trending_instance[2];
+HS::AppletInstance<Trending> Trending_instance;
 
 void Trending_Start(bool hemisphere) {Trending_instance[hemisphere].BaseStart(hemisphere);}
 void Trending_Controller(bool hemisphere, bool forwarding) {Trending_instance[hemisphere].BaseController(forwarding);}
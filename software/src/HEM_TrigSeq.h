@@ -171,7 +171,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-TrigSeq TrigSeq_instance[2];
+HS::AppletInstance<TrigSeq> TrigSeq_instance;
 
 void TrigSeq_Start(bool hemisphere) {
     TrigSeq_instance[hemisphere].BaseStart(hemisphere);
@@ -174,7 +174,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-TrigSeq16 TrigSeq16_instance[2];
+HS::AppletInstance<TrigSeq16> TrigSeq16_instance;
 
 void TrigSeq16_Start(bool hemisphere) {
     TrigSeq16_instance[hemisphere].BaseStart(hemisphere);
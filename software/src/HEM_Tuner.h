@@ -224,7 +224,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Tuner Tuner_instance[2];
+HS::AppletInstance<Tuner> Tuner_instance;
 
 void Tuner_Start(bool hemisphere) {
     Tuner_instance[hemisphere].BaseStart(hemisphere);
@@ -63,6 +63,7 @@ public:
     }
 
     void View() {
+        RefreshUserWaveforms();
         gfxHeader(applet_name());
         DrawInterface();
     }
@@ -119,6 +120,7 @@ private:
 
     // Settings
     int waveform_number[2];
+    uint16_t waveform_version[2]; // WaveformManager::Version() when each osc was last built
     int freq[2];
     
     void DrawInterface() {
@@ -166,9 +168,19 @@ private:
         gfxDottedLine(0, 44, 63, 44, 8);
     }
 
+    /* Pick up changes made in the Waveform Editor */
+    void RefreshUserWaveforms() {
+        ForEachChannel(ch)
+        {
+            int waveform = WaveformManager::RefreshWaveform(waveform_number[ch], waveform_version[ch]);
+            if (waveform >= 0) SwitchWaveform(ch, waveform);
+        }
+    }
+
     void SwitchWaveform(byte ch, int waveform) {
         osc[ch] = WaveformManager::VectorOscillatorFromWaveform(waveform);
         waveform_number[ch] = waveform;
+        waveform_version[ch] = WaveformManager::Version();
         osc[ch].SetFrequency(freq[ch]);
 #ifdef BUCHLA_4U
         osc[ch].SetScale((12 << 7) * 8); // 8V
@@ -193,7 +205,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-VectorEG VectorEG_instance[2];
+HS::AppletInstance<VectorEG> VectorEG_instance;
 
 void VectorEG_Start(bool hemisphere) {VectorEG_instance[hemisphere].BaseStart(hemisphere);}
 void VectorEG_Controller(bool hemisphere, bool forwarding) {VectorEG_instance[hemisphere].BaseController(forwarding);}
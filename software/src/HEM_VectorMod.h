@@ -53,6 +53,7 @@ public:
     }
 
     void View() {
+        RefreshUserWaveforms();
         gfxHeader(applet_name());
         DrawInterface();
     }
@@ -108,6 +109,7 @@ private:
 
     // Settings
     int waveform_number[2];
+    uint16_t waveform_version[2]; // WaveformManager::Version() when each osc was last built
     int freq[2];
     
     void DrawInterface() {
@@ -155,9 +157,19 @@ private:
         gfxDottedLine(0, 44, 63, 44, 8);
     }
 
+    /* Pick up changes made in the Waveform Editor */
+    void RefreshUserWaveforms() {
+        ForEachChannel(ch)
+        {
+            int waveform = WaveformManager::RefreshWaveform(waveform_number[ch], waveform_version[ch]);
+            if (waveform >= 0) SwitchWaveform(ch, waveform);
+        }
+    }
+
     void SwitchWaveform(byte ch, int waveform) {
         osc[ch] = WaveformManager::VectorOscillatorFromWaveform(waveform);
         waveform_number[ch] = waveform;
+        waveform_version[ch] = WaveformManager::Version();
         osc[ch].SetFrequency(freq[ch]);
 #ifdef BUCHLA_4U
         osc[ch].Offset((12 << 7) * 4);
@@ -182,7 +194,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-VectorMod VectorMod_instance[2];
+HS::AppletInstance<VectorMod> VectorMod_instance;
 
 void VectorMod_Start(bool hemisphere) {VectorMod_instance[hemisphere].BaseStart(hemisphere);}
 void VectorMod_Controller(bool hemisphere, bool forwarding) {VectorMod_instance[hemisphere].BaseController(forwarding);}
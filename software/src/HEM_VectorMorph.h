@@ -57,6 +57,7 @@ public:
     }
 
     void View() {
+        RefreshUserWaveforms();
         gfxHeader(applet_name());
         DrawInterface();
     }
@@ -114,6 +115,7 @@ private:
 
     // Settings
     int waveform_number[2];
+    uint16_t waveform_version[2]; // WaveformManager::Version() when each osc was last built
     int phase[2];
     bool linked = 1;
     
@@ -167,9 +169,19 @@ private:
         gfxDottedLine(transport_x, 24, transport_x, 63, 3);
     }
 
+    /* Pick up changes made in the Waveform Editor */
+    void RefreshUserWaveforms() {
+        ForEachChannel(ch)
+        {
+            int waveform = WaveformManager::RefreshWaveform(waveform_number[ch], waveform_version[ch]);
+            if (waveform >= 0) SwitchWaveform(ch, waveform);
+        }
+    }
+
     void SwitchWaveform(byte ch, int waveform) {
         osc[ch] = WaveformManager::VectorOscillatorFromWaveform(waveform);
         waveform_number[ch] = waveform;
+        waveform_version[ch] = WaveformManager::Version();
         osc[ch].SetScale(HEMISPHERE_MAX_CV);
     }
 };
@@ -183,7 +195,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-VectorMorph VectorMorph_instance[2];
+HS::AppletInstance<VectorMorph> VectorMorph_instance;
 
 void VectorMorph_Start(bool hemisphere) {VectorMorph_instance[hemisphere].BaseStart(hemisphere);}
 void VectorMorph_Controller(bool hemisphere, bool forwarding) {VectorMorph_instance[hemisphere].BaseController(forwarding);}
@@ -137,7 +137,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-Voltage Voltage_instance[2];
+HS::AppletInstance<Voltage> Voltage_instance;
 
 void Voltage_Start(bool hemisphere) {Voltage_instance[hemisphere].BaseStart(hemisphere);}
 void Voltage_Controller(bool hemisphere, bool forwarding) {Voltage_instance[hemisphere].BaseController(forwarding);}
@@ -333,7 +333,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-hMIDIIn hMIDIIn_instance[2];
+HS::AppletInstance<hMIDIIn> hMIDIIn_instance;
 
 void hMIDIIn_Start(bool hemisphere) {
     hMIDIIn_instance[hemisphere].BaseStart(hemisphere);
@@ -296,7 +296,7 @@ private:
 ///  should prefer to handle things in the HemisphereApplet child class
 ///  above.
 ////////////////////////////////////////////////////////////////////////////////
-hMIDIOut hMIDIOut_instance[2];
+HS::AppletInstance<hMIDIOut> hMIDIOut_instance;
 
 void hMIDIOut_Start(bool hemisphere) {
     hMIDIOut_instance[hemisphere].BaseStart(hemisphere);
@@ -32,6 +32,7 @@ typedef int32_t simfloat;
 #endif
 
 #include "HSicons.h"
+#include "HSCVInputManager.h"
 
 #ifndef HSAPPLICATION_H_
 #define HSAPPLICATION_H_
@@ -39,7 +40,6 @@ typedef int32_t simfloat;
 #define HSAPPLICATION_CURSOR_TICKS 12000
 #define HSAPPLICATION_5V 7680
 #define HSAPPLICATION_3V 4608
-#define HSAPPLICATION_CHANGE_THRESHOLD 32
 
 #ifdef BUCHLA_4U
 #define PULSE_VOLTAGE 8
@@ -55,14 +55,13 @@ public:
     virtual void Resume();
 
     void BaseController() {
+        CVInputManager *cv_m = cv_m->get();
+        cv_m->Update();
         for (uint8_t ch = 0; ch < 4; ch++)
         {
             // Set ADC input values
-            inputs[ch] = OC::ADC::raw_pitch_value((ADC_CHANNEL)ch);
-            if (abs(inputs[ch] - last_cv[ch]) > HSAPPLICATION_CHANGE_THRESHOLD) {
-                changed_cv[ch] = 1;
-                last_cv[ch] = inputs[ch];
-            } else changed_cv[ch] = 0;
+            inputs[ch] = cv_m->Value(ch);
+            changed_cv[ch] = cv_m->Changed(ch);
 
             if (clock_countdown[ch] > 0) {
                 if (--clock_countdown[ch] == 0) Out(ch, 0);
@@ -277,8 +276,7 @@ private:
     uint32_t last_view_tick; // Time since the last view, for activating screen blanking
     int inputs[4]; // Last ADC values
     int outputs[4]; // Last DAC values; inputs[] and outputs[] are used to allow access to values in Views
-    bool changed_cv[4]; // Has the input changed by more than 1/8 semitone since the last read?
-    int last_cv[4]; // For change detection
+    bool changed_cv[4]; // Has the input changed by more than 1/4 semitone since the last read?
     uint32_t last_clock[4]; // Tick number of the last clock observed by the child class
     uint32_t cycle_ticks[4]; // Number of ticks between last two clocks
 };
@@ -0,0 +1,119 @@
+// Shared conditioning for the CV inputs, used by Hemisphere applets and HSApplication.
+//
+// The ADC scans one channel per ISR cycle, so each input gets a new reading every
+// four ticks. The manager does the input arithmetic once per new reading, for the
+// channel that was just scanned, rather than each consumer doing it every tick.
+//
+// The value and change detection are always maintained. Smoothed, stepped and slope
+// representations are only computed for inputs that have been subscribed to, usually
+// from an applet's Start() (see HemisphereApplet::SubscribeCV()). Subscriptions are
+// cleared when a different applet is loaded into the hemisphere.
+
+#ifndef CV_INPUT_MANAGER_H
+#define CV_INPUT_MANAGER_H
+
+#include "OC_ADC.h"
+
+const int CV_INPUT_CHANGE_THRESHOLD = 32; // 1/4 semitone
+const int CV_INPUT_STEP_BITS = 7; // Stepped values are whole semitones
+const int CV_INPUT_STEP_HYSTERESIS = 16; // Past the halfway point, before stepping
+const uint8_t CV_INPUT_SMOOTHING_DEFAULT = 3; // Smoothing coefficient is 1/(2^n) per reading
+const uint8_t CV_INPUT_SMOOTHING_MAX = 7;
+const uint8_t CV_INPUT_SLOPE_SMOOTHING = 3;
+
+// Representations that can be subscribed to, may be combined
+enum CVRepresentation {
+    CV_SMOOTHED = 0x01, // One-pole lowpass
+    CV_STEPPED = 0x02, // Nearest semitone, with hysteresis
+    CV_SLOPE = 0x04, // Smoothed change per reading
+};
+
+class CVInputManager {
+    static CVInputManager *instance;
+    int value[ADC_CHANNEL_LAST]; // Pitch-scaled value from the most recent reading
+    int last_cv[ADC_CHANNEL_LAST]; // For change detection
+    int32_t smoothed[ADC_CHANNEL_LAST]; // 8 bits of fraction
+    int stepped[ADC_CHANNEL_LAST];
+    int32_t slope[ADC_CHANNEL_LAST]; // 8 bits of fraction
+    uint8_t subscribed[ADC_CHANNEL_LAST]; // CVRepresentation bits
+    uint8_t smoothing[ADC_CHANNEL_LAST];
+    uint8_t changed; // Channel bits, only set during the tick that the channel was read
+
+    CVInputManager() {
+        for (int ch = 0; ch < ADC_CHANNEL_LAST; ch++)
+        {
+            value[ch] = 0;
+            last_cv[ch] = 0;
+            smoothed[ch] = 0;
+            stepped[ch] = 0;
+            slope[ch] = 0;
+            subscribed[ch] = 0;
+            smoothing[ch] = CV_INPUT_SMOOTHING_DEFAULT;
+        }
+        changed = 0;
+    }
+
+public:
+    static CVInputManager *get() {
+        if (!instance) instance = new CVInputManager;
+        return instance;
+    }
+
+    /* Call once per ISR cycle, after the ADC scan and before any of the inputs are read */
+    void Update() {
+        changed = 0;
+
+        int ch = (OC::ADC::scan_channel() + ADC_CHANNEL_LAST - 1) % ADC_CHANNEL_LAST;
+        int cv = OC::ADC::raw_pitch_value((ADC_CHANNEL)ch);
+        int delta = cv - value[ch];
+        value[ch] = cv;
+
+        if (abs(cv - last_cv[ch]) > CV_INPUT_CHANGE_THRESHOLD) {
+            changed = 0x01 << ch;
+            last_cv[ch] = cv;
+        }
+
+        uint8_t s = subscribed[ch];
+        if (s & CV_SMOOTHED) smoothed[ch] += ((cv << 8) - smoothed[ch]) >> smoothing[ch];
+        if (s & CV_STEPPED) {
+            int distance = abs(cv - stepped[ch]);
+            if (distance > (1 << (CV_INPUT_STEP_BITS - 1)) + CV_INPUT_STEP_HYSTERESIS) stepped[ch] = Step(cv);
+        }
+        if (s & CV_SLOPE) slope[ch] += ((delta << 8) - slope[ch]) >> CV_INPUT_SLOPE_SMOOTHING;
+    }
+
+    /* Adds representations for a channel, starting from its current value */
+    void Subscribe(int ch, uint8_t representation) {
+        uint8_t added = representation & ~subscribed[ch];
+        if (added & CV_SMOOTHED) smoothed[ch] = value[ch] << 8;
+        if (added & CV_STEPPED) stepped[ch] = Step(value[ch]);
+        if (added & CV_SLOPE) slope[ch] = 0;
+        subscribed[ch] |= representation;
+    }
+
+    void Unsubscribe(int ch) {
+        subscribed[ch] = 0;
+        smoothing[ch] = CV_INPUT_SMOOTHING_DEFAULT;
+    }
+
+    /* Higher is smoother and slower; the time constant is about 2^n readings */
+    void SetSmoothing(int ch, uint8_t n) {
+        smoothing[ch] = constrain(n, 1, CV_INPUT_SMOOTHING_MAX);
+    }
+
+    int Value(int ch) {return value[ch];}
+    bool Changed(int ch) {return (changed >> ch) & 0x01;}
+    int Smoothed(int ch) {return smoothed[ch] >> 8;}
+    int Stepped(int ch) {return stepped[ch];}
+    int Slope(int ch) {return (slope[ch] + 128) >> 8;}
+
+private:
+    static int Step(int cv) {
+        // Arithmetic shift rounds negative values down too, so this is nearest step
+        return ((cv + (1 << (CV_INPUT_STEP_BITS - 1))) >> CV_INPUT_STEP_BITS) << CV_INPUT_STEP_BITS;
+    }
+};
+
+CVInputManager *CVInputManager::instance = 0;
+
+#endif // CV_INPUT_MANAGER_H
@@ -28,18 +28,15 @@
 
 class LorenzGeneratorManager {
     static LorenzGeneratorManager *instance;
-    uint32_t freq[2]; // Frequency per hemisphere
     bool reset[2]; // Reset per hemisphere
     uint32_t last_process_tick;
-    streams::LorenzGenerator lorenz;
+    streams::LorenzEngine<2> lorenz; // One attractor per hemisphere
 
     LorenzGeneratorManager() {
-        lorenz.Init(0);
-        lorenz.Init(1);
-        lorenz.set_out_a(streams::LORENZ_OUTPUT_X1);
-        lorenz.set_out_b(streams::LORENZ_OUTPUT_Y1);
-        lorenz.set_out_c(streams::LORENZ_OUTPUT_X2);
-        lorenz.set_out_d(streams::LORENZ_OUTPUT_Y2);
+        lorenz.Init();
+        lorenz.set_fast(true);
+        reset[0] = 0;
+        reset[1] = 0;
         last_process_tick = 0;
     }
 
@@ -49,17 +46,18 @@ public:
         return instance;
     }
 
+    /* Outputs are x and y of the first hemisphere's attractor, then x and y of the second */
     int GetOut(int out) {
-        return lorenz.dac_code(out);
+        int h = out >> 1;
+        return (out & 0x01) ? lorenz.lorenz_y(h) : lorenz.lorenz_x(h);
     }
 
     void SetRho(bool hemisphere, int16_t rho) {
-        if (hemisphere == 0) lorenz.set_rho1(rho);
-        else lorenz.set_rho2(rho);
+        lorenz.set_rho(hemisphere, rho);
     }
 
     void SetFreq(bool hemisphere, uint32_t freq_) {
-        freq[hemisphere] = freq_;
+        lorenz.set_rate(hemisphere, freq_, 2);
     }
 
     void Reset(bool hemisphere) {
@@ -69,7 +67,9 @@ public:
     void Process() {
         if (OC::CORE::ticks - last_process_tick >= LORENZ_PROCESS_TICKS) {
             last_process_tick = OC::CORE::ticks;
-            lorenz.Process(freq[0], freq[1], reset[0], reset[1], 2, 2);
+            if (reset[0]) lorenz.Reset(0);
+            if (reset[1]) lorenz.Reset(1);
+            lorenz.Process();
             reset[0] = 0;
             reset[1] = 0;
         }
@@ -34,6 +34,7 @@
 #include "src/drivers/FreqMeasure/OC_FreqMeasure.h"
 #include "HSicons.h"
 #include "HSClockManager.h"
+#include "HSCVInputManager.h"
 
 #define LEFT_HEMISPHERE 0
 #define RIGHT_HEMISPHERE 1
@@ -48,7 +49,6 @@
 #define HEMISPHERE_CLOCK_TICKS 100
 #define HEMISPHERE_CURSOR_TICKS 12000
 #define HEMISPHERE_ADC_LAG 33
-#define HEMISPHERE_CHANGE_THRESHOLD 32
 
 #ifdef BUCHLA_4U
 #define PULSE_VOLTAGE 8
@@ -57,6 +57,15 @@
 #endif
 
 // Codes for help system sections
+// Events that wake an applet that has opted in to event-driven dispatch with WakeOn()
+enum HemisphereWake {
+    WAKE_CLOCK_1 = 0x01, // Clock(0), including master clock forwarding and the metronome
+    WAKE_CLOCK_2 = 0x02, // Clock(1)
+    WAKE_CV_1 = 0x04, // Changed(0)
+    WAKE_CV_2 = 0x08, // Changed(1)
+    WAKE_TIMER = 0x10, // The deadline set with WakeIn()
+};
+
 #define HEMISPHERE_HELP_DIGITALS 0
 #define HEMISPHERE_HELP_CVS 1
 #define HEMISPHERE_HELP_OUTS 2
@@ -117,6 +126,7 @@ public:
         // Maintain previous app state by skipping Start
         if (!applet_started) {
             applet_started = true;
+            ForEachChannel(ch) cv_m->Unsubscribe(ch + io_offset);
             Start();
         }
     }
@@ -125,13 +135,9 @@ public:
         master_clock_bus = (master_clock_on && hemisphere == RIGHT_HEMISPHERE);
         ForEachChannel(ch)
         {
-            // Set CV inputs
-            ADC_CHANNEL channel = (ADC_CHANNEL)(ch + io_offset);
-            inputs[ch] = OC::ADC::raw_pitch_value(channel);
-            if (abs(inputs[ch] - last_cv[ch]) > HEMISPHERE_CHANGE_THRESHOLD) {
-                changed_cv[ch] = 1;
-                last_cv[ch] = inputs[ch];
-            } else changed_cv[ch] = 0;
+            // Set CV inputs, conditioned once per reading by the CV input manager
+            inputs[ch] = cv_m->Value(ch + io_offset);
+            changed_cv[ch] = cv_m->Changed(ch + io_offset);
 
             // Handle clock timing
             if (clock_countdown[ch] > 0) {
@@ -142,6 +148,9 @@ public:
         // Cursor countdowns. See CursorBlink(), ResetCursor(), gfxCursor()
         if (--cursor_countdown < -HEMISPHERE_CURSOR_TICKS) cursor_countdown = HEMISPHERE_CURSOR_TICKS;
 
+        // Applets that have opted in with WakeOn() skip ticks without any of their events
+        if (wake_events && !Awake()) return;
+
         Controller();
     }
 
@@ -318,6 +327,33 @@ public:
         return (In(ch) > (HEMISPHERE_CENTER_CV + 64) || In(ch) < (HEMISPHERE_CENTER_CV - 64)) ? In(ch) : HEMISPHERE_CENTER_CV;
     }
 
+    /* Conditioned inputs. Subscribe to the representations you need in Start(), with
+     * SubscribeCV(ch, CV_SMOOTHED | CV_SLOPE), etc. See HSCVInputManager.h */
+    void SubscribeCV(int ch, uint8_t representation) {
+        cv_m->Subscribe(ch + io_offset, representation);
+    }
+
+    // Smoothing for SmoothedIn(); higher is slower, about 2^n readings (of 4 ticks)
+    void SetCVSmoothing(int ch, uint8_t n) {
+        cv_m->SetSmoothing(ch + io_offset, n);
+    }
+
+    // One-pole lowpassed input
+    int SmoothedIn(int ch) {
+        return cv_m->Smoothed(ch + io_offset);
+    }
+
+    // Input at the nearest semitone, which only changes once the input is clearly past
+    // the halfway point
+    int SteppedIn(int ch) {
+        return cv_m->Stepped(ch + io_offset);
+    }
+
+    // Smoothed rate of change of the input, per reading (4 ticks)
+    int SlopeIn(int ch) {
+        return cv_m->Slope(ch + io_offset);
+    }
+
     void Out(int ch, int value, int octave = 0) {
         DAC_CHANNEL channel = (DAC_CHANNEL)(ch + io_offset);
         OC::DAC::set_pitch(channel, value, octave);
@@ -331,21 +367,7 @@ public:
      * not be used.
      */
     bool Clock(int ch, bool physical = 0) {
-        bool clocked = 0;
-        if (hemisphere == 0) {
-            if (ch == 0) clocked = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
-            if (ch == 1) clocked = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_2>();
-        } else if (hemisphere == 1) {
-            if (ch == 0) clocked = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_3>();
-            if (ch == 1) clocked = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_4>();
-        }
-
-        if (ch == 0 && !physical) {
-            ClockManager *clock_m = clock_m->get();
-            if (clock_m->IsRunning()) clocked = clock_m->Tock();
-            else if (master_clock_bus) clocked = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
-        }
-
+        bool clocked = ClockEdge(ch, physical);
         if (clocked) {
         		cycle_ticks[ch] = OC::CORE::ticks - last_clock[ch];
         		last_clock[ch] = OC::CORE::ticks;
@@ -460,6 +482,26 @@ protected:
     /* Master Clock Forwarding is activated. This is updated with each ISR cycle by the Hemisphere Manager */
     bool MasterClockForwarded() {return master_clock_bus;}
 
+    /* Event-driven dispatch: An applet that only has work to do when something happens can call
+     * WakeOn() in Start() with the HemisphereWake events that it cares about. Controller() is then
+     * skipped on ticks without any of them, e.g.
+     *
+     * WakeOn(WAKE_CLOCK_1 | WAKE_CLOCK_2);
+     *
+     * ClockOut() pulses still end on time, and an applet always runs every tick during an ADC lag.
+     * For anything else that's timed, use WAKE_TIMER and WakeIn(), and keep in mind that counting
+     * Controller() calls no longer counts ticks. Wake() runs Controller() on the next tick regardless,
+     * for example after a setting was changed that affects the outputs.
+     */
+    void WakeOn(uint8_t events) {wake_events = events;}
+
+    void WakeIn(uint32_t ticks) {
+        wake_tick = OC::CORE::ticks + ticks;
+        wake_timer_armed = 1;
+    }
+
+    void Wake() {wake_pending = 1;}
+
 private:
     int gfx_offset; // Graphics offset, based on the side
     int io_offset; // Input/Output offset, based on the side
@@ -474,8 +516,72 @@ private:
     bool applet_started; // Allow the app to maintain state during switching
     int last_view_tick; // Tick number of the most recent view
     int help_active;
-    bool changed_cv[2]; // Has the input changed by more than 1/8 semitone since the last read?
-    int last_cv[2]; // For change detection
+    bool changed_cv[2]; // Has the input changed by more than 1/4 semitone since the last read?
+    CVInputManager *cv_m = cv_m->get();
+    uint8_t wake_events; // HemisphereWake events, or 0 to run every tick
+    bool wake_pending; // Run on the next tick regardless of events
+    bool wake_timer_armed;
+    uint32_t wake_tick; // For WAKE_TIMER
+
+    /* Clock() without the side effects, so it can be checked before the applet runs */
+    bool ClockEdge(int ch, bool physical) {
+        bool clocked = 0;
+        if (hemisphere == 0) {
+            if (ch == 0) clocked = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
+            if (ch == 1) clocked = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_2>();
+        } else if (hemisphere == 1) {
+            if (ch == 0) clocked = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_3>();
+            if (ch == 1) clocked = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_4>();
+        }
+
+        if (ch == 0 && !physical) {
+            ClockManager *clock_m = clock_m->get();
+            if (clock_m->IsRunning()) clocked = clock_m->Tock();
+            else if (master_clock_bus) clocked = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
+        }
+        return clocked;
+    }
+
+
+    bool Awake() {
+        if (wake_pending) {
+            wake_pending = 0;
+            return 1;
+        }
+        if (adc_lag_countdown[0] > 0 || adc_lag_countdown[1] > 0) return 1;
+        if ((wake_events & WAKE_CLOCK_1) && (ClockEdge(0, 0) || ClockEdge(0, 1))) return 1;
+        if ((wake_events & WAKE_CLOCK_2) && ClockEdge(1, 0)) return 1;
+        if ((wake_events & WAKE_CV_1) && changed_cv[0]) return 1;
+        if ((wake_events & WAKE_CV_2) && changed_cv[1]) return 1;
+        if ((wake_events & WAKE_TIMER) && wake_timer_armed && static_cast<int32_t>(OC::CORE::ticks - wake_tick) >= 0) {
+            wake_timer_armed = 0;
+            return 1;
+        }
+        return 0;
+    }
 };
 
+////////////////////////////////////////////////////////////////////////////////
+//// Applet Storage
+////////////////////////////////////////////////////////////////////////////////
+namespace HS {
+
+/* Only the two selected applets are resident. Each hemisphere owns an arena sized
+ * for the largest available applet, and HemisphereManager::SetApplet() constructs
+ * the selected applet there (see APP_HEMISPHERE.h).
+ */
+inline void *AppletStorage(bool hemisphere);
+
+/* Stands in for the old static array of two instances, so that the applet
+ * functions can keep saying Euclid_instance[hemisphere].Whatever().
+ */
+template <class T>
+struct AppletInstance {
+    T& operator[](bool hemisphere) {
+        return *static_cast<T*>(AppletStorage(hemisphere));
+    }
+};
+
+}; // namespace HS
+
 #endif // _HEM_APPLET_H_
\ No newline at end of file
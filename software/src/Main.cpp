@@ -29,6 +29,7 @@
 #include "OC_core.h"
 #include "OC_DAC.h"
 #include "OC_debug.h"
+#include "OC_deferred.h"
 #include "OC_gpio.h"
 #include "OC_ADC.h"
 #include "OC_calibration.h"
@@ -37,6 +38,8 @@
 #include "OC_ui.h"
 #include "OC_version.h"
 #include "OC_options.h"
+#include "OC_replay.h"
+#include "OC_trace.h"
 #include "src/drivers/display.h"
 #include "src/drivers/ADC/OC_util_ADC.h"
 #include "util/util_debugpins.h"
@@ -53,6 +56,7 @@ IntervalTimer UI_timer;
 
 void FASTRUN UI_timer_ISR() {
   OC_DEBUG_PROFILE_SCOPE(OC::DEBUG::UI_cycles);
+  OC_TRACE_SCOPE(TRACE_UI_POLL, 0);
   OC::ui.Poll();
   OC_DEBUG_RESET_CYCLES(OC::ui.ticks(), 2048, OC::DEBUG::UI_cycles);
 }
@@ -65,14 +69,25 @@ volatile uint32_t OC::CORE::ticks = 0;
 void FASTRUN CORE_timer_ISR() {
   DEBUG_PIN_SCOPE(OC_GPIO_DEBUG_PIN2);
   OC_DEBUG_PROFILE_SCOPE(OC::DEBUG::ISR_cycles);
+  OC_TRACE_SCOPE(TRACE_CORE_ISR, 0);
 
   // DAC and display share SPI. By first updating the DAC values, then starting
   // a DMA transfer to the display things are fairly nicely interleaved. In the
   // next ISR, the display transfer is finalized (CS update).
 
-  display::Flush();
-  OC::DAC::Update();
-  display::Update();
+  {
+    OC_TRACE_SCOPE(TRACE_DISPLAY_FLUSH, 0);
+    display::Flush();
+  }
+  {
+    OC_DEBUG_PROFILE_SCOPE(OC::DEBUG::DAC_cycles);
+    OC_TRACE_SCOPE(TRACE_DAC_UPDATE, 0);
+    OC::DAC::Update();
+  }
+  {
+    OC_TRACE_SCOPE(TRACE_DISPLAY_UPDATE, 0);
+    display::Update();
+  }
 
   // The ADC scan uses async startSingleRead/readSingle and single channel each
   // loop, so should be fast enough even at 60us (check ADC::busy_waits() == 0)
@@ -80,11 +95,26 @@ void FASTRUN CORE_timer_ISR() {
   // 100us: 10kHz / 4 / 4 ~ .6kHz
   // 60us: 16.666K / 4 / 4 ~ 1kHz
   // kAdcSmoothing == 4 has some (maybe 1-2LSB) jitter but seems "Good Enough".
-  OC::ADC::Scan();
+  {
+    OC_TRACE_SCOPE(TRACE_ADC_SCAN, 0);
+#ifdef OC_INPUT_REPLAY
+    if (!OC::Replay::replaying())
+#endif
+    OC::ADC::Scan();
+  }
 
   // Pin changes are tracked in separate ISRs, so depending on prio it might
   // need extra precautions.
-  OC::DigitalInputs::Scan();
+  {
+    OC_TRACE_SCOPE(TRACE_DIGITAL_INPUTS_SCAN, 0);
+    OC::DigitalInputs::Scan();
+  }
+
+#ifdef OC_INPUT_REPLAY
+  // Waiting for replay data holds the tick, see OC_replay.h
+  if (!OC::Replay::ProcessInputs())
+    return;
+#endif
 
 #ifndef OC_UI_SEPARATE_ISR
   TODO needs a counter
@@ -95,24 +125,45 @@ void FASTRUN CORE_timer_ISR() {
   if (OC::CORE::app_isr_enabled)
     OC::apps::ISR();
 
+#ifdef OC_INPUT_REPLAY
+  OC::Replay::ProcessOutputs();
+#endif
+
   OC_DEBUG_RESET_CYCLES(OC::CORE::ticks, 16384, OC::DEBUG::ISR_cycles);
+  OC_DEBUG_RESET_CYCLES(OC::CORE::ticks, 16384, OC::DEBUG::DAC_cycles);
 }
 
 /*       ---------------------------------------------------------         */
 
 void setup() {
+  OC::DEBUG::MarkBootPhase(OC::DEBUG::BOOT_SETUP);
   Serial.begin(9600); // USB is always 12 Mbit/sec
+#if defined(PRINT_DEBUG) && defined(PRINT_DEBUG_WAIT_SERIAL)
   while (!Serial && (millis ()  <= 3000)) ;
 
   delay(50);
+#endif
   NVIC_SET_PRIORITY(IRQ_PORTB, 0); // TR1 = 0 = PTB16
   SPI_init();
   SERIAL_PRINTLN("* O&C BOOTING...");
   SERIAL_PRINTLN("* %s", OC_VERSION);
 
   OC::DEBUG::Init();
+#ifdef OC_ISR_TRACE
+  OC::Trace::Init();
+#endif
+#ifdef OC_INPUT_REPLAY
+  OC::Replay::Init();
+#endif
   OC::DigitalInputs::Init();
-  delay(400); 
+#ifdef FAST_BOOT
+  // Let the supplies settle after power-up. This used to be a fixed delay on
+  // top of everything else, but the Teensy startup code and the above have
+  // already used up most of it.
+  while (millis() < POWER_SETTLE_MS) { }
+#else
+  delay(POWER_SETTLE_MS);
+#endif
   OC::ADC::Init(&OC::calibration_data.adc); // Yes, it's using the calibration_data before it's loaded...
   OC::DAC::Init(&OC::calibration_data.dac);
 
@@ -124,14 +175,18 @@ void setup() {
   calibration_load();
   
   display::AdjustOffset(OC::calibration_data.display_offset);
+  OC::DEBUG::MarkBootPhase(OC::DEBUG::BOOT_HARDWARE);
 
   OC::menu::Init();
   OC::ui.Init();
   OC::ui.configure_encoders(OC::calibration_data.encoder_config());
 
+  OC::Deferred::Init();
+
   SERIAL_PRINTLN("* CORE ISR @%luus", OC_CORE_TIMER_RATE);
   CORE_timer.begin(CORE_timer_ISR, OC_CORE_TIMER_RATE);
   CORE_timer.priority(OC_CORE_TIMER_PRIO);
+  OC::DEBUG::MarkBootPhase(OC::DEBUG::BOOT_CORE);
 
 #ifdef OC_UI_SEPARATE_ISR
   SERIAL_PRINTLN("* UI ISR @%luus", OC_UI_TIMER_RATE);
@@ -151,6 +206,7 @@ void setup() {
 
   // initialize apps
   OC::apps::Init(reset_settings);
+  OC::DEBUG::MarkBootPhase(OC::DEBUG::BOOT_APPS);
 
 #ifdef VOR
   VBiasManager *vbias_m = vbias_m->get();
@@ -163,6 +219,7 @@ void setup() {
 void FASTRUN loop() {
 
   OC::CORE::app_isr_enabled = true;
+  OC::DEBUG::MarkBootPhase(OC::DEBUG::BOOT_RUNNING);
   uint32_t menu_redraws = 0;
   while (true) {
 
@@ -178,6 +235,7 @@ void FASTRUN loop() {
         if (OC::UI_MODE_MENU == ui_mode) {
           OC_DEBUG_RESET_CYCLES(menu_redraws, 512, OC::DEBUG::MENU_draw_cycles);
           OC_DEBUG_PROFILE_SCOPE(OC::DEBUG::MENU_draw_cycles);
+          OC_TRACE_SCOPE(TRACE_MENU_DRAW, 0);
           OC::apps::current_app->DrawMenu();
           ++menu_redraws;
 
@@ -199,6 +257,15 @@ void FASTRUN loop() {
     // Run current app
     OC::apps::current_app->loop();
 
+    // Work the ISR handed off
+    {
+      OC_TRACE_SCOPE(TRACE_DEFERRED, 0);
+      OC::Deferred::Process();
+    }
+
+    // Trickle any pending settings save out to EEPROM
+    OC::apps::CommitSettings();
+
     // UI events
     OC::UiMode mode = OC::ui.DispatchEvents(OC::apps::current_app);
 
@@ -213,6 +280,13 @@ void FASTRUN loop() {
 
     if (millis() - LAST_REDRAW_TIME > REDRAW_TIMEOUT_MS)
       MENU_REDRAW = 1;
+
+#ifdef OC_ISR_TRACE
+    OC::Trace::Poll();
+#endif
+#ifdef OC_INPUT_REPLAY
+    OC::Replay::Poll();
+#endif
   }
 }
 
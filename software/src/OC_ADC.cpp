@@ -100,6 +100,19 @@ template <> struct ChannelDesc<ADC_CHANNEL_4> {
   scan_channel_ = channel;
 }
 
+#ifdef OC_INPUT_REPLAY
+/*static*/ void ADC::Inject(uint16_t value) {
+  const uint32_t scan_value = value << (kAdcScanResolution - kAdcResolution);
+  switch (scan_channel_) {
+    case ADC_CHANNEL_1: update<ADC_CHANNEL_1>(scan_value); break;
+    case ADC_CHANNEL_2: update<ADC_CHANNEL_2>(scan_value); break;
+    case ADC_CHANNEL_3: update<ADC_CHANNEL_3>(scan_value); break;
+    case ADC_CHANNEL_4: update<ADC_CHANNEL_4>(scan_value); break;
+  }
+  scan_channel_ = (scan_channel_ + 1) % ADC_CHANNEL_LAST;
+}
+#endif
+
 /*static*/ void ADC::CalibratePitch(int32_t c2, int32_t c4) {
   // This is the method used by the Mutable Instruments calibration and
   // extrapolates from two octaves. I guess an alternative would be to get the
@@ -53,6 +53,21 @@ public:
   // ISR timing restrictions.
   static void Scan();
 
+  // Channel that the next Scan updates, i.e. the one before it was updated by
+  // the last Scan
+  static inline size_t scan_channel() {
+    return scan_channel_;
+  }
+
+#ifdef OC_INPUT_REPLAY
+  static inline void set_scan_channel(size_t channel) {
+    scan_channel_ = channel;
+  }
+
+  // Instead of Scan, update the current channel with a recorded raw_value
+  static void Inject(uint16_t value);
+#endif
+
   template <ADC_CHANNEL channel>
   static int32_t value() {
     return calibration_data_->offset[channel] - (smoothed_[channel] >> kAdcValueShift);
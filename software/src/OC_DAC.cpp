@@ -76,6 +76,10 @@ void DAC::Init(CalibrationData *calibration_data) {
   if (F_BUS == 60000000 || F_BUS == 48000000) 
     SPIFIFO.begin(DAC_CS, SPICLOCK_30MHz, SPI_MODE0);  
 
+  updates_ = channels_written_ = 0;
+  for (int channel = DAC_CHANNEL_A; channel < DAC_CHANNEL_LAST; ++channel)
+    written_[channel] = 0xffffffff; // never a valid value, so all get written
+
   set_all(0xffff);
   Update();
 }
@@ -218,6 +222,12 @@ DAC::CalibrationData *DAC::calibration_data_ = nullptr;
 /*static*/
 uint32_t DAC::values_[DAC_CHANNEL_LAST];
 /*static*/
+uint32_t DAC::written_[DAC_CHANNEL_LAST];
+/*static*/
+uint32_t DAC::updates_;
+/*static*/
+uint32_t DAC::channels_written_;
+/*static*/
 uint16_t DAC::history_[DAC_CHANNEL_LAST][DAC::kHistoryDepth];
 /*static*/ 
 volatile size_t DAC::history_tail_;
@@ -289,6 +299,35 @@ void set8565_CHD(uint32_t data) {
   SPIFIFO.read();
 }
 
+// Write the channels in mask back-to-back, and only wait once for the last
+// frame to go out. Nothing useful comes back, so the RX FIFO is just cleared.
+void set8565_channels(const uint32_t *data, uint32_t mask) {
+  static const uint8_t commands[DAC_CHANNEL_LAST] = {
+  #ifdef FLIP_180
+    0b00010110, 0b00010100, 0b00010010, 0b00010000
+  #else
+    0b00010000, 0b00010010, 0b00010100, 0b00010110
+  #endif
+  };
+
+  KINETISK_SPI0.SR = SPI_SR_EOQF;
+  for (int channel = DAC_CHANNEL_A; mask; ++channel, mask >>= 1) {
+    if (!(mask & 1))
+      continue;
+    #ifdef BUCHLA_cOC
+    uint32_t _data = data[channel];
+    #else
+    uint32_t _data = OC::DAC::MAX_VALUE - data[channel];
+    #endif
+    SPIFIFO.write(commands[channel], SPI_CONTINUE);
+    if (mask > 1)
+      SPIFIFO.write16(_data);
+    else
+      SPIFIFO.write16_eoq(_data);
+  }
+  SPIFIFO.wait_eoq();
+}
+
 // adapted from https://github.com/xxxajk/spi4teensy3 (MISO disabled) : 
 
 void SPI_init() {
@@ -12,6 +12,7 @@ extern void set8565_CHA(uint32_t data);
 extern void set8565_CHB(uint32_t data);
 extern void set8565_CHC(uint32_t data);
 extern void set8565_CHD(uint32_t data);
+extern void set8565_channels(const uint32_t *data, uint32_t mask);
 extern void SPI_init();
 
 enum DAC_CHANNEL {
@@ -213,12 +214,21 @@ public:
     return calibration_data_->calibrated_octaves[channel][kOctaveZero + octave];
   }
 
+  // Only channels that changed since the last update are written, in a
+  // single SPI burst.
   static void Update() {
 
-    set8565_CHA(values_[DAC_CHANNEL_A]);
-    set8565_CHB(values_[DAC_CHANNEL_B]);
-    set8565_CHC(values_[DAC_CHANNEL_C]);
-    set8565_CHD(values_[DAC_CHANNEL_D]);
+    uint32_t changed = 0;
+    for (int channel = DAC_CHANNEL_A; channel < DAC_CHANNEL_LAST; ++channel) {
+      if (values_[channel] != written_[channel]) {
+        written_[channel] = values_[channel];
+        changed |= 0x1 << channel;
+        ++channels_written_;
+      }
+    }
+    if (changed)
+      set8565_channels(values_, changed);
+    ++updates_;
 
     size_t tail = history_tail_;
     history_[DAC_CHANNEL_A][tail] = values_[DAC_CHANNEL_A];
@@ -243,9 +253,21 @@ public:
       *dst++ = *src++;
   }
 
+  // Debug stats: the ratio is the average number of channels written per tick
+  static uint32_t updates() {
+    return updates_;
+  }
+
+  static uint32_t channels_written() {
+    return channels_written_;
+  }
+
 private:
   static CalibrationData *calibration_data_;
   static uint32_t values_[DAC_CHANNEL_LAST];
+  static uint32_t written_[DAC_CHANNEL_LAST];
+  static uint32_t updates_;
+  static uint32_t channels_written_;
   static uint16_t history_[DAC_CHANNEL_LAST][kHistoryDepth];
   static volatile size_t history_tail_;
   static uint8_t DAC_scaling[DAC_CHANNEL_LAST];
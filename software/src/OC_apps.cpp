@@ -23,6 +23,7 @@
 #include "OC_apps.h"
 #include "OC_menus.h"
 #include "OC_config.h"
+#include "OC_options.h"
 #include "OC_digital_inputs.h"
 #include "OC_autotune.h"
 #include "util/util_pagestorage.h"
@@ -88,6 +89,11 @@ OC::App available_apps[] = {
 
 static constexpr int NUM_AVAILABLE_APPS = ARRAY_SIZE(available_apps);
 
+// With FAST_BOOT, only the current app is initialized at startup and the rest
+// when they're first selected (or need saving), see init_app
+static bool app_initialized[NUM_AVAILABLE_APPS];
+static bool app_data_loaded = false;
+
 namespace OC {
 
 // Global settings are stored separately to actual app setings.
@@ -135,6 +141,10 @@ GlobalSettingsStorage global_settings_storage;
 AppData app_settings;
 AppDataStorage app_data_storage;
 
+// Writing a whole page to EEPROM takes long enough to stall the UI, so saving
+// only prepares the pages; the main loop then writes a few bytes at a time.
+static constexpr size_t kSettingsCommitBytes = 4;
+
 static constexpr int DEFAULT_APP_INDEX = 0;
 static const uint16_t DEFAULT_APP_ID = available_apps[DEFAULT_APP_INDEX].id;
 
@@ -149,13 +159,68 @@ void save_global_settings() {
   // scaling settings:
   global_settings.DAC_scaling = OC::DAC::store_scaling();
 
-  global_settings_storage.Save(global_settings);
-  SERIAL_PRINTLN("Saved global settings: page_index %d", global_settings_storage.page_index());
+  global_settings_storage.BeginSave(global_settings);
+  SERIAL_PRINTLN("Saving global settings: page_index %d", global_settings_storage.page_index());
+}
+
+static size_t app_chunk_size(const App &app) {
+  size_t storage_size = app.storageSize() + sizeof(AppChunkHeader);
+  if (storage_size & 1) ++storage_size; // Align chunks on 2-byte boundaries
+  return storage_size;
+}
+
+// If the chunks from the last save/restore still describe exactly the apps
+// that need saving, save each app back into its existing chunk. Unchanged
+// apps then leave their bytes alone and only the changed ones end up being
+// written to EEPROM. Otherwise (e.g. after a firmware update, or if something
+// didn't fit last time) the layout has to be rebuilt.
+static bool update_app_data() {
+  char *data = app_settings.data;
+  char *data_end = data + app_settings.used;
+  if (app_settings.used > OC::AppData::kAppDataSize)
+    return false;
+
+  size_t chunks = 0;
+  while (data < data_end) {
+    const AppChunkHeader *chunk = reinterpret_cast<const AppChunkHeader *>(data);
+    const App *app = apps::find(chunk->id);
+    if (!app || !app->Save || data + chunk->length > data_end || chunk->length != app_chunk_size(*app))
+      return false;
+    data += chunk->length;
+    ++chunks;
+  }
+
+  size_t expected_chunks = 0;
+  for (const auto &app : available_apps)
+    if (app_chunk_size(app) > sizeof(AppChunkHeader) && app.Save) ++expected_chunks;
+  if (chunks != expected_chunks)
+    return false;
+
+  data = app_settings.data;
+  while (data < data_end) {
+    AppChunkHeader *chunk = reinterpret_cast<AppChunkHeader *>(data);
+    apps::find(chunk->id)->Save(chunk + 1);
+    data += chunk->length;
+  }
+  return true;
 }
 
+static void init_app(int index);
+
 void save_app_data() {
   SERIAL_PRINTLN("Save app data... (%u bytes available)", OC::AppData::kAppDataSize);
 
+  // Apps that haven't been initialized yet would save their blank state
+  for (int i = 0; i < NUM_AVAILABLE_APPS; ++i)
+    init_app(i);
+
+  if (update_app_data()) {
+    SERIAL_PRINTLN("App settings updated in place: %u/%u", app_settings.used, EEPROM_APPDATA_BINARY_SIZE);
+    app_data_storage.BeginSave(app_settings);
+    SERIAL_PRINTLN("Saving app settings in page_index %d", app_data_storage.page_index());
+    return;
+  }
+
   app_settings.used = 0;
   char *data = app_settings.data;
   char *data_end = data + OC::AppData::kAppDataSize;
@@ -163,8 +228,7 @@ void save_app_data() {
   size_t start_app = random(NUM_AVAILABLE_APPS);
   for (size_t i = 0; i < NUM_AVAILABLE_APPS; ++i) {
     const auto &app = available_apps[(start_app + i) % NUM_AVAILABLE_APPS];
-    size_t storage_size = app.storageSize() + sizeof(AppChunkHeader);
-    if (storage_size & 1) ++storage_size; // Align chunks on 2-byte boundaries
+    size_t storage_size = app_chunk_size(app);
     if (storage_size > sizeof(AppChunkHeader) && app.Save) {
       if (data + storage_size > data_end) {
         SERIAL_PRINTLN("%s: ERROR: %u BYTES NEEDED, %u BYTES AVAILABLE OF %u BYTES TOTAL", app.name, storage_size, data_end - data, AppData::kAppDataSize);
@@ -184,11 +248,12 @@ void save_app_data() {
     }
   }
   SERIAL_PRINTLN("App settings used: %u/%u", app_settings.used, EEPROM_APPDATA_BINARY_SIZE);
-  app_data_storage.Save(app_settings);
-  SERIAL_PRINTLN("Saved app settings in page_index %d", app_data_storage.page_index());
+  app_data_storage.BeginSave(app_settings);
+  SERIAL_PRINTLN("Saving app settings in page_index %d", app_data_storage.page_index());
 }
 
-void restore_app_data() {
+// Restore all apps, or only the given one
+void restore_app_data(const App *only = nullptr) {
   SERIAL_PRINTLN("Restoring app data from page_index %d, used=%u", app_data_storage.page_index(), app_settings.used);
 
   const char *data = app_settings.data;
@@ -210,6 +275,10 @@ void restore_app_data() {
       data += chunk->length;
       continue;
     }
+    if (only && app != only) {
+      data += chunk->length;
+      continue;
+    }
     size_t expected_length = app->storageSize() + sizeof(AppChunkHeader);
     if (expected_length & 0x1) ++expected_length;
     if (chunk->length != expected_length) {
@@ -232,9 +301,21 @@ void restore_app_data() {
   SERIAL_PRINTLN("App data restored: %u, expected %u", restored_bytes, app_settings.used);
 }
 
+static void init_app(int index) {
+  if (app_initialized[index])
+    return;
+
+  App &app = available_apps[index];
+  app.Init();
+  if (app_data_loaded)
+    restore_app_data(&app);
+  app_initialized[index] = true;
+}
+
 namespace apps {
 
 void set_current_app(int index) {
+  init_app(index);
   current_app = &available_apps[index];
   global_settings.current_app_id = current_app->id;
 }
@@ -247,6 +328,16 @@ App *find(uint16_t id) {
   return nullptr;
 }
 
+void CommitSettings() {
+  if (!global_settings_storage.Commit(kSettingsCommitBytes))
+    app_data_storage.Commit(kSettingsCommitBytes);
+}
+
+void FlushSettings() {
+  global_settings_storage.Flush();
+  app_data_storage.Flush();
+}
+
 int index_of(uint16_t id) {
   int i = 0;
   for (const auto &app : available_apps) {
@@ -260,8 +351,17 @@ void Init(bool reset_settings) {
 
   Scales::Init();
   AUTOTUNE::Init();
-  for (auto &app : available_apps)
-    app.Init();
+
+  // Init may run again after a backup restore, so apps initialized from the old
+  // data have to be initialized again before their state is saved over it.
+  memset(app_initialized, 0, sizeof(app_initialized));
+  app_data_loaded = false;
+#ifndef FAST_BOOT
+  for (int i = 0; i < NUM_AVAILABLE_APPS; ++i) {
+    available_apps[i].Init();
+    app_initialized[i] = true;
+  }
+#endif
 
   global_settings.current_app_id = DEFAULT_APP_ID;
   global_settings.encoders_enable_acceleration = OC_ENCODERS_ENABLE_ACCELERATION_DEFAULT;
@@ -315,7 +415,10 @@ void Init(bool reset_settings) {
     if (!app_data_storage.Load(app_settings)) {
       SERIAL_PRINTLN("Data not loaded, using defaults!");
     } else {
+      app_data_loaded = true;
+#ifndef FAST_BOOT
       restore_app_data();
+#endif
     }
   }
 
@@ -332,7 +435,9 @@ void Init(bool reset_settings) {
   set_current_app(current_app_index);
   current_app->HandleAppEvent(APP_EVENT_RESUME);
 
+#ifndef FAST_BOOT
   delay(100);
+#endif
 }
 
 }; // namespace apps
@@ -420,10 +525,12 @@ void Ui::AppSettings() {
     if (save) {
       save_global_settings();
       save_app_data();
-      // draw message:
+      // draw message; whatever isn't written by then is finished from loop()
       int cnt = 0;
-      while(idle_time() < SETTINGS_SAVE_TIMEOUT_MS)
+      while(idle_time() < SETTINGS_SAVE_TIMEOUT_MS) {
+        apps::CommitSettings();
         draw_save_message((cnt++) >> 4);
+      }
     }
   }
 
@@ -25,6 +25,7 @@
 
 #include "UI/ui_events.h"
 #include "util/util_misc.h"
+#include "OC_trace.h"
 
 namespace OC {
 
@@ -74,13 +75,22 @@ namespace apps {
 
   inline void ISR() __attribute__((always_inline));
   inline void ISR() {
-    if (current_app && current_app->isr)
+    if (current_app && current_app->isr) {
+      OC_TRACE_SCOPE(TRACE_APP_ISR, current_app->id);
       current_app->isr();
+    }
   }
 
   App *find(uint16_t id);
   int index_of(uint16_t id);
 
+  // Write the next few bytes of any pending settings save to EEPROM; cheap
+  // enough to call once per loop().
+  void CommitSettings();
+
+  // Finish any pending settings save before returning.
+  void FlushSettings();
+
 }; // namespace apps
 
 }; // namespace OC
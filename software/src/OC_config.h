@@ -30,6 +30,7 @@ static constexpr size_t kMaxTriggerDelayTicks = 96;
 #define OCTAVES 10      // # octaves
 #define SEMITONES (OCTAVES * 12)
 
+static constexpr unsigned long POWER_SETTLE_MS = 400;
 static constexpr unsigned long SPLASHSCREEN_DELAY_MS = 100; // HS deprecates splash screen, but keep a slight delay
 
 static constexpr unsigned long APP_SELECTION_TIMEOUT_MS = 25000;
@@ -48,14 +49,31 @@ static constexpr unsigned long SETTINGS_SAVE_TIMEOUT_MS = 1000;
 #define EEPROM_APPDATA_BINARY_SIZE (1000 - 4)
 
 #define OC_UI_DEBUG
+#ifndef OC_UI_EVENT_QUEUE_DEPTH
+#define OC_UI_EVENT_QUEUE_DEPTH 32 // must be a power of 2
+#endif
 #define OC_UI_SEPARATE_ISR
 
 #define OC_ENCODERS_ENABLE_ACCELERATION_DEFAULT true
 
+// Velocity curve for UI::Event::accelerated, in UI ticks (ms) per detent
+#define OC_ENCODER_VELOCITY_SLOW_TICKS 40
+#define OC_ENCODER_VELOCITY_FAST_TICKS 4
+#define OC_ENCODER_VELOCITY_MAX_MULTIPLIER 32
+
 #define OC_CALIBRATION_DEFAULT_FLAGS (0)
 
 /* ------------ uncomment line below to print boot-up and settings saving/restore info to serial ----- */
 //#define PRINT_DEBUG
+/* ------------ uncomment line below to record an ISR timeline, dumped over USB serial (see OC_trace.h) - */
+//#define OC_ISR_TRACE
+/* ------------ uncomment line below to record/replay input sessions over USB serial (see OC_replay.h) */
+//#define OC_INPUT_REPLAY
+
+#if defined(OC_ISR_TRACE) && defined(OC_INPUT_REPLAY)
+#error "OC_ISR_TRACE and OC_INPUT_REPLAY both poll the USB serial port, enable only one"
+#endif
+
 /* ------------ uncomment line below to enable ASR debug page ---------------------------------------- */
 //#define ASR_DEBUG
 /* ------------ uncomment line below to enable POLYLFO debug page ------------------------------------ */
@@ -1,9 +1,13 @@
 #include <Arduino.h>
 #include "OC_ADC.h"
 #include "OC_config.h"
+#include "OC_DAC.h"
 #include "OC_core.h"
 #include "OC_debug.h"
+#include "OC_deferred.h"
 #include "OC_menus.h"
+#include "OC_replay.h"
+#include "OC_trace.h"
 #include "OC_ui.h"
 #include "util/util_misc.h"
 #include "extern/dspinst.h"
@@ -42,9 +46,12 @@ namespace DEBUG {
   debug::AveragedCycles ISR_cycles;
   debug::AveragedCycles UI_cycles;
   debug::AveragedCycles MENU_draw_cycles;
+  debug::AveragedCycles DAC_cycles;
   uint32_t UI_event_count;
   uint32_t UI_max_queue_depth;
   uint32_t UI_queue_overflow;
+  uint32_t UI_events_coalesced;
+  uint32_t boot_phase_ms[BOOT_PHASE_LAST];
 
   void Init() {
     debug::CycleMeasurement::Init();
@@ -71,13 +78,31 @@ static void debug_menu_core() {
                   debug::cycles_to_us(DEBUG::UI_cycles.value()),
                   debug::cycles_to_us(DEBUG::UI_cycles.max_value()));
 
-#ifdef OC_UI_DEBUG
   graphics.setPrintPos(2, 42);
-  graphics.printf("UI   !%u #%u", DEBUG::UI_queue_overflow, DEBUG::UI_event_count);
+  graphics.printf("JOB %5u %5uus !%u", Deferred::jobs_run(),
+                  Deferred::max_latency() * OC_CORE_TIMER_RATE,
+                  Deferred::overflows());
+
+#ifdef OC_UI_DEBUG
   graphics.setPrintPos(2, 52);
+  graphics.printf("UI !%u ^%u ~%u #%u", DEBUG::UI_queue_overflow,
+                  DEBUG::UI_max_queue_depth, DEBUG::UI_events_coalesced,
+                  DEBUG::UI_event_count);
 #endif
 }
 
+static void debug_menu_boot() {
+  static const char * const phase_names[DEBUG::BOOT_PHASE_LAST] = {
+    "SETUP", "HW", "CORE", "APPS", "RUN"
+  };
+
+  weegfx::coord_t y = 12;
+  for (int phase = 0; phase < DEBUG::BOOT_PHASE_LAST; ++phase, y += 10) {
+    graphics.setPrintPos(2, y);
+    graphics.printf("%-5s %5ums", phase_names[phase], DEBUG::boot_phase_ms[phase]);
+  }
+}
+
 static void debug_menu_gfx() {
   graphics.drawFrame(0, 0, 128, 64);
 
@@ -91,6 +116,20 @@ static void debug_menu_gfx() {
                   debug::cycles_to_us(DEBUG::MENU_draw_cycles.max_value()));
 }
 
+static void debug_menu_dac() {
+  // Too short to show in us
+  graphics.setPrintPos(2, 12);
+  graphics.printf("CYC %4u/%4u/%4u", DEBUG::DAC_cycles.min_value(),
+                  DEBUG::DAC_cycles.value(), DEBUG::DAC_cycles.max_value());
+
+  uint32_t updates = DAC::updates();
+  if (updates) {
+    graphics.setPrintPos(2, 22);
+    graphics.printf("CH/TICK %u.%02u", DAC::channels_written() / updates,
+                    (DAC::channels_written() % updates) * 100 / updates);
+  }
+}
+
 static void debug_menu_adc() {
   graphics.setPrintPos(2, 12);
   graphics.printf("CV1 %5d %5u", ADC::value<ADC_CHANNEL_1>(), ADC::raw_value(ADC_CHANNEL_1));
@@ -110,6 +149,30 @@ static void debug_menu_adc() {
 //      graphics.setPrintPos(2, 52); graphics.print(ADC::fail_flag1());
 }
 
+#ifdef OC_ISR_TRACE
+static void debug_menu_trace() {
+  static const char * const state_names[] = { "REC", "TRIG", "FROZEN" };
+
+  graphics.setPrintPos(2, 12);
+  graphics.printf("%s %u", state_names[Trace::state()], Trace::recorded());
+
+  graphics.setPrintPos(2, 22);
+  graphics.printf("MAX %uus", debug::cycles_to_us(Trace::max_isr_cycles()));
+}
+#endif // OC_ISR_TRACE
+
+#ifdef OC_INPUT_REPLAY
+static void debug_menu_replay() {
+  static const char * const state_names[] = { "IDLE", "REC", "PLAY" };
+
+  graphics.setPrintPos(2, 12);
+  graphics.printf("%s %u", state_names[Replay::state()], Replay::ticks());
+
+  graphics.setPrintPos(2, 22);
+  graphics.printf("LOST %u", Replay::overflows());
+}
+#endif // OC_INPUT_REPLAY
+
 struct DebugMenu {
   const char *title;
   void (*display_fn)();
@@ -117,8 +180,16 @@ struct DebugMenu {
 
 static const DebugMenu debug_menus[] = {
   { " CORE", debug_menu_core },
+  { " BOOT", debug_menu_boot },
   { " GFX", debug_menu_gfx },
+  { " DAC", debug_menu_dac },
   { " ADC", debug_menu_adc },
+#ifdef OC_ISR_TRACE
+  { " TRACE", debug_menu_trace },
+#endif // OC_ISR_TRACE
+#ifdef OC_INPUT_REPLAY
+  { " REPLAY", debug_menu_replay },
+#endif // OC_INPUT_REPLAY
 #ifdef POLYLFO_DEBUG  
   { " POLYLFO", POLYLFO_debug },
 #endif // POLYLFO_DEBUG
@@ -15,10 +15,28 @@ namespace DEBUG {
   extern debug::AveragedCycles ISR_cycles;
   extern debug::AveragedCycles UI_cycles;
   extern debug::AveragedCycles MENU_draw_cycles;
+  extern debug::AveragedCycles DAC_cycles;
 
   extern uint32_t UI_event_count;
   extern uint32_t UI_max_queue_depth;
   extern uint32_t UI_queue_overflow;
+  extern uint32_t UI_events_coalesced;
+
+  // millis() at which each startup phase was completed
+  enum BootPhase {
+    BOOT_SETUP,     // entered setup()
+    BOOT_HARDWARE,  // ADC, DAC, display initialized
+    BOOT_CORE,      // core ISR running, i.e. DAC outputs being updated
+    BOOT_APPS,      // current app initialized and restored
+    BOOT_RUNNING,   // app ISR enabled
+    BOOT_PHASE_LAST
+  };
+
+  extern uint32_t boot_phase_ms[BOOT_PHASE_LAST];
+
+  inline void MarkBootPhase(BootPhase phase) {
+    boot_phase_ms[phase] = millis();
+  }
 };
 
 class DebugPins {
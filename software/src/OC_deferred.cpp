@@ -0,0 +1,70 @@
+#include <Arduino.h>
+#include "OC_deferred.h"
+#include "OC_core.h"
+
+namespace OC {
+
+/*static*/ util::RingBuffer<DeferredJob *, Deferred::kQueueDepth> Deferred::queue_;
+/*static*/ uint32_t Deferred::jobs_run_;
+/*static*/ volatile uint32_t Deferred::overflows_;
+/*static*/ uint32_t Deferred::max_latency_;
+
+/*static*/ void Deferred::Init() {
+  queue_.Init();
+  jobs_run_ = 0;
+  overflows_ = 0;
+  max_latency_ = 0;
+}
+
+/*static*/ bool Deferred::Post(DeferredJob *job) {
+  // Posts from loop() can be interrupted by posts from the ISR
+  uint32_t primask;
+  asm volatile("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+
+  bool posted = true;
+  if (!job->queued_) {
+    if (queue_.writable()) {
+      job->posted_at_ = CORE::ticks;
+      job->queued_ = true;
+      queue_.Write(job);
+    } else {
+      ++overflows_;
+      posted = false;
+    }
+  }
+
+  asm volatile("msr primask, %0" :: "r" (primask) : "memory");
+  return posted;
+}
+
+/*static*/ void Deferred::Process() {
+  size_t pending = queue_.readable();
+  while (pending--) {
+    DeferredJob *job = queue_.Read();
+    job->run_(job->context_);
+
+    uint32_t latency = CORE::ticks - job->posted_at_;
+    job->last_latency_ = latency;
+    if (latency > job->max_latency_) job->max_latency_ = latency;
+    if (latency > max_latency_) max_latency_ = latency;
+    ++jobs_run_;
+
+    job->queued_ = false;
+  }
+}
+
+/*static*/ void Deferred::Cancel(const void *storage, size_t size) {
+  const uint8_t *begin = static_cast<const uint8_t *>(storage);
+  const uint8_t *end = begin + size;
+
+  // Requeue whatever survives
+  size_t pending = queue_.readable();
+  while (pending--) {
+    DeferredJob *job = queue_.Read();
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(job);
+    if (p < begin || p >= end)
+      queue_.Write(job);
+  }
+}
+
+}; // namespace OC
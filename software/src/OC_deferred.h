@@ -0,0 +1,94 @@
+#ifndef OC_DEFERRED_H_
+#define OC_DEFERRED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "util/util_ringbuffer.h"
+
+namespace OC {
+
+// A chunk of bursty, non-realtime work that's posted from the core ISR and run
+// later from loop(), so it doesn't end up next to the DAC update. The job only
+// describes what to call; inputs and results are up to the owner, which
+// typically snapshots its inputs before posting and picks up the result on a
+// later tick (see TB_3PO for an example).
+//
+// A job is in the queue at most once; posting it again before it has run is a
+// no-op.
+class DeferredJob {
+public:
+  typedef void (*RunFn)(void *context);
+
+  void Init(RunFn run, void *context) {
+    run_ = run;
+    context_ = context;
+    queued_ = false;
+    posted_at_ = 0;
+    last_latency_ = max_latency_ = 0;
+  }
+
+  inline bool queued() const {
+    return queued_;
+  }
+
+  // Core ticks from Post to the job having finished
+  inline uint32_t last_latency() const {
+    return last_latency_;
+  }
+
+  inline uint32_t max_latency() const {
+    return max_latency_;
+  }
+
+private:
+  friend class Deferred;
+
+  RunFn run_;
+  void *context_;
+  volatile bool queued_;
+  uint32_t posted_at_;
+  uint32_t last_latency_;
+  uint32_t max_latency_;
+};
+
+class Deferred {
+public:
+  static constexpr size_t kQueueDepth = 8;
+
+  static void Init();
+
+  // Core ISR or loop(). Returns false if the queue is full, in which case the
+  // caller should try again later.
+  static bool Post(DeferredJob *job);
+
+  // loop() only; runs everything that was queued on entry.
+  static void Process();
+
+  // loop() only, with interrupts disabled; drops queued jobs that live in
+  // [storage, storage + size), e.g. before the applet that owns them is
+  // overwritten. Since Process() runs from loop() as well, none of them can be
+  // running at the time.
+  static void Cancel(const void *storage, size_t size);
+
+  static inline uint32_t jobs_run() {
+    return jobs_run_;
+  }
+
+  static inline uint32_t overflows() {
+    return overflows_;
+  }
+
+  static inline uint32_t max_latency() {
+    return max_latency_;
+  }
+
+private:
+  static util::RingBuffer<DeferredJob *, kQueueDepth> queue_;
+  static uint32_t jobs_run_;
+  static volatile uint32_t overflows_;
+  static uint32_t max_latency_;
+};
+
+}; // namespace OC
+
+#endif // OC_DEFERRED_H_
@@ -10,6 +10,14 @@ uint32_t OC::DigitalInputs::clocked_mask_;
 /*static*/
 volatile uint32_t OC::DigitalInputs::clocked_[DIGITAL_INPUT_LAST];
 
+#ifdef OC_INPUT_REPLAY
+/*static*/
+bool OC::DigitalInputs::injecting_;
+
+/*static*/
+uint32_t OC::DigitalInputs::injected_levels_;
+#endif
+
 void FASTRUN tr1_ISR() {  
   OC::DigitalInputs::clock<OC::DIGITAL_INPUT_1>();
 }  // main clock
@@ -54,13 +54,42 @@ public:
   }
 
   template <DigitalInput input> static inline bool read_immediate() {
+#ifdef OC_INPUT_REPLAY
+    if (injecting_) return injected_levels_ & (0x1 << input);
+#endif
     return !digitalReadFast(InputPinDesc<input>::PIN);
   }
 
   static inline bool read_immediate(DigitalInput input) {
+#ifdef OC_INPUT_REPLAY
+    if (injecting_) return injected_levels_ & (0x1 << input);
+#endif
     return !digitalReadFast(InputPinMap(input));
   }
 
+#ifdef OC_INPUT_REPLAY
+  // read_immediate for all inputs, as mask
+  static inline uint32_t levels() {
+    return
+      (read_immediate<DIGITAL_INPUT_1>() ? DIGITAL_INPUT_1_MASK : 0) |
+      (read_immediate<DIGITAL_INPUT_2>() ? DIGITAL_INPUT_2_MASK : 0) |
+      (read_immediate<DIGITAL_INPUT_3>() ? DIGITAL_INPUT_3_MASK : 0) |
+      (read_immediate<DIGITAL_INPUT_4>() ? DIGITAL_INPUT_4_MASK : 0);
+  }
+
+  // After Scan, replace the clocks and levels with recorded ones until
+  // EndInject is called
+  static inline void Inject(uint32_t clocked, uint32_t levels) {
+    clocked_mask_ = clocked;
+    injected_levels_ = levels;
+    injecting_ = true;
+  }
+
+  static inline void EndInject() {
+    injecting_ = false;
+  }
+#endif
+
   template <DigitalInput input> static inline void clock() {
     clocked_[input] = 1;
   }
@@ -80,6 +109,10 @@ private:
 
   static uint32_t clocked_mask_;
   static volatile uint32_t clocked_[DIGITAL_INPUT_LAST];
+#ifdef OC_INPUT_REPLAY
+  static bool injecting_;
+  static uint32_t injected_levels_;
+#endif
 
   template <DigitalInput input>
   static uint32_t ScanInput() {
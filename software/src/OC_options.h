@@ -17,6 +17,10 @@
 //#define NORTHERNLIGHT_2OC_LEFTSIDE
 /* ------------ print debug messages to USB serial --------------------------------------------------  */
 #define PRINT_DEBUG
+/* ------------ uncomment to wait up to 3s at boot for USB serial, so boot messages aren't lost -----  */
+//#define PRINT_DEBUG_WAIT_SERIAL
+/* ------------ boot fast: settle from reset, initialize apps when first selected -------------------  */
+#define FAST_BOOT
 /* ------------ flip screen / IO mapping ------------------------------------------------------------  */
 //#define FLIP_180
 /* ------------ invert screen pixels ----------------------------------------------------------------  */
@@ -0,0 +1,558 @@
+#include <Arduino.h>
+#include "OC_replay.h"
+
+#ifdef OC_INPUT_REPLAY
+
+#include "OC_ADC.h"
+#include "OC_apps.h"
+#include "OC_DAC.h"
+#include "OC_digital_inputs.h"
+#include "OC_ui.h"
+
+// Stream formats; replay_session.py has the matching decoder.
+//
+// Session (recorded by the module, sent back to it for replay), after an
+// 8 byte header "OCRS", u8 version, u8 first ADC scan channel, u16 app id:
+//   00dddddd          one tick, ADC delta d (6 bit zigzag), nothing else changed
+//   1nnnnnnn          n + 1 ticks with nothing changed
+//   01000fea ...      one tick, followed by
+//                     a: ADC delta (zigzag varint), otherwise it's 0
+//                     f: digital inputs (levels | clocked << 4)
+//                     e: UI event (u8 type, varint control, zigzag value,
+//                        varint mask, zigzag accelerated)
+//   01001000          end of session
+//   01010000 n        n ticks were lost (recording overflowed), varint
+// The ADC delta is against the previous value of the same channel; the scan
+// channel advances by one every tick. The digital inputs byte persists until
+// it changes.
+//
+// Outputs (sent by the module while replaying), after an 8 byte header
+// "OCRO", u8 version, u8 channels, u16 app id:
+//   0000mmmm ...      one tick, zigzag varint deltas for the channels in m
+//   1nnnnnnn          n + 1 ticks with no changes
+//   01000000          end
+
+namespace OC {
+
+/*static*/ util::RingBuffer<ReplayTick, Replay::kDepth> Replay::inputs_;
+/*static*/ util::RingBuffer<ReplayOutputs, Replay::kDepth> Replay::outputs_;
+/*static*/ util::RingBuffer<UI::Event, 8> Replay::events_;
+/*static*/ volatile uint8_t Replay::state_;
+/*static*/ volatile uint32_t Replay::ticks_;
+/*static*/ volatile uint32_t Replay::overflows_;
+
+static constexpr uint8_t kReplayVersion = 1;
+static constexpr size_t kReplayHeaderSize = 8;
+static constexpr uint8_t kTickRun = 0x80;
+static constexpr uint8_t kTickFlags = 0x40;
+static constexpr uint8_t kTickAdc = 0x01;
+static constexpr uint8_t kTickDigital = 0x02;
+static constexpr uint8_t kTickEvent = 0x04;
+static constexpr uint8_t kTickEnd = 0x48;
+static constexpr uint8_t kTickGap = 0x50;
+static constexpr uint8_t kOutputsEnd = 0x40;
+static constexpr uint32_t kMaxRun = 128;
+
+namespace {
+
+// Mask interrupts while switching between live and replayed inputs. The host
+// build (see software/host_replay) has no interrupts to mask.
+inline uint32_t DisableInterrupts() {
+#ifdef __arm__
+  uint32_t primask;
+  asm volatile("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+  return primask;
+#else
+  return 0;
+#endif
+}
+
+inline void RestoreInterrupts(uint32_t primask) {
+#ifdef __arm__
+  asm volatile("msr primask, %0" :: "r" (primask) : "memory");
+#else
+  (void)primask;
+#endif
+}
+
+inline uint32_t zigzag(int32_t value) {
+  return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+inline int32_t unzigzag(uint32_t value) {
+  return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+// Batches bytes for Serial.write
+class SerialWriter {
+public:
+  void Init() {
+    length_ = 0;
+  }
+
+  void Put(uint8_t byte) {
+    if (length_ == sizeof(buffer_))
+      Flush();
+    buffer_[length_++] = byte;
+  }
+
+  void PutVarint(uint32_t value) {
+    while (value >= 0x80) {
+      Put(0x80 | (value & 0x7f));
+      value >>= 7;
+    }
+    Put(value);
+  }
+
+  void PutZigzag(int32_t value) {
+    PutVarint(zigzag(value));
+  }
+
+  void PutHeader(const char *magic, uint8_t b0, uint8_t b1, uint16_t id) {
+    for (size_t i = 0; i < 4; ++i)
+      Put(magic[i]);
+    Put(b0);
+    Put(b1);
+    Put(id & 0xff);
+    Put(id >> 8);
+  }
+
+  void Flush() {
+    if (length_) {
+      Serial.write(buffer_, length_);
+      length_ = 0;
+    }
+  }
+
+private:
+  uint8_t buffer_[64];
+  size_t length_;
+};
+
+// Reads from a byte buffer that may end in the middle of a tick
+class TickReader {
+public:
+  TickReader(const uint8_t *data, size_t length) : data_(data), length_(length), pos_(0), ok_(true) { }
+
+  uint8_t Get() {
+    if (pos_ < length_)
+      return data_[pos_++];
+    ok_ = false;
+    return 0;
+  }
+
+  uint32_t GetVarint() {
+    uint32_t value = 0;
+    for (unsigned shift = 0; shift < 32; shift += 7) {
+      uint8_t byte = Get();
+      value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        break;
+    }
+    return value;
+  }
+
+  int32_t GetZigzag() {
+    return unzigzag(GetVarint());
+  }
+
+  bool ok() const {
+    return ok_;
+  }
+
+  size_t consumed() const {
+    return pos_;
+  }
+
+private:
+  const uint8_t *data_;
+  size_t length_;
+  size_t pos_;
+  bool ok_;
+};
+
+struct InputCodec {
+  uint16_t adc[ADC_CHANNEL_LAST];
+  size_t channel;
+  uint8_t digital;
+  uint32_t run;
+
+  void Reset(size_t first_channel) {
+    memset(adc, 0, sizeof(adc));
+    channel = first_channel;
+    digital = 0;
+    run = 0;
+  }
+};
+
+SerialWriter writer;
+InputCodec input_codec;
+bool header_sent;
+bool awaiting_header;
+bool end_received;
+size_t saved_scan_channel;
+uint8_t read_buffer[32];
+size_t read_length;
+uint16_t output_values[DAC_CHANNEL_LAST];
+uint32_t output_run;
+uint32_t lost_ticks;
+
+inline uint16_t current_app_id() {
+  return apps::current_app ? apps::current_app->id : 0;
+}
+
+void FlushInputRun() {
+  if (input_codec.run) {
+    writer.Put(kTickRun | (input_codec.run - 1));
+    input_codec.run = 0;
+  }
+}
+
+void FlushOutputRun() {
+  if (output_run) {
+    writer.Put(kTickRun | (output_run - 1));
+    output_run = 0;
+  }
+}
+
+}; // namespace
+
+/*static*/ void Replay::Init() {
+  inputs_.Init();
+  outputs_.Init();
+  events_.Init();
+  writer.Init();
+  state_ = STATE_IDLE;
+  awaiting_header = false;
+  ticks_ = overflows_ = 0;
+}
+
+/*static*/ bool Replay::ProcessInputs() {
+  switch (state_) {
+    case STATE_RECORDING: {
+      ReplayTick tick;
+      tick.channel = (ADC::scan_channel() + ADC_CHANNEL_LAST - 1) % ADC_CHANNEL_LAST;
+      tick.adc = ADC::raw_value(static_cast<ADC_CHANNEL>(tick.channel));
+      tick.clocked = DigitalInputs::clocked();
+      tick.levels = DigitalInputs::levels();
+      tick.has_event = events_.readable();
+      if (tick.has_event)
+        tick.event = events_.Read();
+      tick.lost = lost_ticks;
+      if (inputs_.writable()) {
+        inputs_.Write(tick);
+        lost_ticks = 0;
+      } else {
+        ++lost_ticks;
+        ++overflows_;
+      }
+      ++ticks_;
+    }
+    break;
+
+    case STATE_REPLAYING: {
+      // Hold the tick rather than run the app without inputs, or drop outputs
+      if (!inputs_.readable() || !outputs_.writable())
+        return false;
+      const ReplayTick tick = inputs_.Read();
+      ADC::Inject(tick.adc);
+      DigitalInputs::Inject(tick.clocked, tick.levels);
+      if (tick.has_event)
+        ui.InjectEvent(tick.event);
+      ++ticks_;
+    }
+    break;
+
+    default: break;
+  }
+  return true;
+}
+
+/*static*/ void Replay::ProcessOutputs() {
+  if (STATE_REPLAYING == state_) {
+    ReplayOutputs outputs;
+    for (size_t i = 0; i < DAC_CHANNEL_LAST; ++i)
+      outputs.values[i] = DAC::value(i);
+    outputs_.Write(outputs);
+  }
+}
+
+/*static*/ bool Replay::FilterEvent(const UI::Event &event) {
+  switch (state_) {
+    case STATE_RECORDING:
+      if (events_.writable())
+        events_.Write(event);
+      return true;
+    case STATE_REPLAYING:
+      return false;
+    default:
+      return true;
+  }
+}
+
+/*static*/ void Replay::Poll() {
+  switch (state_) {
+    case STATE_IDLE:
+      if (awaiting_header) {
+        DecodeInputs();
+      } else if (Serial.available()) {
+        switch (Serial.read()) {
+          case 'r': StartRecording(); break;
+          case 'p': StartReplay(); break;
+          default: break;
+        }
+      }
+      break;
+
+    case STATE_RECORDING:
+      EncodeInputs();
+      if (Serial.available() && 's' == Serial.read())
+        StopRecording();
+      break;
+
+    case STATE_REPLAYING:
+      DecodeInputs();
+      EncodeOutputs();
+      // The ISR that read the last tick has completed, so its outputs are in
+      if (end_received && !inputs_.readable())
+        StopReplay();
+      break;
+  }
+}
+
+/*static*/ void Replay::StartRecording() {
+  inputs_.Init();
+  events_.Init();
+  writer.Init();
+  input_codec.Reset(0);
+  header_sent = false;
+  lost_ticks = 0;
+  ticks_ = overflows_ = 0;
+  state_ = STATE_RECORDING;
+}
+
+/*static*/ void Replay::StopRecording() {
+  state_ = STATE_IDLE;
+  EncodeInputs();
+  if (!header_sent)
+    writer.PutHeader("OCRS", kReplayVersion, ADC::scan_channel(), current_app_id());
+  FlushInputRun();
+  if (lost_ticks) {
+    writer.Put(kTickGap);
+    writer.PutVarint(lost_ticks);
+  }
+  writer.Put(kTickEnd);
+  writer.Flush();
+  Serial.send_now();
+}
+
+/*static*/ void Replay::StartReplay() {
+  read_length = 0;
+  end_received = false;
+  awaiting_header = true;
+}
+
+/*static*/ void Replay::StopReplay() {
+  // The ISR has to see the live inputs and the ADC scan position together
+  uint32_t primask = DisableInterrupts();
+  state_ = STATE_IDLE;
+  DigitalInputs::EndInject();
+  ADC::set_scan_channel(saved_scan_channel);
+  RestoreInterrupts(primask);
+
+  EncodeOutputs();
+  FlushOutputRun();
+  writer.Put(kOutputsEnd);
+  writer.Flush();
+  Serial.send_now();
+}
+
+/*static*/ void Replay::EncodeInputs() {
+  while (inputs_.readable()) {
+    const ReplayTick tick = inputs_.Read();
+
+    if (!header_sent) {
+      writer.PutHeader("OCRS", kReplayVersion, tick.channel, current_app_id());
+      input_codec.channel = tick.channel;
+      header_sent = true;
+    }
+
+    if (tick.lost) {
+      FlushInputRun();
+      writer.Put(kTickGap);
+      writer.PutVarint(tick.lost);
+      input_codec.channel = tick.channel;
+    }
+
+    const int32_t delta = tick.adc - input_codec.adc[input_codec.channel];
+    input_codec.adc[input_codec.channel] = tick.adc;
+    input_codec.channel = (input_codec.channel + 1) % ADC_CHANNEL_LAST;
+
+    const uint8_t digital = tick.levels | (tick.clocked << 4);
+    const bool digital_changed = digital != input_codec.digital;
+    input_codec.digital = digital;
+
+    if (!delta && !digital_changed && !tick.has_event) {
+      if (++input_codec.run == kMaxRun)
+        FlushInputRun();
+      continue;
+    }
+
+    FlushInputRun();
+    if (!digital_changed && !tick.has_event && delta >= -32 && delta < 32) {
+      writer.Put(zigzag(delta));
+    } else {
+      writer.Put(kTickFlags | (delta ? kTickAdc : 0) | (digital_changed ? kTickDigital : 0) | (tick.has_event ? kTickEvent : 0));
+      if (delta)
+        writer.PutZigzag(delta);
+      if (digital_changed)
+        writer.Put(digital);
+      if (tick.has_event) {
+        writer.Put(tick.event.type);
+        writer.PutVarint(tick.event.control);
+        writer.PutZigzag(tick.event.value);
+        writer.PutVarint(tick.event.mask);
+        writer.PutZigzag(tick.event.accelerated);
+      }
+    }
+  }
+  writer.Flush();
+}
+
+/*static*/ void Replay::DecodeInputs() {
+  for (;;) {
+    // Expand runs first, as far as there's room
+    while (input_codec.run && inputs_.writable()) {
+      ReplayTick tick;
+      tick.adc = input_codec.adc[input_codec.channel];
+      input_codec.channel = (input_codec.channel + 1) % ADC_CHANNEL_LAST;
+      tick.levels = input_codec.digital & 0x0f;
+      tick.clocked = input_codec.digital >> 4;
+      tick.has_event = false;
+      tick.lost = 0;
+      inputs_.Write(tick);
+      --input_codec.run;
+    }
+    if (input_codec.run || end_received || !inputs_.writable())
+      return;
+
+    while (read_length < sizeof(read_buffer) && Serial.available())
+      read_buffer[read_length++] = Serial.read();
+
+    if (awaiting_header) {
+      if (read_length < kReplayHeaderSize)
+        return;
+      if (memcmp(read_buffer, "OCRS", 4) || kReplayVersion != read_buffer[4]) {
+        // Not a session; drop it and go back to waiting for commands
+        awaiting_header = false;
+        while (Serial.available()) Serial.read();
+        return;
+      }
+      input_codec.Reset(read_buffer[5] % ADC_CHANNEL_LAST);
+      read_length -= kReplayHeaderSize;
+      memmove(read_buffer, read_buffer + kReplayHeaderSize, read_length);
+
+      inputs_.Init();
+      outputs_.Init();
+      writer.Init();
+      memset(output_values, 0, sizeof(output_values));
+      output_run = 0;
+      writer.PutHeader("OCRO", kReplayVersion, DAC_CHANNEL_LAST, current_app_id());
+      writer.Flush();
+
+      // Don't let the ISR scan the ADC between taking over the scan position
+      // and switching to the recorded inputs
+      uint32_t primask = DisableInterrupts();
+      saved_scan_channel = ADC::scan_channel();
+      ADC::set_scan_channel(input_codec.channel);
+      ticks_ = 0;
+      awaiting_header = false;
+      state_ = STATE_REPLAYING;
+      RestoreInterrupts(primask);
+    }
+
+    if (!read_length)
+      return;
+
+    TickReader reader(read_buffer, read_length);
+    const uint8_t op = reader.Get();
+    bool emit = true;
+    int32_t delta = 0;
+    ReplayTick tick;
+    tick.has_event = false;
+    tick.lost = 0;
+
+    if (op & kTickRun) {
+      input_codec.run = (op & 0x7f) + 1;
+      emit = false;
+    } else if (!(op & kTickFlags)) {
+      delta = unzigzag(op);
+    } else if (kTickEnd == op) {
+      end_received = true;
+      emit = false;
+    } else if (kTickGap == op) {
+      input_codec.channel = (input_codec.channel + reader.GetVarint()) % ADC_CHANNEL_LAST;
+      emit = false;
+    } else {
+      if (op & kTickAdc)
+        delta = reader.GetZigzag();
+      if (op & kTickDigital)
+        input_codec.digital = reader.Get();
+      if (op & kTickEvent) {
+        tick.has_event = true;
+        tick.event.type = static_cast<UI::EventType>(reader.Get());
+        tick.event.control = reader.GetVarint();
+        tick.event.value = reader.GetZigzag();
+        tick.event.mask = reader.GetVarint();
+        tick.event.accelerated = reader.GetZigzag();
+      }
+    }
+
+    if (!reader.ok()) {
+      // Incomplete; wait for more data (a tick is always shorter than the buffer)
+      input_codec.run = 0;
+      return;
+    }
+
+    read_length -= reader.consumed();
+    memmove(read_buffer, read_buffer + reader.consumed(), read_length);
+
+    if (emit) {
+      input_codec.adc[input_codec.channel] += delta;
+      tick.adc = input_codec.adc[input_codec.channel];
+      input_codec.channel = (input_codec.channel + 1) % ADC_CHANNEL_LAST;
+      tick.levels = input_codec.digital & 0x0f;
+      tick.clocked = input_codec.digital >> 4;
+      inputs_.Write(tick);
+    }
+  }
+}
+
+/*static*/ void Replay::EncodeOutputs() {
+  while (outputs_.readable()) {
+    const ReplayOutputs outputs = outputs_.Read();
+    uint8_t mask = 0;
+    for (size_t i = 0; i < DAC_CHANNEL_LAST; ++i)
+      if (outputs.values[i] != output_values[i]) mask |= 0x1 << i;
+
+    if (!mask) {
+      if (++output_run == kMaxRun)
+        FlushOutputRun();
+      continue;
+    }
+
+    FlushOutputRun();
+    writer.Put(mask);
+    for (size_t i = 0; i < DAC_CHANNEL_LAST; ++i) {
+      if (mask & (0x1 << i)) {
+        writer.PutZigzag(outputs.values[i] - output_values[i]);
+        output_values[i] = outputs.values[i];
+      }
+    }
+  }
+  writer.Flush();
+}
+
+}; // namespace OC
+
+#endif // OC_INPUT_REPLAY
@@ -0,0 +1,121 @@
+#ifndef OC_REPLAY_H_
+#define OC_REPLAY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "OC_config.h"
+#include "UI/ui_events.h"
+
+// Input session recording and replay, for regression-testing app output.
+// Only compiled in with OC_INPUT_REPLAY (see OC_config.h).
+//
+// Recording captures, per core tick, the ADC sample that was scanned, the
+// digital input levels and clocks, and UI events, and streams them over USB
+// serial. Replaying feeds a recorded session back in place of the real
+// inputs (the ADC, trigger inputs and controls are ignored meanwhile) and
+// streams the DAC values after each app ISR, so two firmware builds can be
+// compared tick by tick with replay_session.py.
+//
+// The ISR only moves fixed-size tick structs through ring buffers; the
+// (variable length) encoding is done in loop(). If a replay runs out of data
+// the tick is held, i.e. neither CORE::ticks nor the app ISR advance, so the
+// output only depends on the session and not on USB timing.
+//
+// Replay determinism requires starting from the same app and settings as the
+// recording; the session header records the app id to check against.
+//
+// software/host_replay builds this file for the host against mocked drivers,
+// so sessions can also be replayed and compared without a module.
+
+#ifdef OC_INPUT_REPLAY
+
+#include "util/util_ringbuffer.h"
+
+#ifndef OC_INPUT_REPLAY_DEPTH
+#define OC_INPUT_REPLAY_DEPTH 128 // ticks, must be a power of 2
+#endif
+
+namespace OC {
+
+struct ReplayTick {
+  uint16_t adc;      // Raw value >> 4 of the channel scanned this tick
+  uint8_t channel;   // ... and which one that was (recording only)
+  uint8_t clocked;   // DigitalInputs::clocked()
+  uint8_t levels;    // DigitalInputs::levels()
+  bool has_event;
+  UI::Event event;
+  uint32_t lost;     // Ticks dropped before this one (recording only)
+};
+
+struct ReplayOutputs {
+  uint16_t values[4]; // DAC::value
+};
+
+class Replay {
+public:
+  static constexpr size_t kDepth = OC_INPUT_REPLAY_DEPTH;
+
+  enum State {
+    STATE_IDLE,
+    STATE_RECORDING,
+    STATE_REPLAYING
+  };
+
+  static void Init();
+
+  // Core ISR, after the inputs have been scanned. Records them, or replaces
+  // them with the next recorded tick. Returns false if a replay is waiting
+  // for data, in which case the rest of the tick should be skipped.
+  static bool ProcessInputs();
+
+  // Core ISR, after the app ISR
+  static void ProcessOutputs();
+
+  // UI ISR, for each event about to be pushed. Returns false if the event
+  // should be dropped (i.e. while replaying).
+  static bool FilterEvent(const UI::Event &event);
+
+  // loop() only; handles serial commands and moves data between the rings
+  // and USB serial. Commands: 'r' starts a recording, 's' stops it, 'p'
+  // starts a replay, followed by the session data.
+  static void Poll();
+
+  static inline State state() {
+    return static_cast<State>(state_);
+  }
+
+  static inline bool replaying() {
+    return STATE_REPLAYING == state_;
+  }
+
+  static inline uint32_t ticks() {
+    return ticks_;
+  }
+
+  static inline uint32_t overflows() {
+    return overflows_;
+  }
+
+private:
+  static util::RingBuffer<ReplayTick, kDepth> inputs_;
+  static util::RingBuffer<ReplayOutputs, kDepth> outputs_;
+  static util::RingBuffer<UI::Event, 8> events_;
+  static volatile uint8_t state_;
+  static volatile uint32_t ticks_;
+  static volatile uint32_t overflows_;
+
+  static void StartRecording();
+  static void StopRecording();
+  static void StartReplay();
+  static void StopReplay();
+
+  static void EncodeInputs();
+  static void DecodeInputs();
+  static void EncodeOutputs();
+};
+
+}; // namespace OC
+
+#endif // OC_INPUT_REPLAY
+
+#endif // OC_REPLAY_H_
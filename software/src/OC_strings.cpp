@@ -47,7 +47,7 @@ namespace OC {
   };
 
   const char* const integer_sequence_names[] = {
-    "pi", "phi", "eul", "vnEck", "ssdn", "Dress", "PNinf" , "Dsum4", "Dsum5", "CDn2", "Frcti" 
+    "pi", "phi", "eul", "vnEck", "ssdn", "Dress", "PNinf" , "Dsum4", "Dsum5", "CDn2", "Frcti", "tau", "rt2" 
   };     
 
   const char* const integer_sequence_dirs[] = {
@@ -75,31 +75,46 @@ namespace OC {
   "Ignor",  "Honor", 
   };
 
-  const uint8_t pi_digits[kIntSeqLen] =     
- {3,1,4,1,5,9,2,6,5,3,5,8,9,7,9,3,2,3,8,4,6,2,6,4,3,3,8,3,2,7,9,5,0,2,8,8,4,1,9,7,1,6,9,3,9,9,3,7,5,1,0,5,8,2,0,9,7,4,9,4,4,5,9,2,
-  3,0,7,8,1,6,4,0,6,2,8,6,2,0,8,9,9,8,6,2,8,0,3,4,8,2,5,3,4,2,1,1,7,0,6,7,9,8,2,1,4,8,0,8,6,5,1,3,2,8,2,3,0,6,6,4,7,0,9,3,8,4,4,6} ;
-//  0,9,5,5,0,5,8,2,2,3,1,7,2,5,3,5,9,4,0,8,1,2,8,4,8,1,1,1,7,4,5,0,2,8,4,1,0,2,7,0,1,9,3,8,5,2,1,1,0,5,5,5,9,6,4,4,6,2,2,9,4,8,9,5,
-//  4,9,3,0,3,8,1,9,6,4,4,2,8,8,1,0,9,7,5,6,6,5,9,3,3,4,4,6,1,2,8,4,7,5,6,4,8,2,3,3,7,8,6,7,8,3,1,6,5,2,7,1,2,0,1,9,0,9,1,4,5,6,4};
-
- const uint8_t phi_digits[kIntSeqLen] =    {1,6,1,8,0,3,3,9,8,8,7,4,9,8,9,4,8,4,8,2,0,4,5,8,6,8,3,4,3,6,5,6,3,8,1,1,7,7,2,0,3,0,9,1,7,9,8,0,5,7,6,2,8,6,2,
- 1,3,5,4,4,8,6,2,2,7,0,5,2,6,0,4,6,2,8,1,8,9,0,2,4,4,9,7,0,7,2,0,7,2,0,4,1,8,9,3,9,1,1,3,7,4,8,4,7,5,4,0,8,8,0,7,5,3,8,6,8,9,1,7,5,2,1,2};
-//  6,6,3,3,8,6,2,2,2,3,5,3,6,9,3,1,7,9,3,1,8,0,0,6,0,7,6,6,7,2,6,3,5,4,4,3,3,3,8,9,0,8,6,5,9,5,9,3,9,5,8,2,9,0,5,6,3,8,3,2,2,6,6,1,3,1,9,9,
-//  2,8,2,9,0,2,6,7,8,8,0,6,7,5,2,0,8,7,6,6,8,9,2,5,0,1,7,1,1,6,9,6,2,0,7,0,3,2,2,2,1,0,4,3,2,1,6,2,6,9,5,4,8,6,2,6,2,9,6,3,1,3,6,1};
-    
-//  const uint8_t tau_digits[256] =    {6,2,8,3,1,8,5,3,0,7,1,7,9,5,8,6,4,7,6,9,2,5,2,8,6,7,6,6,5,5,9,0,0,5,7,6,8,3,9,4,3,3,8,7,9,8,7,5,0,2,1,1,6,4,1,
-//  9,4,9,8,8,9,1,8,4,6,1,5,6,3,2,8,1,2,5,7,2,4,1,7,9,9,7,2,5,6,0,6,9,6,5,0,6,8,4,2,3,4,1,3,5,9,6,4,2,9,6,1,7,3,0,2,6,5,6,4,6,1,3,2,9,4,1,8,
-//  7,6,8,9,2,1,9,1,0,1,1,6,4,4,6,3,4,5,0,7,1,8,8,1,6,2,5,6,9,6,2,2,3,4,9,0,0,5,6,8,2,0,5,4,0,3,8,7,7,0,4,2,2,1,1,1,1,9,2,8,9,2,4,5,8,9,7,9,
-//  0,9,8,6,0,7,6,3,9,2,8,8,5,7,6,2,1,9,5,1,3,3,1,8,6,6,8,9,2,2,5,6,9,5,1,2,9,6,4,6,7,5,7,3,5,6,6,3,3,0,5,4,2,4,0,3,8,1,8,2,9,1,2,9};
-
- const uint8_t eul_digits[kIntSeqLen] =    {2,7,1,8,2,8,1,8,2,8,4,5,9,0,4,5,2,3,5,3,6,0,2,8,7,4,7,1,3,5,2,6,6,2,4,9,7,7,5,7,2,4,7,0,9,3,6,9,9,9,5,9,5,7,4,
- 9,6,6,9,6,7,6,2,7,7,2,4,0,7,6,6,3,0,3,5,3,5,4,7,5,9,4,5,7,1,3,8,2,1,7,8,5,2,5,1,6,6,4,2,7,4,2,7,4,6,6,3,9,1,9,3,2,0,0,3,0,5,9,9,2,1,8,1};
-//  7,4,1,3,5,9,6,6,2,9,0,4,3,5,7,2,9,0,0,3,3,4,2,9,5,2,6,0,5,9,5,6,3,0,7,3,8,1,3,2,3,2,8,6,2,7,9,4,3,4,9,0,7,6,3,2,3,3,8,2,9,8,8,0,7,5,3,1,
-//  9,5,2,5,1,0,1,9,0,1,1,5,7,3,8,3,4,1,8,7,9,3,0,7,0,2,1,5,4,0,8,9,1,4,9,9,3,4,8,8,4,1,6,7,5,0,9,2,4,4,7,6,1,4,6,0,6,6,8,0,8,2,2,6};
-//
-//  const uint8_t rt2_digits[256] =    {1,4,1,4,2,1,3,5,6,2,3,7,3,0,9,5,0,4,8,8,0,1,6,8,8,7,2,4,2,0,9,6,9,8,0,7,8,5,6,9,6,7,1,8,7,5,3,7,6,9,4,8,0,7,3,
-//  1,7,6,6,7,9,7,3,7,9,9,0,7,3,2,4,7,8,4,6,2,1,0,7,0,3,8,8,5,0,3,8,7,5,3,4,3,2,7,6,4,1,5,7,2,7,3,5,0,1,3,8,4,6,2,3,0,9,1,2,2,9,7,0,2,4,9,2,
-//  4,8,3,6,0,5,5,8,5,0,7,3,7,2,1,2,6,4,4,1,2,1,4,9,7,0,9,9,9,3,5,8,3,1,4,1,3,2,2,2,6,6,5,9,2,7,5,0,5,5,9,2,7,5,5,7,9,9,9,5,0,5,0,1,1,5,2,7,
-//  8,2,0,6,0,5,7,1,4,7,0,1,0,9,5,5,9,9,7,1,6,0,5,9,7,0,2,7,4,5,3,4,5,9,6,8,6,2,0,1,4,7,2,8,5,1,7,4,1,8,6,4,0,8,8,9,1,9,8,6,0,9,5,5};
+  // Decimal digit sequences, packed two digits per byte (see digit())
+  // 3.14159...
+  const uint8_t pi_digits[kIntSeqLen / 2] = {
+    0x13, 0x14, 0x95, 0x62, 0x35, 0x85, 0x79, 0x39, 0x32, 0x48, 0x26, 0x46, 0x33, 0x38, 0x72, 0x59,
+    0x20, 0x88, 0x14, 0x79, 0x61, 0x39, 0x99, 0x73, 0x15, 0x50, 0x28, 0x90, 0x47, 0x49, 0x54, 0x29,
+    0x03, 0x87, 0x61, 0x04, 0x26, 0x68, 0x02, 0x98, 0x89, 0x26, 0x08, 0x43, 0x28, 0x35, 0x24, 0x11,
+    0x07, 0x76, 0x89, 0x12, 0x84, 0x80, 0x56, 0x31, 0x82, 0x32, 0x60, 0x46, 0x07, 0x39, 0x48, 0x64
+  };
+
+  // 1.61803...
+  const uint8_t phi_digits[kIntSeqLen / 2] = {
+    0x61, 0x81, 0x30, 0x93, 0x88, 0x47, 0x89, 0x49, 0x48, 0x28, 0x40, 0x85, 0x86, 0x43, 0x63, 0x65,
+    0x83, 0x11, 0x77, 0x02, 0x03, 0x19, 0x97, 0x08, 0x75, 0x26, 0x68, 0x12, 0x53, 0x44, 0x68, 0x22,
+    0x07, 0x25, 0x06, 0x64, 0x82, 0x81, 0x09, 0x42, 0x94, 0x07, 0x27, 0x70, 0x02, 0x14, 0x98, 0x93,
+    0x11, 0x73, 0x84, 0x74, 0x45, 0x80, 0x08, 0x57, 0x83, 0x86, 0x19, 0x57, 0x12, 0x02, 0x00, 0x00
+  };
+
+  // 6.28318...
+  const uint8_t tau_digits[kIntSeqLen / 2] = {
+    0x26, 0x38, 0x81, 0x35, 0x70, 0x71, 0x59, 0x68, 0x74, 0x96, 0x52, 0x82, 0x76, 0x66, 0x55, 0x09,
+    0x50, 0x67, 0x38, 0x49, 0x33, 0x78, 0x89, 0x57, 0x20, 0x11, 0x46, 0x91, 0x94, 0x88, 0x19, 0x48,
+    0x16, 0x65, 0x23, 0x18, 0x52, 0x27, 0x14, 0x97, 0x79, 0x52, 0x06, 0x96, 0x56, 0x60, 0x48, 0x32,
+    0x14, 0x53, 0x69, 0x24, 0x69, 0x71, 0x03, 0x62, 0x65, 0x64, 0x31, 0x92, 0x14, 0x78, 0x86, 0x29
+  };
+
+  // 2.71828...
+  const uint8_t eul_digits[kIntSeqLen / 2] = {
+    0x72, 0x81, 0x82, 0x81, 0x82, 0x54, 0x09, 0x54, 0x32, 0x35, 0x06, 0x82, 0x47, 0x17, 0x53, 0x62,
+    0x26, 0x94, 0x77, 0x75, 0x42, 0x07, 0x39, 0x96, 0x99, 0x95, 0x75, 0x94, 0x66, 0x69, 0x67, 0x72,
+    0x27, 0x04, 0x67, 0x36, 0x30, 0x35, 0x45, 0x57, 0x49, 0x75, 0x31, 0x28, 0x71, 0x58, 0x52, 0x61,
+    0x46, 0x72, 0x24, 0x47, 0x66, 0x93, 0x91, 0x23, 0x00, 0x03, 0x95, 0x29, 0x81, 0x01, 0x00, 0x00
+  };
+
+  // 1.41421...
+  const uint8_t rt2_digits[kIntSeqLen / 2] = {
+    0x41, 0x41, 0x12, 0x53, 0x26, 0x73, 0x03, 0x59, 0x40, 0x88, 0x10, 0x86, 0x78, 0x42, 0x02, 0x69,
+    0x89, 0x70, 0x58, 0x96, 0x76, 0x81, 0x57, 0x73, 0x96, 0x84, 0x70, 0x13, 0x67, 0x76, 0x79, 0x73,
+    0x99, 0x70, 0x23, 0x74, 0x48, 0x26, 0x01, 0x07, 0x83, 0x58, 0x30, 0x78, 0x35, 0x34, 0x72, 0x46,
+    0x51, 0x27, 0x37, 0x05, 0x31, 0x48, 0x26, 0x03, 0x19, 0x22, 0x79, 0x20, 0x94, 0x42, 0x38, 0x06
+  };
 
   // van Eck sequence - generated using Python code found at https://oeis.org/A181391
     const uint8_t van_eck[kIntSeqLen] =       {0,0,1,0,2,0,2,2,1,6,0,5,0,2,6,5,4,0,5,3,0,3,2,9,0,4,9,3,6,14,0,6,3,5,15,0,5,3,5,2,17,0,6,11,
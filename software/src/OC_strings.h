@@ -36,11 +36,11 @@ namespace OC {
     extern const char* const reset_behaviours[];
     extern const char* const falling_gate_behaviours[];
     // Not strings but are constant integer sequences
-    extern const uint8_t pi_digits[kIntSeqLen];
-    extern const uint8_t phi_digits[kIntSeqLen];
-    // extern const uint8_t tau_digits[kIntSeqLen];
-    extern const uint8_t eul_digits[kIntSeqLen];
-    // extern const uint8_t rt2_digits[kIntSeqLen];
+    extern const uint8_t pi_digits[kIntSeqLen / 2];
+    extern const uint8_t phi_digits[kIntSeqLen / 2];
+    extern const uint8_t tau_digits[kIntSeqLen / 2];
+    extern const uint8_t eul_digits[kIntSeqLen / 2];
+    extern const uint8_t rt2_digits[kIntSeqLen / 2];
     extern const uint8_t van_eck[kIntSeqLen];
     extern const uint8_t sum_of_squares_of_digits_of_n[kIntSeqLen];
     // extern const uint8_t digsum_of_n[kIntSeqLen];
@@ -48,6 +48,11 @@ namespace OC {
     extern const uint8_t digsum_of_n_base5[kIntSeqLen];
     extern const uint8_t count_down_by_2[kIntSeqLen];
     extern const uint8_t interspersion_of_A163253[kIntSeqLen];
+
+    // Digit tables are packed two digits per byte, low nibble first
+    inline uint8_t digit(const uint8_t *digits, int index) {
+      return (digits[index >> 1] >> ((index & 1) << 2)) & 0x0f;
+    }
  };
 
   // Not a string, but needs to be closer to trigger_delay_times
@@ -0,0 +1,136 @@
+#include <Arduino.h>
+#include "OC_trace.h"
+
+#ifdef OC_ISR_TRACE
+
+#include "util/util_crc32.h"
+
+namespace OC {
+
+/*static*/ TraceRecord Trace::records_[Trace::kDepth];
+/*static*/ volatile uint32_t Trace::recorded_;
+/*static*/ volatile uint32_t Trace::remaining_;
+/*static*/ volatile uint32_t Trace::trigger_index_;
+/*static*/ volatile uint8_t Trace::state_;
+/*static*/ uint32_t Trace::trigger_cycles_;
+/*static*/ uint32_t Trace::max_isr_cycles_;
+
+// Dump header; all fields little-endian
+struct TraceHeader {
+  char magic[4];           // "OCTR"
+  uint16_t version;
+  uint16_t record_size;
+  uint32_t f_cpu;
+  uint32_t core_timer_rate; // us
+  uint32_t trigger_cycles;
+  uint32_t trigger_index;   // into the dumped records, 0xffffffff if not triggered
+  uint32_t count;           // records that follow, oldest first; then CRC32 of everything
+};
+
+static constexpr uint16_t kTraceVersion = 1;
+static constexpr uint32_t kNotTriggered = 0xffffffff;
+
+/*static*/ void Trace::Init() {
+  // Default to ticks that use most of the ISR period
+  trigger_cycles_ = (F_CPU / 1000000) * OC_CORE_TIMER_RATE * 3 / 4;
+  Rearm();
+}
+
+/*static*/ void Trace::Rearm() {
+  uint32_t primask;
+  asm volatile("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+  recorded_ = 0;
+  remaining_ = 0;
+  trigger_index_ = kNotTriggered;
+  max_isr_cycles_ = 0;
+  state_ = STATE_RECORDING;
+  asm volatile("msr primask, %0" :: "r" (primask) : "memory");
+}
+
+/*static*/ uint32_t Trace::Record(uint8_t event, uint8_t flags, uint16_t arg) {
+  uint32_t primask;
+  asm volatile("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+  const uint32_t cycles = ARM_DWT_CYCCNT;
+  if (STATE_FROZEN != state_) {
+    TraceRecord &record = records_[recorded_ & (kDepth - 1)];
+    record.cycles = cycles;
+    record.arg = arg;
+    record.event = event;
+    record.flags = flags;
+    ++recorded_;
+    if (STATE_TRIGGERED == state_ && !--remaining_)
+      state_ = STATE_FROZEN;
+  }
+  asm volatile("msr primask, %0" :: "r" (primask) : "memory");
+  return cycles;
+}
+
+/*static*/ void Trace::Exit(uint8_t event, uint16_t arg, uint32_t start_cycles) {
+  const uint32_t cycles = Record(event, TRACE_EXIT, arg);
+
+  if (TRACE_CORE_ISR == event) {
+    const uint32_t duration = cycles - start_cycles;
+    if (duration > max_isr_cycles_) max_isr_cycles_ = duration;
+    // Only the core ISR writes these, and it isn't preempted by anything traced
+    if (STATE_RECORDING == state_ && duration > trigger_cycles_) {
+      trigger_index_ = recorded_ - 1;
+      remaining_ = kDepth / 2;
+      state_ = STATE_TRIGGERED;
+    }
+  }
+}
+
+/*static*/ void Trace::Poll() {
+  if (!Serial.available())
+    return;
+
+  switch (Serial.read()) {
+    case 'd': Dump(); Rearm(); break;
+    case 'f': Freeze(); break;
+    case 'r': Rearm(); break;
+    default: break;
+  }
+}
+
+/*static*/ void Trace::Dump() {
+  // Stop recording so the ring doesn't change underneath the (slow) transfer
+  Freeze();
+
+  const uint32_t recorded = recorded_;
+  const uint32_t count = recorded < kDepth ? recorded : kDepth;
+  const uint32_t first = recorded - count;
+
+  TraceHeader header;
+  memcpy(header.magic, "OCTR", 4);
+  header.version = kTraceVersion;
+  header.record_size = sizeof(TraceRecord);
+  header.f_cpu = F_CPU;
+  header.core_timer_rate = OC_CORE_TIMER_RATE;
+  header.trigger_cycles = trigger_cycles_;
+  header.trigger_index = kNotTriggered;
+  if (kNotTriggered != trigger_index_ && trigger_index_ >= first)
+    header.trigger_index = trigger_index_ - first;
+  header.count = count;
+
+  util::CRC32 crc;
+  crc.Update(&header, sizeof(header));
+  Serial.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+
+  // Oldest first, i.e. from the wrap point
+  const size_t start = first & (kDepth - 1);
+  const size_t tail = count < kDepth - start ? count : kDepth - start;
+  crc.Update(&records_[start], tail * sizeof(TraceRecord));
+  Serial.write(reinterpret_cast<const uint8_t *>(&records_[start]), tail * sizeof(TraceRecord));
+  if (count > tail) {
+    crc.Update(&records_[0], (count - tail) * sizeof(TraceRecord));
+    Serial.write(reinterpret_cast<const uint8_t *>(&records_[0]), (count - tail) * sizeof(TraceRecord));
+  }
+
+  const uint32_t value = crc.value();
+  Serial.write(reinterpret_cast<const uint8_t *>(&value), sizeof(value));
+  Serial.send_now();
+}
+
+}; // namespace OC
+
+#endif // OC_ISR_TRACE
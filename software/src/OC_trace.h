@@ -0,0 +1,146 @@
+#ifndef OC_TRACE_H_
+#define OC_TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "OC_config.h"
+
+// Timeline of ISR phases, app/applet ISRs and UI events, for chasing the rare
+// long ticks that averaged cycle counts hide. Only compiled in with
+// OC_ISR_TRACE (see OC_config.h); otherwise the OC_TRACE_* macros are empty.
+//
+// Records go into a ring that is overwritten continuously until a core ISR
+// takes longer than the trigger threshold. Recording then continues for half
+// the ring and stops, so the dump has the slow tick with context on both
+// sides. The dump is requested over USB serial and decoded on the host with
+// decode_isr_trace.py, which also documents the binary format.
+
+#ifdef OC_ISR_TRACE
+
+#ifndef OC_ISR_TRACE_DEPTH
+#define OC_ISR_TRACE_DEPTH 512 // records, must be a power of 2
+#endif
+
+namespace OC {
+
+// Keep in sync with EVENT_NAMES in decode_isr_trace.py
+enum TraceEvent {
+  TRACE_CORE_ISR,
+  TRACE_DISPLAY_FLUSH,
+  TRACE_DAC_UPDATE,
+  TRACE_DISPLAY_UPDATE,
+  TRACE_ADC_SCAN,
+  TRACE_DIGITAL_INPUTS_SCAN,
+  TRACE_APP_ISR,        // arg = App::id
+  TRACE_APPLET_ISR,     // arg = hemisphere << 8 | applet id
+  TRACE_UI_POLL,
+  TRACE_UI_EVENT,       // arg = control << 8 | UI::EventType
+  TRACE_MENU_DRAW,
+  TRACE_DEFERRED,
+  TRACE_EVENT_LAST
+};
+
+enum TraceFlags {
+  TRACE_ENTER = 0,
+  TRACE_EXIT = 1,
+  TRACE_INSTANT = 2
+};
+
+struct TraceRecord {
+  uint32_t cycles; // ARM_DWT_CYCCNT
+  uint16_t arg;
+  uint8_t event;
+  uint8_t flags;
+};
+
+class Trace {
+public:
+  static constexpr size_t kDepth = OC_ISR_TRACE_DEPTH;
+  static_assert(!(kDepth & (kDepth - 1)), "OC_ISR_TRACE_DEPTH must be a power of 2");
+
+  enum State {
+    STATE_RECORDING,
+    STATE_TRIGGERED,
+    STATE_FROZEN
+  };
+
+  static void Init();
+
+  // Any context. The timestamp is taken and the ring position claimed with
+  // interrupts disabled, so records are always in time order. Returns the
+  // timestamp.
+  static uint32_t Record(uint8_t event, uint8_t flags, uint16_t arg);
+
+  static void Exit(uint8_t event, uint16_t arg, uint32_t start_cycles);
+
+  // loop() only. Serial commands: 'd' dumps (and re-arms), 'f' freezes,
+  // 'r' re-arms.
+  static void Poll();
+
+  static void Dump();
+  static void Rearm();
+
+  static inline void Freeze() {
+    state_ = STATE_FROZEN;
+  }
+
+  // Core ISRs longer than this (in cycles) trigger the capture
+  static inline void set_trigger_cycles(uint32_t cycles) {
+    trigger_cycles_ = cycles;
+  }
+
+  static inline State state() {
+    return static_cast<State>(state_);
+  }
+
+  static inline uint32_t recorded() {
+    return recorded_;
+  }
+
+  static inline uint32_t max_isr_cycles() {
+    return max_isr_cycles_;
+  }
+
+private:
+  static TraceRecord records_[kDepth];
+  static volatile uint32_t recorded_;
+  static volatile uint32_t remaining_;
+  static volatile uint32_t trigger_index_;
+  static volatile uint8_t state_;
+  static uint32_t trigger_cycles_;
+  static uint32_t max_isr_cycles_;
+};
+
+class TraceScope {
+public:
+  TraceScope(uint8_t event, uint16_t arg)
+  : event_(event), arg_(arg) {
+    start_ = Trace::Record(event_, TRACE_ENTER, arg_);
+  }
+
+  ~TraceScope() {
+    Trace::Exit(event_, arg_, start_);
+  }
+
+private:
+  uint32_t start_;
+  uint8_t event_;
+  uint16_t arg_;
+};
+
+}; // namespace OC
+
+#define OC_TRACE_SCOPE(event, arg) \
+  OC::TraceScope trace_scope(OC::event, arg)
+
+#define OC_TRACE_EVENT(event, arg) \
+  OC::Trace::Record(OC::event, OC::TRACE_INSTANT, arg)
+
+#else
+
+#define OC_TRACE_SCOPE(event, arg) do { } while (0)
+#define OC_TRACE_EVENT(event, arg) do { } while (0)
+
+#endif // OC_ISR_TRACE
+
+#endif // OC_TRACE_H_
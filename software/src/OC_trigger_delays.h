@@ -24,11 +24,12 @@
 #ifndef OC_TRIGGER_DELAYS_H_
 #define OC_TRIGGER_DELAYS_H_
 
+#include <string.h>
 #include "OC_digital_inputs.h"
-#include "util/util_trigger_delay.h"
 
 namespace OC {
 
+// Delays for all the digital inputs, sharing one ring of trigger masks
 template <uint32_t max_delay>
 class TriggerDelays {
 public:
@@ -36,28 +37,29 @@ public:
   ~TriggerDelays() { }
 
   void Init() {
-    for (auto &d : delays_)
-      d.Init();
+    memset(slots_, 0, sizeof(slots_));
+    head_ = 0;
   }
 
   uint32_t Process(uint32_t trigger_mask, uint32_t delay_ticks) {
-    uint32_t triggered = 0;
-    uint32_t mask = 0x1;
-    for (auto &d : delays_) {
-      d.Update();
-      if (trigger_mask & mask)
-        d.Push(delay_ticks);
-      if (d.triggered())
-        triggered |= mask;
-      mask <<= 1;
-    }
-    return triggered;
+    slots_[head_] = 0;
+    head_ = (head_ + 1) & (kSlots - 1);
+    trigger_mask &= (0x1 << DIGITAL_INPUT_LAST) - 1;
+    if (trigger_mask)
+      slots_[(head_ + delay_ticks) & (kSlots - 1)] |= trigger_mask;
+    return slots_[head_];
   }
 
 protected:
 
-  util::TriggerDelay<max_delay> delays_[DIGITAL_INPUT_LAST];
+  static constexpr uint32_t ring_size(uint32_t size) {
+    return size > max_delay ? size : ring_size(size << 1);
+  }
+
+  static constexpr uint32_t kSlots = ring_size(1);
 
+  uint8_t slots_[kSlots];
+  uint32_t head_;
 };
 
 }; // namespace OC
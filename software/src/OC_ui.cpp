@@ -12,6 +12,7 @@
 #include "OC_ui.h"
 #include "OC_version.h"
 #include "OC_options.h"
+#include "OC_trace.h"
 #include "src/drivers/display.h"
 
 #ifdef VOR
@@ -46,6 +47,8 @@ void Ui::Init() {
 
   encoder_right_.Init(OC_GPIO_ENC_PINMODE);
   encoder_left_.Init(OC_GPIO_ENC_PINMODE);
+  encoder_right_.set_velocity_curve(OC_ENCODER_VELOCITY_SLOW_TICKS, OC_ENCODER_VELOCITY_FAST_TICKS, OC_ENCODER_VELOCITY_MAX_MULTIPLIER);
+  encoder_left_.set_velocity_curve(OC_ENCODER_VELOCITY_SLOW_TICKS, OC_ENCODER_VELOCITY_FAST_TICKS, OC_ENCODER_VELOCITY_MAX_MULTIPLIER);
 
   event_queue_.Init();
 }
@@ -103,11 +106,11 @@ void FASTRUN Ui::Poll() {
   int32_t increment;
   increment = encoder_right_.Read();
   if (increment)
-    PushEvent(UI::EVENT_ENCODER, CONTROL_ENCODER_R, increment, button_state);
+    PushEvent(UI::EVENT_ENCODER, CONTROL_ENCODER_R, increment, button_state, encoder_right_.accelerated());
 
   increment = encoder_left_.Read();
   if (increment)
-    PushEvent(UI::EVENT_ENCODER, CONTROL_ENCODER_L, increment, button_state);
+    PushEvent(UI::EVENT_ENCODER, CONTROL_ENCODER_L, increment, button_state, encoder_left_.accelerated());
 
   button_state_ = button_state;
 }
@@ -119,6 +122,8 @@ UiMode Ui::DispatchEvents(App *app) {
     if (IgnoreEvent(event))
       continue;
 
+    OC_TRACE_EVENT(TRACE_UI_EVENT, (event.control << 8) | event.type);
+
     switch (event.type) {
       case UI::EVENT_BUTTON_PRESS:
         #ifdef VOR
@@ -7,6 +7,7 @@
 #include "UI/ui_button.h"
 #include "UI/ui_encoder.h"
 #include "UI/ui_event_queue.h"
+#include "OC_replay.h"
 
 namespace OC {
 
@@ -56,7 +57,7 @@ enum UiMode {
 
 class Ui {
 public:
-  static const size_t kEventQueueDepth = 16;
+  static const size_t kEventQueueDepth = OC_UI_EVENT_QUEUE_DEPTH;
   static const uint32_t kLongPressTicks = 1000;
 
   Ui() { }
@@ -119,6 +120,13 @@ public:
 
   void set_screensaver_timeout(uint32_t seconds);
 
+#ifdef OC_INPUT_REPLAY
+  // Core ISR, while replaying (when PushEvent drops everything)
+  inline void InjectEvent(const UI::Event &event) {
+    event_queue_.PushEvent(event.type, event.control, event.value, event.mask, event.accelerated);
+  }
+#endif
+
 private:
 
   uint32_t ticks_;
@@ -145,12 +153,26 @@ private:
   UI::EventQueue<kEventQueueDepth> event_queue_;
 
   inline void PushEvent(UI::EventType t, uint16_t c, int16_t v, uint16_t m) {
+    PushEvent(t, c, v, m, v);
+  }
+
+  inline void PushEvent(UI::EventType t, uint16_t c, int16_t v, uint16_t m, int16_t a) {
+#ifdef OC_INPUT_REPLAY
+    if (!Replay::FilterEvent(UI::Event(t, c, v, m, a)))
+      return;
+#endif
 #ifdef OC_UI_DEBUG
-    if (!event_queue_.writable())
-      ++DEBUG::UI_queue_overflow;
+    switch (event_queue_.PushEvent(t, c, v, m, a)) {
+      case UI::EVENT_COALESCED: ++DEBUG::UI_events_coalesced; break;
+      case UI::EVENT_DROPPED: ++DEBUG::UI_queue_overflow; break;
+      default: break;
+    }
     ++DEBUG::UI_event_count;
+    if (event_queue_.depth() > DEBUG::UI_max_queue_depth)
+      DEBUG::UI_max_queue_depth = event_queue_.depth();
+#else
+    event_queue_.PushEvent(t, c, v, m, a);
 #endif
-    event_queue_.PushEvent(t, c, v, m);
   }
 
   bool IgnoreEvent(const UI::Event &event) {
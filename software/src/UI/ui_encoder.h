@@ -36,6 +36,12 @@ public:
   static const int32_t kAccelerationInc = 208;
   static const int32_t kAccelerationMax = 16 << 8;
 
+  // Velocity tracking is in Read() calls, i.e. UI ticks. The curve maps the
+  // smoothed time between detents to a multiplier for accelerated(); it's
+  // rebuilt by set_velocity_curve so the ISR only does a table lookup.
+  static const int32_t kVelocityTableSize = 64;
+  static const int32_t kVelocityMaxTicks = 0xffff;
+
   // For debouncing of pins, use 0x0f (b00001111) and 0x0c (b00001100) etc.
   static const uint8_t kPinMask = 0x03;
   static const uint8_t kPinEdge = 0x02;
@@ -51,7 +57,27 @@ public:
     reversed_ = false;
     last_dir_ = 0;
     acceleration_ = 0;
+    accelerated_ = 0;
+    detent_ticks_ = kVelocityMaxTicks;
+    velocity_ticks_ = kVelocityMaxTicks;
     pin_state_[0] = pin_state_[1] = 0xff;
+    set_velocity_curve(kVelocityTableSize - 1, 0, 1);
+  }
+
+  // Turning slower than slow_ticks per detent is always 1x; at fast_ticks or
+  // faster it's max_multiplier, with a quadratic ramp in between. slow_ticks
+  // is limited to the table size.
+  void set_velocity_curve(int32_t slow_ticks, int32_t fast_ticks, int32_t max_multiplier) {
+    CONSTRAIN(slow_ticks, 1, kVelocityTableSize - 1);
+    CONSTRAIN(fast_ticks, 0, slow_ticks - 1);
+    CONSTRAIN(max_multiplier, 1, 255);
+
+    const int32_t range = slow_ticks - fast_ticks;
+    for (int32_t t = 0; t < kVelocityTableSize; ++t) {
+      int32_t s = slow_ticks - t;
+      CONSTRAIN(s, 0, range);
+      velocity_curve_[t] = 1 + ((max_multiplier - 1) * s * s + range * range / 2) / (range * range);
+    }
   }
 
   void Poll() {
@@ -70,8 +96,14 @@ public:
     reversed_ = reversed;
   }
 
+  // Returns the detent step, including the fixed-rate acceleration if that's
+  // enabled. The velocity-scaled step for the same detent is available from
+  // accelerated() afterwards.
   inline int32_t Read() {
 
+    if (detent_ticks_ < kVelocityMaxTicks)
+      ++detent_ticks_;
+
     int32_t acceleration = acceleration_;
     if (acceleration_enabled_ && acceleration) {
       acceleration -= kAccelerationDec;
@@ -109,21 +141,58 @@ public:
         acceleration = 0;
       }
 
+      UpdateVelocity(i);
       last_dir_ = i;
       i += i * (acceleration >> 8);
+    } else {
+      accelerated_ = 0;
     }
 
     acceleration_ = acceleration;
     return i;
   }
 
+  // Step from the last Read() scaled by turning speed; 1x if acceleration is
+  // disabled.
+  inline int32_t accelerated() const {
+    return accelerated_;
+  }
+
+  // Smoothed UI ticks per detent, for debugging the curve
+  inline uint32_t velocity_ticks() const {
+    return velocity_ticks_;
+  }
+
 private:
   bool acceleration_enabled_;
   bool reversed_;
   int32_t last_dir_;
   int32_t acceleration_;
+  int32_t accelerated_;
+  uint16_t detent_ticks_;
+  uint16_t velocity_ticks_;
+  uint8_t velocity_curve_[kVelocityTableSize];
   uint8_t pin_state_[2];
 
+  // Average of the last two intervals, restarted on a change of direction or
+  // a pause, so the first detent after either is always 1x.
+  inline void UpdateVelocity(int32_t dir) {
+    uint32_t ticks = detent_ticks_;
+    detent_ticks_ = 0;
+
+    if (dir != last_dir_ || ticks >= kVelocityTableSize)
+      velocity_ticks_ = kVelocityMaxTicks;
+    else if (velocity_ticks_ >= kVelocityTableSize)
+      velocity_ticks_ = ticks;
+    else
+      velocity_ticks_ = (velocity_ticks_ + ticks + 1) >> 1;
+
+    if (acceleration_enabled_ && velocity_ticks_ < kVelocityTableSize)
+      accelerated_ = dir * velocity_curve_[velocity_ticks_];
+    else
+      accelerated_ = dir;
+  }
+
   DISALLOW_COPY_AND_ASSIGN(Encoder);
 };
 
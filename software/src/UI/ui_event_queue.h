@@ -29,13 +29,24 @@
 
 namespace UI {
 
+enum EventQueueResult {
+  EVENT_QUEUED,
+  EVENT_COALESCED,
+  EVENT_DROPPED
+};
+
 // Event queue for UI events
 // Meant for single producer/single consumer setting
 //
 // Yes, looks similar to stmlib::EventQueue, but hey, it's a queue for UI events.
+//
+// If the consumer falls behind, consecutive encoder events for the same
+// control (and button state) are merged into one, so fast turns don't fill
+// up the queue. If it's full anyway, new events are dropped.
 template <size_t size = 16>
 class EventQueue {
 public:
+  static_assert(!(size & (size - 1)), "EventQueue size must be a power of 2");
 
   EventQueue() { }
 
@@ -52,15 +63,28 @@ public:
     return events_.readable();
   }
 
-  inline void PushEvent(EventType t, uint16_t c, int16_t v) {
-    // TODO EmplaceWrite?
-    events_.Write(Event(t, c, v, 0));
-    Poke();
+  inline size_t depth() const {
+    return events_.readable();
+  }
+
+  inline EventQueueResult PushEvent(EventType t, uint16_t c, int16_t v) {
+    return PushEvent(t, c, v, 0);
   }
 
-  inline void PushEvent(EventType t, uint16_t c, int16_t v, uint16_t m) {
-    events_.Write(Event(t, c, v, m));
+  inline EventQueueResult PushEvent(EventType t, uint16_t c, int16_t v, uint16_t m) {
+    return PushEvent(t, c, v, m, v);
+  }
+
+  inline EventQueueResult PushEvent(EventType t, uint16_t c, int16_t v, uint16_t m, int16_t a) {
+    EventQueueResult result = EVENT_QUEUED;
+    if (EVENT_ENCODER == t && Coalesce(c, v, m, a))
+      result = EVENT_COALESCED;
+    else if (events_.writable())
+      events_.Write(Event(t, c, v, m, a));
+    else
+      result = EVENT_DROPPED;
     Poke();
+    return result;
   }
 
   inline Event PullEvent() {
@@ -84,6 +108,26 @@ private:
 
   util::RingBuffer<Event, size> events_;
   uint32_t last_event_time_;
+
+  // The newest event can only be modified if the consumer isn't reading it
+  bool Coalesce(uint16_t c, int16_t v, uint16_t m, int16_t a) {
+    if (events_.readable() < 2)
+      return false;
+
+    Event &last = events_.Back();
+    if (EVENT_ENCODER != last.type || c != last.control || m != last.mask)
+      return false;
+
+    int32_t value = last.value + v;
+    int32_t accelerated = last.accelerated + a;
+    if (value < -32768 || value > 32767 ||
+        accelerated < -32768 || accelerated > 32767)
+      return false;
+
+    last.value = value;
+    last.accelerated = accelerated;
+    return true;
+  }
 };
 
 }; // namespace UI
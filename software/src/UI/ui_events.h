@@ -37,15 +37,22 @@ namespace UI {
 
   // UI event struct
   // Yes, looks similar to stmlib::Event but hey, they're UI events.
+  //
+  // For encoder events, accelerated is value scaled by how fast the encoder
+  // is being turned; handlers for large parameter ranges can use it instead of
+  // value. For everything else it's the same as value.
   struct Event {
     uint16_t control;
     int16_t value;
     uint16_t mask;
     EventType type;
+    int16_t accelerated;
 
     Event() { }
     Event(UI::EventType t, uint16_t c, int16_t v, uint16_t m)
-    : type(t), control(c), value(v), mask(m) { }
+    : type(t), control(c), value(v), mask(m), accelerated(v) { }
+    Event(UI::EventType t, uint16_t c, int16_t v, uint16_t m, int16_t a)
+    : type(t), control(c), value(v), mask(m), accelerated(a) { }
   };
 
 }; // namespace UI
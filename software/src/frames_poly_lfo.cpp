@@ -64,6 +64,8 @@ void PolyLfo::Init() {
   last_phase_difference_ = 0;
   last_phase_difference_ = 0;
   pattern_predictor_.Init();
+  increments_valid_ = false;
+  wavetables_valid_ = false;
 }
 
 /* static */
@@ -131,6 +133,44 @@ uint32_t PolyLfo::FrequencyToPhaseIncrement(int32_t frequency, uint16_t frq_rng)
   return (a + ((b - a) * (index & 0x1f) >> 5)) << shifts;
 }
 
+void PolyLfo::UpdatePhaseIncrements(int32_t frequency, uint8_t freq_mult) {
+  // increment freqs for each LFO
+  if (sync_) {
+    phase_increment_ch1_ = sync_phase_increment_;
+  } else {
+    phase_increment_ch1_ = FrequencyToPhaseIncrement(frequency, freq_range_);
+  }
+
+  // double F (via TR4) ? ... "/8", "/4", "/2", "x2", "x4", "x8"
+  if (freq_mult < 0xFF) {
+    phase_increment_ch1_ = (freq_mult < 0x3) ? (phase_increment_ch1_ >> (0x3 - freq_mult)) : phase_increment_ch1_ << (freq_mult - 0x2);
+  }
+
+  phase_increment_[0] = phase_increment_ch1_;
+  PolyLfoFreqMultipliers FreqDivs[] = {POLYLFO_FREQ_MULT_NONE, freq_div_b_, freq_div_c_ , freq_div_d_} ;
+  for (uint8_t i = 1; i < kNumChannels; ++i) {
+      if (FreqDivs[i] == POLYLFO_FREQ_MULT_NONE) {
+          phase_increment_[i] = phase_increment_ch1_;
+      } else {
+          phase_increment_[i] = multiply_u32xu32_rshift24(phase_increment_ch1_, PolyLfoFreqMultNumerators[FreqDivs[i]]) ;
+      }
+  }
+
+  last_frequency_ = frequency;
+  last_freq_mult_ = freq_mult;
+  increments_valid_ = true;
+}
+
+void PolyLfo::UpdateWavetables() {
+  uint16_t wavetable_index = shape_;
+  for (uint8_t i = 0; i < kNumChannels; ++i) {
+    wavetable_[i] = &wt_lfo_waveforms[(wavetable_index >> 12) * 257];
+    wavetable_balance_[i] = wavetable_index << 4;
+    wavetable_index += shape_spread_;
+  }
+  wavetables_valid_ = true;
+}
+
 void PolyLfo::Render(int32_t frequency, bool reset_phase, bool tempo_sync, uint8_t freq_mult) {
     ++sync_counter_;
     if (tempo_sync && sync_) {
@@ -145,6 +185,7 @@ void PolyLfo::Render(int32_t frequency, bool reset_phase, bool tempo_sync, uint8
           if (period != period_) {
             period_ = period;
             sync_phase_increment_ = 0xffffffff / period_;
+            increments_valid_ = false;
             //sync_phase_increment_ = multiply_u32xu32_rshift24((0xffffffff / period_), 16183969) ;
           }
         }
@@ -157,27 +198,11 @@ void PolyLfo::Render(int32_t frequency, bool reset_phase, bool tempo_sync, uint8
     std::fill(&phase_[0], &phase_[kNumChannels], 0);
     phase_reset_flag_ = false ;
   } else {
-    // increment freqs for each LFO
-    if (sync_) {
-      phase_increment_ch1_ = sync_phase_increment_;
-    } else {
-      phase_increment_ch1_ = FrequencyToPhaseIncrement(frequency, freq_range_);
-    }
-    
-    // double F (via TR4) ? ... "/8", "/4", "/2", "x2", "x4", "x8"
-    if (freq_mult < 0xFF) {
-      phase_increment_ch1_ = (freq_mult < 0x3) ? (phase_increment_ch1_ >> (0x3 - freq_mult)) : phase_increment_ch1_ << (freq_mult - 0x2);
-    }
-    
-    phase_[0] += phase_increment_ch1_;
-    PolyLfoFreqMultipliers FreqDivs[] = {POLYLFO_FREQ_MULT_NONE, freq_div_b_, freq_div_c_ , freq_div_d_} ;
-    for (uint8_t i = 1; i < kNumChannels; ++i) {
-        if (FreqDivs[i] == POLYLFO_FREQ_MULT_NONE) {
-            phase_[i] += phase_increment_ch1_;
-        } else {
-            phase_[i] += multiply_u32xu32_rshift24(phase_increment_ch1_, PolyLfoFreqMultNumerators[FreqDivs[i]]) ;
-        }  
-    }
+    if (!increments_valid_ || frequency != last_frequency_ || freq_mult != last_freq_mult_)
+      UpdatePhaseIncrements(frequency, freq_mult);
+
+    for (uint8_t i = 0; i < kNumChannels; ++i)
+      phase_[i] += phase_increment_[i];
 
     // Advance phasors.
     if (spread_ >= 0) {
@@ -208,8 +233,10 @@ void PolyLfo::Render(int32_t frequency, bool reset_phase, bool tempo_sync, uint8
   }
   
   const uint8_t* sine = &wt_lfo_waveforms[17 * 257];
-  
-  uint16_t wavetable_index = shape_;
+
+  if (!wavetables_valid_)
+    UpdateWavetables();
+
   uint8_t xor_depths[] = {0, b_xor_a_, c_xor_a_, d_xor_a_ } ;
   uint8_t am_depths[] = {0, b_am_by_a_, c_am_by_b_, d_am_by_c_ } ;
   // Wavetable lookup
@@ -220,9 +247,9 @@ void PolyLfo::Render(int32_t frequency, bool reset_phase, bool tempo_sync, uint8
     } else {
       phase += value_[(i + kNumChannels - 1) % kNumChannels] * -coupling_;
     }
-    const uint8_t* a = &wt_lfo_waveforms[(wavetable_index >> 12) * 257];
+    const uint8_t* a = wavetable_[i];
     const uint8_t* b = a + 257;
-    wt_value_[i] = Crossfade(a, b, phase, wavetable_index << 4) ;
+    wt_value_[i] = Crossfade(a, b, phase, wavetable_balance_[i]) ;
     value_[i] = Interpolate824(sine, phase);
     level_[i] = (wt_value_[i] + 32768) >> 8; 
     // add bit-XOR 
@@ -236,7 +263,15 @@ void PolyLfo::Render(int32_t frequency, bool reset_phase, bool tempo_sync, uint8
     dac_code_[i] = (dac_code_[i] * (65535 - (((65535 - dac_code_[i-1]) * am_depths[i]) >> 8))) >> 16 ; 
     // attenuationand offset
     dac_code_[i] = ((dac_code_[i] * attenuation_) >> 16) + offset_ ;
-    wavetable_index += shape_spread_;
+  }
+}
+
+void PolyLfo::RenderBlock(int32_t frequency, bool reset_phase, bool tempo_sync, uint8_t freq_mult, uint16_t *dac_codes, size_t size) {
+  while (size--) {
+    Render(frequency, reset_phase, tempo_sync, freq_mult);
+    reset_phase = tempo_sync = false;
+    for (uint8_t i = 0; i < kNumChannels; ++i)
+      *dac_codes++ = dac_code_[i];
   }
 }
 
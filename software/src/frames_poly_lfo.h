@@ -134,18 +134,31 @@ class PolyLfo {
   
   void Init();
   void Render(int32_t frequency, bool reset_phase, bool tempo_sync, uint8_t freq_mult);
+  // Render size frames of kNumChannels DAC codes into dac_codes. Phase reset
+  // and tempo sync are applied to the first frame.
+  void RenderBlock(int32_t frequency, bool reset_phase, bool tempo_sync, uint8_t freq_mult, uint16_t *dac_codes, size_t size);
   void RenderPreview(uint16_t shape, uint16_t *buffer, size_t size);
 
   inline void set_freq_range(uint16_t freq_range) {
-   freq_range_ = freq_range;
+    if (freq_range != freq_range_) {
+      freq_range_ = freq_range;
+      increments_valid_ = false;
+    }
   }
   
   inline void set_shape(uint16_t shape) {
-    shape_ = shape;
+    if (shape != shape_) {
+      shape_ = shape;
+      wavetables_valid_ = false;
+    }
   }
 
   inline void set_shape_spread(uint16_t shape_spread) {
-    shape_spread_ = static_cast<int16_t>(shape_spread - 32767) >> 1;
+    int16_t s = static_cast<int16_t>(shape_spread - 32767) >> 1;
+    if (s != shape_spread_) {
+      shape_spread_ = s;
+      wavetables_valid_ = false;
+    }
   }
 
   inline void set_spread(uint16_t spread) {
@@ -180,6 +193,7 @@ class PolyLfo {
     if (div != freq_div_b_) {
       freq_div_b_ = div;
       phase_reset_flag_ = true;
+      increments_valid_ = false;
     }
   }
 
@@ -187,6 +201,7 @@ class PolyLfo {
     if (div != freq_div_c_) {
       freq_div_c_ = div;
       phase_reset_flag_ = true;
+      increments_valid_ = false;
     }
   }
 
@@ -194,6 +209,7 @@ class PolyLfo {
     if (div != freq_div_d_) {
       freq_div_d_ = div;
       phase_reset_flag_ = true;
+      increments_valid_ = false;
     }
   }
 
@@ -238,7 +254,10 @@ class PolyLfo {
   }
 
   inline void set_sync(bool sync) {
-    sync_ = sync;
+    if (sync != sync_) {
+      sync_ = sync;
+      increments_valid_ = false;
+    }
   }
 
   inline int get_sync() {
@@ -267,6 +286,10 @@ class PolyLfo {
 
   static uint32_t FrequencyToPhaseIncrement(int32_t frequency, uint16_t frq_rng);
 
+  // Phase increments and wavetable crossfade parameters only depend on the
+  // settings, so they're cached and only recomputed when those change.
+  void UpdatePhaseIncrements(int32_t frequency, uint8_t freq_mult);
+  void UpdateWavetables();
 
  private:
   uint16_t freq_range_ ;
@@ -291,6 +314,13 @@ class PolyLfo {
   int16_t wt_value_[kNumChannels];
   uint32_t phase_[kNumChannels];
   uint32_t phase_increment_ch1_;
+  uint32_t phase_increment_[kNumChannels];
+  int32_t last_frequency_;
+  uint8_t last_freq_mult_;
+  bool increments_valid_;
+  const uint8_t *wavetable_[kNumChannels];
+  uint16_t wavetable_balance_[kNumChannels];
+  bool wavetables_valid_;
   uint8_t level_[kNumChannels];
   uint16_t dac_code_[kNumChannels];
 
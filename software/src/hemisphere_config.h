@@ -46,7 +46,7 @@
 #include "HEM_RunglBook.h"
 // #include "HEM_ScaleDuet.h"
 #include "HEM_Schmitt.h"
-// #include "HEM_Scope.h"
+#include "HEM_Scope.h"
 // #include "HEM_ShiftGate.h"
 // #include "HEM_Sequence5.h"
 #include "HEM_TM.h"
@@ -70,7 +70,7 @@
 #include "HEM_DrumMap.h"
 #include "HEM_Shredder.h"
 
-#define HEMISPHERE_AVAILABLE_APPLETS 31 //51
+#define HEMISPHERE_AVAILABLE_APPLETS 32 //51
 
 //////////////////  id  cat   class name
 #define HEMISPHERE_APPLETS { \
@@ -94,6 +94,7 @@
     DECLARE_APPLET( 62, 0x01, RndWalk), \
     DECLARE_APPLET( 44, 0x01, RunglBook), \
     DECLARE_APPLET( 40, 0x40, Schmitt), \
+    DECLARE_APPLET( 23, 0x80, Scope), \
     DECLARE_APPLET( 52, 0x01, Shredder), \
     DECLARE_APPLET( 46, 0x08, Squanch), \
     DECLARE_APPLET(  3, 0x10, Switch), \
@@ -110,7 +111,6 @@
 /*
     // DECLARE_APPLET( 56, 0x10, AttenuateOffset), \
     // DECLARE_APPLET( 34, 0x01, ADEG), \
-    // DECLARE_APPLET( 23, 0x80, Scope), \
     // DECLARE_APPLET( 31, 0x04, Burst), \
     // DECLARE_APPLET( 32, 0x0a, Carpeggio), \
     // DECLARE_APPLET( 48, 0x45, ShiftGate), \
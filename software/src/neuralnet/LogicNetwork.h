@@ -0,0 +1,171 @@
+#ifndef LOGICNETWORK_H
+#define LOGICNETWORK_H
+
+#include "LogicGate.h"
+
+#define LN_MAX_GATES 6
+#define LN_SOURCE_ON (0x01 << 14)
+
+/* LogicNetwork is a compiled form of a set of LogicGates.
+ *
+ * LogicGate::Calculate() works out its gate type and looks up each source every
+ * time it's called. The network does that work once, in Compile(), whenever the
+ * patch changes. Each gate becomes an instruction with its sources already turned
+ * into bitmasks on the source state, so most gates are a single AND and compare:
+ *
+ *     AND, NAND      all bits of (mask1 | mask2) set
+ *     OR, NOR, NOT   any bit of (mask1 | mask2) set
+ *     XOR, XNOR, TL  three source bits index an 8-entry truth table
+ *
+ * The threshold logic neuron's weights and threshold are baked into its truth
+ * table, so there's no arithmetic left at run time. Flip-flops and the latch keep
+ * their state in the LogicGate, as before.
+ *
+ * Gates are evaluated in index order, and each gate sees the new state of lower-
+ * numbered gates and the previous state of higher-numbered ones, exactly like the
+ * original loop. This matters for patches with feedback, so the order is kept.
+ *
+ * Given the same source state, a network produces the same result, so Evaluate()
+ * skips all the work when the source state (inputs and gate outputs) hasn't
+ * changed since the last call. The CV comparators only cost anything when one of
+ * them actually crosses.
+ */
+class LogicNetwork {
+public:
+    /* Build the program from count gates. Call whenever a gate's type or sources change. */
+    void Compile(LogicGate *gates_, uint8_t count_) {
+        gates = gates_;
+        count = count_;
+        for (uint8_t g = 0; g < count; g++)
+        {
+            LogicGate &gate = gates[g];
+            LogicInstruction &ins = program[g];
+            uint16_t m1 = source_mask(gate.source1);
+            uint16_t m2 = source_mask(gate.source2);
+            uint16_t m3 = source_mask(gate.source3);
+            ins.mask1 = m1;
+            ins.mask2 = m2;
+            ins.mask3 = m3;
+            ins.invert = 0;
+            switch (gate.type) {
+                case LogicGateType::NOT        : ins.op = OP_ANY; ins.mask1 = m1; ins.invert = 1; break;
+                case LogicGateType::AND        : ins.op = OP_ALL; ins.mask1 = m1 | m2; break;
+                case LogicGateType::OR         : ins.op = OP_ANY; ins.mask1 = m1 | m2; break;
+                case LogicGateType::NAND       : ins.op = OP_ALL; ins.mask1 = m1 | m2; ins.invert = 1; break;
+                case LogicGateType::NOR        : ins.op = OP_ANY; ins.mask1 = m1 | m2; ins.invert = 1; break;
+                case LogicGateType::XOR        : ins.op = OP_TABLE; ins.table = 0x66; break; // v1 != v2
+                case LogicGateType::XNOR       : ins.op = OP_TABLE; ins.table = 0x99; break; // v1 == v2
+                case LogicGateType::D_FLIPFLOP : ins.op = OP_D_FLIPFLOP; break;
+                case LogicGateType::T_FLIPFLOP : ins.op = OP_T_FLIPFLOP; break;
+                case LogicGateType::LATCH      : ins.op = OP_LATCH; break;
+                case LogicGateType::TL_NEURON  : ins.op = OP_TABLE; ins.table = tl_neuron_table(gate); break;
+                default                        : ins.op = OP_OFF;
+            }
+        }
+        valid = 0;
+    }
+
+    /* Run the network on the source state (bits 0-7 are inputs, 8-13 are gate outputs)
+     * and return the new source state. Gate state is written back to the LogicGates.
+     */
+    uint16_t Evaluate(uint16_t source_state) {
+        if (valid && source_state == last_source_state) return last_result;
+        last_source_state = source_state;
+
+        for (uint8_t g = 0; g < count; g++)
+        {
+            const LogicInstruction &ins = program[g];
+            LogicGate &gate = gates[g];
+            uint16_t s = source_state | LN_SOURCE_ON;
+            bool v;
+            switch (ins.op) {
+                case OP_ALL        : v = (s & ins.mask1) == ins.mask1; break;
+                case OP_ANY        : v = (s & ins.mask1) != 0; break;
+                case OP_TABLE      : v = (ins.table >> table_index(s, ins)) & 0x01; break;
+                case OP_D_FLIPFLOP : v = d_flipflop(gate, s & ins.mask1, clock_edge(gate, s & ins.mask2)); break;
+                case OP_T_FLIPFLOP : v = t_flipflop(gate, s & ins.mask1, clock_edge(gate, s & ins.mask2)); break;
+                case OP_LATCH      : v = latch(gate, s & ins.mask1, s & ins.mask2); break;
+                default            : v = 0;
+            }
+            v ^= ins.invert;
+            gate.state = v;
+            gate.source_state = s; // For display purposes
+
+            uint16_t bit = 0x01 << (8 + g);
+            source_state = v ? (source_state | bit) : (source_state & ~bit);
+        }
+
+        last_result = source_state;
+        valid = 1;
+        return source_state;
+    }
+
+private:
+    enum Op : uint8_t {
+        OP_OFF,
+        OP_ALL,
+        OP_ANY,
+        OP_TABLE,
+        OP_D_FLIPFLOP,
+        OP_T_FLIPFLOP,
+        OP_LATCH
+    };
+
+    struct LogicInstruction {
+        uint8_t op;
+        uint8_t table; // Truth table for OP_TABLE, indexed by (v3 << 2) | (v2 << 1) | v1
+        bool invert;
+        uint16_t mask1;
+        uint16_t mask2;
+        uint16_t mask3;
+    };
+
+    LogicInstruction program[LN_MAX_GATES];
+    LogicGate *gates;
+    uint8_t count = 0;
+    bool valid = 0; // Are last_source_state and last_result current?
+    uint16_t last_source_state;
+    uint16_t last_result;
+
+    static uint16_t source_mask(int source) {
+        return 0x01 << constrain(source, 0, LG_MAX_SOURCE);
+    }
+
+    static uint8_t table_index(uint16_t s, const LogicInstruction &ins) {
+        return ((s & ins.mask1) ? 0x01 : 0) | ((s & ins.mask2) ? 0x02 : 0) | ((s & ins.mask3) ? 0x04 : 0);
+    }
+
+    static uint8_t tl_neuron_table(const LogicGate &gate) {
+        uint8_t table = 0;
+        for (uint8_t ix = 0; ix < 8; ix++)
+        {
+            int v = ((ix & 0x01) ? gate.weight1 : 0)
+                  + ((ix & 0x02) ? gate.weight2 : 0)
+                  + ((ix & 0x04) ? gate.weight3 : 0);
+            if (v > gate.threshold) table |= (0x01 << ix);
+        }
+        return table;
+    }
+
+    // Same clock handling as LogicGate: only the rising edge counts
+    static bool clock_edge(LogicGate &gate, bool clock) {
+        bool edge = clock && !gate.clocked;
+        gate.clocked = clock;
+        return edge;
+    }
+
+    static bool d_flipflop(LogicGate &gate, bool D, bool clock) {
+        return clock ? D : gate.state;
+    }
+
+    static bool t_flipflop(LogicGate &gate, bool T, bool clock) {
+        return (clock && T) ? !gate.state : gate.state;
+    }
+
+    static bool latch(LogicGate &gate, bool reset, bool set) {
+        if (set) return 1;
+        return reset ? 0 : gate.state;
+    }
+};
+
+#endif // LOGICNETWORK_H
@@ -34,6 +34,7 @@
 
 // #include "peaks/drums/svf.h"
 
+#include <stddef.h>
 #include <stdint.h>
 #include "util/util_macros.h"
 
@@ -51,6 +52,10 @@ class ByteBeat {
   void Init();
   uint16_t ProcessSingleSample(uint8_t control);
   uint16_t Clock();
+
+  // Renders size samples, one per control byte, with the same output as
+  // calling ProcessSingleSample in a loop.
+  void Render(const uint8_t* control, uint16_t* out, size_t size);
  
   void Configure(int32_t* parameter, bool stepmode, bool loopmode) {
       set_equation(parameter[0]);
@@ -75,6 +80,7 @@ class ByteBeat {
    inline void set_equation(int32_t equation) {
     equation_ = equation ;
     equation_index_ = equation_ >> 12 ;
+    equation_fn_ = equations_[equation_index_];
   }
 
    inline void set_step_mode(bool stepmode) {
@@ -146,6 +152,42 @@ class ByteBeat {
   }
   
  private:
+  static const uint8_t kNumEquations = 16;
+
+  typedef uint16_t (*EquationFn)(uint32_t t, uint8_t pitch, uint8_t p0, uint8_t p1, uint8_t p2, uint16_t pitch16, uint16_t last_sample);
+  static const EquationFn equations_[kNumEquations];
+
+  inline uint16_t Tick(uint8_t control) {
+    if (control & CONTROL_GATE_RISING) {
+      if (stepmode_) {
+        ++t_ ;
+      } else {
+        phase_ = 0;
+        if (loopmode_) {
+          t_ = loop_start_ ;
+        } else {
+          t_ = 0 ;
+        }
+      }
+    }
+
+    if (!stepmode_) {
+      ++phase_ ;
+    }
+
+    if (loopmode_ && (t_ < loop_start_ || t_ > loop_end_)) {
+       t_ = loop_start_ ;
+       phase_ = 0 ;
+    }
+
+    if (!stepmode_ && (phase_ % bytepitch_ == 0)) ++t_;
+
+    uint16_t sample = equation_fn_(t_, pitch_, p0_, p1_, p2_, pitch_, last_sample_);
+    last_sample_ = sample ;
+    return sample ;
+  }
+
+  EquationFn equation_fn_;
   uint16_t equation_ ;
   uint16_t speed_;
   uint16_t pitch_;
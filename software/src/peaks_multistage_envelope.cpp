@@ -206,7 +206,7 @@ uint16_t MultistageEnvelope::RenderPreview(
   return current_pos;
 }
 
-uint16_t MultistageEnvelope::RenderFastPreview(int16_t *values) const {
+uint16_t MultistageEnvelope::RenderFastPreview(int16_t *values, bool full) const {
 
   const uint16_t num_segments = num_segments_;
   const uint16_t current_segment = segment_;
@@ -218,9 +218,11 @@ uint16_t MultistageEnvelope::RenderFastPreview(int16_t *values) const {
     ? (2 * kFastPreviewWidth) / (2 * num_segments + 1)
     : kFastPreviewWidth / num_segments;
 
+  const uint16_t last_segment = full ? num_segments - 1 : current_segment;
+
   int16_t *current_pos = values;
-  if (current_segment != num_segments) {
-    for (uint16_t segment = 0; segment <= current_segment; ++segment) {
+  if (full || current_segment != num_segments) {
+    for (uint16_t segment = 0; segment <= last_segment; ++segment) {
 
       if (sustain_point && segment == sustain_point) {
         // Sustain points are half as wide as normal segments
@@ -232,7 +234,7 @@ uint16_t MultistageEnvelope::RenderFastPreview(int16_t *values) const {
       uint32_t segment_w = time_[segment] * segment_width >> 16; // segment_width
       CONSTRAIN(segment_w, 1, segment_width);
 
-      const bool phase_in_segment = segment == current_segment;
+      const bool phase_in_segment = !full && segment == current_segment;
       uint16_t w = segment_w;
       if (phase_in_segment)
         w = (((phase >> 24) * segment_w) / 256);
@@ -256,5 +258,73 @@ uint16_t MultistageEnvelope::RenderFastPreview(int16_t *values) const {
   return current_pos - values;
 }
 
+void MultistageEnvelope::GetPreviewShape(PreviewShape &shape) const {
+  memset(&shape, 0, sizeof(shape));
+  shape.num_segments = num_segments_;
+  shape.sustain_point = sustain_point_;
+  shape.sustain_index = sustain_index_;
+  shape.loop_start = loop_start_;
+  shape.loop_end = loop_end_;
+  for (uint16_t segment = 0; segment < kMaxNumSegments; ++segment) {
+    shape.level[segment] = level_[segment];
+    shape.time[segment] = time_[segment];
+    shape.shape[segment] = shape_[segment];
+  }
+}
+
+// Same layout as RenderPreview
+uint16_t MultistageEnvelope::PreviewPhase() const {
+  const uint16_t num_segments = num_segments_;
+  const uint16_t current_segment = segment_;
+  const uint16_t sustain_point = sustain_point_;
+  const uint32_t phase = phase_;
+
+  const uint16_t segment_width = sustain_point
+    ? (2 * kPreviewWidth) / (2 * num_segments + 1)
+    : kPreviewWidth / num_segments;
+
+  uint16_t current_pos = 0;
+  for (uint16_t segment = 0; segment < num_segments; ++segment) {
+    if (sustain_point && segment == sustain_point)
+      current_pos += segment_width / 2;
+
+    uint32_t w = time_[segment] * segment_width >> 16;
+    if (w < 1) w = 1;
+    if (segment == current_segment)
+      return current_pos + (((phase >> 24) * w) / 256);
+    current_pos += w;
+  }
+  return 0;
+}
+
+// Same layout as RenderFastPreview
+uint16_t MultistageEnvelope::FastPreviewLength() const {
+  const uint16_t num_segments = num_segments_;
+  const uint16_t current_segment = segment_;
+  const uint16_t sustain_point = sustain_point_;
+  const uint32_t phase = phase_;
+
+  const uint16_t segment_width = sustain_point
+    ? (2 * kFastPreviewWidth) / (2 * num_segments + 1)
+    : kFastPreviewWidth / num_segments;
+
+  uint16_t length = 0;
+  if (current_segment != num_segments) {
+    for (uint16_t segment = 0; segment <= current_segment; ++segment) {
+      if (sustain_point && segment == sustain_point)
+        length += segment_width / 2;
+
+      uint32_t segment_w = time_[segment] * segment_width >> 16;
+      CONSTRAIN(segment_w, 1, segment_width);
+      if (segment == current_segment) {
+        length += (uint16_t)(((phase >> 24) * segment_w) / 256);
+        break;
+      }
+      length += segment_w;
+    }
+  }
+  return length;
+}
+
 
 }  // namespace peaks
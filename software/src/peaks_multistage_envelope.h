@@ -30,6 +30,7 @@
 #define PEAKS_MODULATIONS_MULTISTAGE_ENVELOPE_H_
 
 #include <stdint.h>
+#include <string.h>
 #include "util/util_macros.h"
 #include "OC_options.h"
 #include "peaks_gate_processor.h"
@@ -74,6 +75,23 @@ const uint16_t kMaxNumSegments = 8;
 const uint32_t kPreviewWidth = 128;
 const uint32_t kFastPreviewWidth = 64;
 
+// Everything the previews depend on except the current segment and phase,
+// so a rendered preview can be kept until the envelope shape changes.
+struct PreviewShape {
+  uint16_t num_segments;
+  uint16_t sustain_point;
+  uint16_t sustain_index;
+  uint16_t loop_start;
+  uint16_t loop_end;
+  int16_t level[kMaxNumSegments];
+  uint16_t time[kMaxNumSegments];
+  uint16_t shape[kMaxNumSegments];
+
+  bool operator==(const PreviewShape &other) const {
+    return !memcmp(this, &other, sizeof(PreviewShape));
+  }
+};
+
 class MultistageEnvelope {
  public:
   MultistageEnvelope() { }
@@ -365,9 +383,16 @@ class MultistageEnvelope {
   uint16_t RenderPreview(int16_t *values, uint16_t *segment_start_points, uint16_t *loop_points, uint16_t &current_phase) const;
 
   // Render fast preview, normalized to kFastPreviewWidth, and only includes
-  // points up to the current phase.
+  // points up to the current phase (unless full is set).
   // Also likes to live dangerously
-  uint16_t RenderFastPreview(int16_t *values) const;
+  uint16_t RenderFastPreview(int16_t *values, bool full = false) const;
+
+  void GetPreviewShape(PreviewShape &shape) const;
+
+  // Phase cursor for RenderPreview and number of points RenderFastPreview
+  // would return, without rendering anything; for use with cached previews.
+  uint16_t PreviewPhase() const;
+  uint16_t FastPreviewLength() const;
 
  private:
   int16_t level_[kMaxNumSegments];
@@ -36,8 +36,8 @@
 #define STREAMS_LORENZ_GENERATOR_H_
 
 #include "util/util_macros.h"
-// #include "stmlib/stmlib.h"
-// #include "streams/meta_parameters.h"
+#include "extern/dspinst.h"
+#include "streams_resources.h"
 
 namespace streams {
 
@@ -69,6 +69,146 @@ enum ELorenzOutputMap {
   LORENZ_OUTPUT_LAST,
 };
 
+// All state is Q24 fixed point
+const int64_t kLorenzSigma = 10.0 * (1 << 24);
+const int64_t kLorenzBeta = 8.0 / 3.0 * (1 << 24);
+const int64_t kRosslerA = 0.1 * (1 << 24);
+const int64_t kRosslerB = 0.1 * (1 << 24);
+
+// Engine that integrates N pairs of Lorenz and Rössler attractors. Each pair
+// shares a rate, and has its own rho (Lorenz) and c (Rössler) parameter.
+//
+// State is kept as structure-of-arrays so all attractors are stepped in one
+// loop; running more attractors only costs the integration itself.
+//
+// Two integrators are available:
+// - The default is bit-exact to the original int64 implementation.
+// - set_fast(true) selects a 32-bit path that only uses 32x32 multiplies
+//   (smull/smmul) instead of 64x64 ones. The x terms and the Rössler y term
+//   are still exact, since their operands fit into 32 bits. The other
+//   derivatives exceed the 32-bit range in Q24, so they're computed in Q16
+//   before being scaled by dt; this truncates them by 2^-16, which is far
+//   below anything that shows up in the DAC output but does make the orbits
+//   diverge from the exact path over time (as any change to a chaotic system
+//   would). software/host_tests/lorenz_test bounds how far the long-run
+//   output statistics drift apart.
+template <size_t N>
+class LorenzEngine {
+ public:
+  LorenzEngine() : fast_(false) { }
+
+  void Init() {
+    for (size_t i = 0; i < N; ++i) {
+      Reset(i);
+      set_rho(i, 0);
+      Ldt_[i] = Rdt_[i] = 0;
+    }
+    fast_ = false;
+  }
+
+  void Reset(size_t i) {
+    Lx_[i] = 0.1 * (1 << 24);
+    Ly_[i] = 0;
+    Lz_[i] = 0;
+    Rx_[i] = 0.1 * (1 << 24);
+    Ry_[i] = 0;
+    Rz_[i] = 0;
+  }
+
+  inline void set_rho(size_t i, int16_t rho) {
+    rho_[i] = (rho * (1 << 13)) + 24.0 * (1 << 24) ; // was 12
+    c_[i] = (rho + (6 << 3)) * (1 << 13) ; // was 13
+  }
+
+  // freq is 0-65535, only the upper 8 bits are used
+  inline void set_rate(size_t i, int32_t freq, uint8_t freq_range) {
+    int32_t rate = freq >> 8;
+    CONSTRAIN(rate, 0, 255);
+    Ldt_[i] = lut_lorenz_rate[rate] >> (5 - freq_range); // was 5
+    Rdt_[i] = lut_lorenz_rate[rate];
+  }
+
+  inline void set_fast(bool fast) {
+    fast_ = fast;
+  }
+
+  // One Euler step for each attractor
+  void Process() {
+    if (fast_) StepFast();
+    else StepExact();
+  }
+
+  // Outputs, scaled to DAC codes
+  inline int32_t lorenz_x(size_t i) const { return ((Lx_[i] * 3) >> 16) + 32769; }
+  inline int32_t lorenz_y(size_t i) const { return ((Ly_[i] * 3) >> 16) + 32769; }
+  inline int32_t lorenz_z(size_t i) const { return ((Lz_[i] * 3) >> 16); }
+  inline int32_t rossler_x(size_t i) const { return (Rx_[i] >> 14) + 32769; }
+  inline int32_t rossler_y(size_t i) const { return (Ry_[i] >> 14) + 32769; }
+  inline int32_t rossler_z(size_t i) const { return (Rz_[i] >> 14); }
+
+ private:
+  int32_t Lx_[N], Ly_[N], Lz_[N];
+  int32_t Rx_[N], Ry_[N], Rz_[N];
+  int32_t rho_[N], c_[N];
+  int32_t Ldt_[N], Rdt_[N];
+  bool fast_;
+
+  void StepExact() {
+    for (size_t i = 0; i < N; ++i) {
+      const int64_t Ldt = Ldt_[i];
+      const int64_t rho = rho_[i];
+      int32_t Lx = Lx_[i] + (Ldt * ((kLorenzSigma * (Ly_[i] - Lx_[i])) >> 24) >> 24);
+      int32_t Ly = Ly_[i] + (Ldt * ((Lx_[i] * (rho - Lz_[i]) >> 24) - Ly_[i]) >> 24);
+      int32_t Lz = Lz_[i] + (Ldt * ((Lx_[i] * int64_t(Ly_[i]) >> 24) - (kLorenzBeta * Lz_[i] >> 24)) >> 24);
+      Lx_[i] = Lx;
+      Ly_[i] = Ly;
+      Lz_[i] = Lz;
+
+      const int64_t Rdt = Rdt_[i];
+      const int64_t c = c_[i];
+      int32_t Rx = Rx_[i] + ((Rdt * (-Ry_[i] - Rz_[i] )) >> 24);
+      int32_t Ry = Ry_[i] + ((Rdt * (Rx_[i] + ((kRosslerA * Ry_[i]) >> 24))) >> 24);
+      int32_t Rz = Rz_[i] + ((Rdt * (kRosslerB + ((Rz_[i] * (Rx_[i] - c)) >> 24)))  >> 24);
+      Rx_[i] = Rx;
+      Ry_[i] = Ry;
+      Rz_[i] = Rz;
+    }
+  }
+
+  void StepFast() {
+    // Constants pre-shifted so that multiply_32x32_rshift32 yields Q16
+    // (or Q24, for kRosslerA)
+    const int32_t beta = kLorenzBeta;
+    const int32_t a = kRosslerA << 8;
+    const int32_t b = kRosslerB >> 8;
+    for (size_t i = 0; i < N; ++i) {
+      const int32_t Ldt = Ldt_[i];
+      int32_t dLy = multiply_32x32_rshift32(Lx_[i], rho_[i] - Lz_[i]) - (Ly_[i] >> 8);
+      int32_t dLz = multiply_32x32_rshift32(Lx_[i], Ly_[i]) - multiply_32x32_rshift32(beta, Lz_[i]);
+      int32_t Lx = Lx_[i] + ((int64_t)(Ldt * 10) * (Ly_[i] - Lx_[i]) >> 24);
+      int32_t Ly = Ly_[i] + ((int64_t)Ldt * dLy >> 16);
+      int32_t Lz = Lz_[i] + ((int64_t)Ldt * dLz >> 16);
+      Lx_[i] = Lx;
+      Ly_[i] = Ly;
+      Lz_[i] = Lz;
+
+      const int32_t Rdt = Rdt_[i];
+      int32_t dRy = Rx_[i] + multiply_32x32_rshift32(a, Ry_[i]);
+      int32_t dRz = b + multiply_32x32_rshift32(Rz_[i], Rx_[i] - c_[i]);
+      int32_t Rx = Rx_[i] + ((int64_t)Rdt * (-Ry_[i] - Rz_[i]) >> 24);
+      int32_t Ry = Ry_[i] + ((int64_t)Rdt * dRy >> 24);
+      int32_t Rz = Rz_[i] + ((int64_t)Rdt * dRz >> 16);
+      Rx_[i] = Rx;
+      Ry_[i] = Ry;
+      Rz_[i] = Rz;
+    }
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(LorenzEngine);
+};
+
+// Two-channel Lorenz/Rössler generator with assignable outputs, as used by
+// the Lorenz app.
 class LorenzGenerator {
  public:
   LorenzGenerator() { }
@@ -84,17 +224,11 @@ class LorenzGenerator {
 
  
   inline void set_rho1(int16_t rho) {
-    // rho1_ = ((double)(rho) * (1 << 13)) + 24.0 * (1 << 24) ; // was 12
-    // c1_ = (double)(rho + (6 << 3)) * (1 << 13) ; // was 13
-    rho1_ = (rho * (1 << 13)) + 24.0 * (1 << 24) ; // was 12
-    c1_ = (rho + (6 << 3)) * (1 << 13) ; // was 13
+    engine_.set_rho(0, rho);
   }
 
   inline void set_rho2(int16_t rho) {
-    // rho2_ = ((double)(rho) * (1 << 13)) + 24.0 * (1 << 24) ; // was 12
-    // c2_ = (double)(rho + (6 << 3)) * (1 << 13) ; // was 13
-    rho2_ = (rho * (1 << 13)) + 24.0 * (1 << 24) ; // was 12
-    c2_ = (rho + (6 << 3)) * (1 << 13) ; // was 13
+    engine_.set_rho(1, rho);
   }
 
   inline void set_out_a(uint8_t out_a) {
@@ -118,15 +252,10 @@ class LorenzGenerator {
   }
 
  private:
-  int32_t Lx1_, Ly1_, Lz1_;
-  int32_t Rx1_, Ry1_, Rz1_;
-  int32_t Lx2_, Ly2_, Lz2_;
-  int32_t Rx2_, Ry2_, Rz2_;
+  LorenzEngine<2> engine_;
 
   uint8_t out_a_, out_b_, out_c_, out_d_ ;
 
-  int64_t sigma_, rho1_, rho2_, beta_, c1_,  c2_ ;
-  
   // O+C
   uint16_t dac_code_[kNumChannels];
  
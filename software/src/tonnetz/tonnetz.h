@@ -45,7 +45,7 @@ namespace tonnetz {
     "*", "P", "L", "R", "N", "S", "H", "@"
   };
 
-  static struct transformation {
+  static const struct transformation {
     size_t root_shift; // +1 = root -> third, +2 root -> fifth
     int offsets[abstract_triad::NOTES]; // root, third, fifth
   } transformations[TRANSFORM_LAST][2] = {
@@ -58,14 +58,53 @@ namespace tonnetz {
     { { 2, { -1, -1,  1 } }, { 1, { -1,  1,  1 } } }, // TRANSFORM_H
   };
 
+  struct transition {
+    uint8_t root_index;
+    int8_t offsets[abstract_triad::NOTES]; // in note order
+  };
+
+  // A transformation only depends on the chord's mode and root index, so the
+  // per-note offsets and resulting root index are tabulated for all of them:
+  // transformations[type][mode] rotated to the root index. This also makes it
+  // cheap to look several transforms ahead. As a const aggregate the table is
+  // placed in flash instead of being built in RAM at startup.
+  static const transition transitions[TRANSFORM_LAST][MODE_LAST][abstract_triad::NOTES] = {
+    { // NONE
+      { { 0, {  0,  0,  0 } }, { 1, {  0,  0,  0 } }, { 2, {  0,  0,  0 } } }, // major
+      { { 0, {  0,  0,  0 } }, { 1, {  0,  0,  0 } }, { 2, {  0,  0,  0 } } }  // minor
+    },
+    { // TRANSFORM_P
+      { { 0, {  0, -1,  0 } }, { 1, {  0,  0, -1 } }, { 2, { -1,  0,  0 } } }, // major
+      { { 0, {  0,  1,  0 } }, { 1, {  0,  0,  1 } }, { 2, {  1,  0,  0 } } }  // minor
+    },
+    { // TRANSFORM_L
+      { { 1, { -1,  0,  0 } }, { 2, {  0, -1,  0 } }, { 0, {  0,  0, -1 } } }, // major
+      { { 2, {  0,  0,  1 } }, { 0, {  1,  0,  0 } }, { 1, {  0,  1,  0 } } }  // minor
+    },
+    { // TRANSFORM_R
+      { { 2, {  0,  0,  2 } }, { 0, {  2,  0,  0 } }, { 1, {  0,  2,  0 } } }, // major
+      { { 1, { -2,  0,  0 } }, { 2, {  0, -2,  0 } }, { 0, {  0,  0, -2 } } }  // minor
+    },
+    { // TRANSFORM_N
+      { { 1, {  0,  1,  1 } }, { 2, {  1,  0,  1 } }, { 0, {  1,  1,  0 } } }, // major
+      { { 2, { -1, -1,  0 } }, { 0, {  0, -1, -1 } }, { 1, { -1,  0, -1 } } }  // minor
+    },
+    { // TRANSFORM_S
+      { { 0, {  1,  0,  1 } }, { 1, {  1,  1,  0 } }, { 2, {  0,  1,  1 } } }, // major
+      { { 0, { -1,  0, -1 } }, { 1, { -1, -1,  0 } }, { 2, {  0, -1, -1 } } }  // minor
+    },
+    { // TRANSFORM_H
+      { { 2, { -1, -1,  1 } }, { 0, {  1, -1, -1 } }, { 1, { -1,  1, -1 } } }, // major
+      { { 1, { -1,  1,  1 } }, { 2, {  1, -1,  1 } }, { 0, {  1,  1, -1 } } }  // minor
+    }
+  };
+
   abstract_triad apply_transformation(ETransformType type, const abstract_triad &source) {
 
-    const tonnetz::transformation &t = tonnetz::transformations[type][source.mode()];
+    const transition &t = transitions[type][source.mode()][source.root_index()];
 
     abstract_triad result = source;
-    result.change_mode();
-    result.apply_offsets(t.offsets);
-    result.shift_root(t.root_shift);
+    result.apply_transition(t.offsets, t.root_index);
     return result;
   }
 };
@@ -81,31 +81,25 @@ public:
   }
 
 
-  void render(note_t root, int inversion, int *dest) const {
-
-    // This can probably be made sleeker by computing things on the fly
-    // and by using the funky util_math.h functions, but for now it's
-    // Good Enough if it works
-
-    int offsets[NOTES] = {0,0,0};
-    size_t base_index = calc_inversion_offsets(inversion, offsets);
-
-    for (size_t n = 0; n < NOTES; ++n) {
-      const size_t index = (base_index + n) % NOTES;
-      dest[n] = root + notes_[index] + offsets[index];
-    }
+  // Switch mode and apply precomputed per-note offsets (in note order, not
+  // relative to the root); see tonnetz::apply_transformation
+  void apply_transition(const int8_t *offsets, size_t root_index) {
+    change_mode();
+    for (size_t n = 0; n < NOTES; ++n)
+      notes_[n] += offsets[n];
+    root_index_ = root_index;
   }
 
-private:
+  size_t root_index() const {
+    return root_index_;
+  }
 
-  size_t root_index_;
-  EMode mode_;
-  note_t notes_[NOTES];
+  inline void render(note_t root, int inversion, int *dest) const;
 
   // Calculate the inversion offsets and return the base note index
   // TODO I think this can be further simplified to a single division and modulo
-  size_t calc_inversion_offsets(int inversion, note_t *offsets) const {
-    size_t base_index = root_index_;
+  static size_t calc_inversion_offsets(size_t root_index, int inversion, note_t *offsets) {
+    size_t base_index = root_index;
     if (!inversion) {
       offsets[0] = offsets[1] = offsets[2] = 0;
     } else if (inversion > 0) {
@@ -123,6 +117,96 @@ private:
     return base_index;
   }
 
+private:
+
+  size_t root_index_;
+  EMode mode_;
+  note_t notes_[NOTES];
 };
 
+/**
+ * Rendering only depends on the root index and inversion, so for the range
+ * the apps use, which note goes to which output (and how many octaves it's
+ * shifted) is looked up instead of calculated. The table is what
+ * calc_inversion_offsets gives for each, and is const so it stays in flash.
+ */
+namespace triad_voicings {
+  static const int kMaxInversion = 6;
+
+  struct voicing {
+    uint8_t index[abstract_triad::NOTES];
+    int8_t offsets[abstract_triad::NOTES]; // semitones, per output
+  };
+
+  static const voicing voicings[abstract_triad::NOTES][2 * kMaxInversion + 1] = {
+    { // root index 0
+      { { 0, 1, 2 }, { -24, -24, -24 } }, // -6
+      { { 1, 2, 0 }, { -24, -24, -12 } }, // -5
+      { { 2, 0, 1 }, { -24, -12, -12 } }, // -4
+      { { 0, 1, 2 }, { -12, -12, -12 } }, // -3
+      { { 1, 2, 0 }, { -12, -12,   0 } }, // -2
+      { { 2, 0, 1 }, { -12,   0,   0 } }, // -1
+      { { 0, 1, 2 }, {   0,   0,   0 } }, // 0
+      { { 1, 2, 0 }, {   0,   0,  12 } }, // 1
+      { { 2, 0, 1 }, {   0,  12,  12 } }, // 2
+      { { 0, 1, 2 }, {  12,  12,  12 } }, // 3
+      { { 1, 2, 0 }, {  12,  12,  24 } }, // 4
+      { { 2, 0, 1 }, {  12,  24,  24 } }, // 5
+      { { 0, 1, 2 }, {  24,  24,  24 } }, // 6
+    },
+    { // root index 1
+      { { 1, 2, 0 }, { -24, -24, -24 } }, // -6
+      { { 2, 0, 1 }, { -24, -24, -12 } }, // -5
+      { { 0, 1, 2 }, { -24, -12, -12 } }, // -4
+      { { 1, 2, 0 }, { -12, -12, -12 } }, // -3
+      { { 2, 0, 1 }, { -12, -12,   0 } }, // -2
+      { { 0, 1, 2 }, { -12,   0,   0 } }, // -1
+      { { 1, 2, 0 }, {   0,   0,   0 } }, // 0
+      { { 2, 0, 1 }, {   0,   0,  12 } }, // 1
+      { { 0, 1, 2 }, {   0,  12,  12 } }, // 2
+      { { 1, 2, 0 }, {  12,  12,  12 } }, // 3
+      { { 2, 0, 1 }, {  12,  12,  24 } }, // 4
+      { { 0, 1, 2 }, {  12,  24,  24 } }, // 5
+      { { 1, 2, 0 }, {  24,  24,  24 } }, // 6
+    },
+    { // root index 2
+      { { 2, 0, 1 }, { -24, -24, -24 } }, // -6
+      { { 0, 1, 2 }, { -24, -24, -12 } }, // -5
+      { { 1, 2, 0 }, { -24, -12, -12 } }, // -4
+      { { 2, 0, 1 }, { -12, -12, -12 } }, // -3
+      { { 0, 1, 2 }, { -12, -12,   0 } }, // -2
+      { { 1, 2, 0 }, { -12,   0,   0 } }, // -1
+      { { 2, 0, 1 }, {   0,   0,   0 } }, // 0
+      { { 0, 1, 2 }, {   0,   0,  12 } }, // 1
+      { { 1, 2, 0 }, {   0,  12,  12 } }, // 2
+      { { 2, 0, 1 }, {  12,  12,  12 } }, // 3
+      { { 0, 1, 2 }, {  12,  12,  24 } }, // 4
+      { { 1, 2, 0 }, {  12,  24,  24 } }, // 5
+      { { 2, 0, 1 }, {  24,  24,  24 } }, // 6
+    }
+  };
+
+  inline const voicing *get(size_t root_index, int inversion) {
+    if (inversion < -kMaxInversion || inversion > kMaxInversion)
+      return nullptr;
+    return &voicings[root_index][inversion + kMaxInversion];
+  }
+};
+
+inline void abstract_triad::render(note_t root, int inversion, int *dest) const {
+  const triad_voicings::voicing *v = triad_voicings::get(root_index_, inversion);
+  if (v) {
+    for (size_t n = 0; n < NOTES; ++n)
+      dest[n] = root + notes_[v->index[n]] + v->offsets[n];
+  } else {
+    int offsets[NOTES] = {0,0,0};
+    size_t base_index = calc_inversion_offsets(root_index_, inversion, offsets);
+
+    for (size_t n = 0; n < NOTES; ++n) {
+      const size_t index = (base_index + n) % NOTES;
+      dest[n] = root + notes_[index] + offsets[index];
+    }
+  }
+}
+
 #endif // ABSTRACT_TRIAD_H_
@@ -271,6 +271,23 @@ public:
 			}
 		}
 	}
+	// Last frame of a burst; wait_eoq() then blocks until it's been shifted out,
+	// so the RX side doesn't have to be read frame by frame.
+	inline void write16_eoq(uint32_t b) __attribute__((always_inline)) {
+		uint32_t pcsbits = pcs << 16;
+		if (pcsbits) {
+			KINETISK_SPI0.PUSHR = (b & 0xFFFF) | pcsbits | SPI_PUSHR_EOQ | SPI_PUSHR_CTAS(1);
+		} else {
+			write16(b);
+		}
+	}
+	inline void wait_eoq(void) __attribute__((always_inline)) {
+		if (pcs) {
+			while (!(KINETISK_SPI0.SR & SPI_SR_EOQF)) ;
+			KINETISK_SPI0.SR = SPI_SR_EOQF;
+		}
+		clear();
+	}
 	inline uint32_t read(void) __attribute__((always_inline)) {
 		while ((KINETISK_SPI0.SR & (15 << 4)) == 0) ;  // TODO, could wait forever
 		return KINETISK_SPI0.POPR;
@@ -0,0 +1,66 @@
+#ifndef UTIL_CRC32_H_
+#define UTIL_CRC32_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace util {
+
+/**
+ * Standard CRC-32 (IEEE 802.3, reflected, as used by zlib), so host tools
+ * can verify with any off-the-shelf implementation.
+ *
+ * Uses a 16-entry nibble table instead of the usual 256-entry one; it's
+ * half as fast but only costs 64 bytes of flash, and we only ever checksum
+ * a few hundred bytes at a time.
+ */
+class CRC32 {
+public:
+  CRC32() : crc_(0xffffffff) { }
+
+  void Reset() {
+    crc_ = 0xffffffff;
+  }
+
+  void Update(const void *data, size_t length) {
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    uint32_t crc = crc_;
+    while (length--) {
+      crc ^= *p++;
+      crc = (crc >> 4) ^ table(crc & 0x0f);
+      crc = (crc >> 4) ^ table(crc & 0x0f);
+    }
+    crc_ = crc;
+  }
+
+  void Update(uint8_t b) {
+    Update(&b, 1);
+  }
+
+  uint32_t value() const {
+    return crc_ ^ 0xffffffff;
+  }
+
+  static uint32_t Compute(const void *data, size_t length) {
+    CRC32 crc;
+    crc.Update(data, length);
+    return crc.value();
+  }
+
+private:
+  uint32_t crc_;
+
+  static inline uint32_t table(uint32_t nibble) {
+    static const uint32_t nibble_table[16] = {
+      0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+      0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+      0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+      0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+    };
+    return nibble_table[nibble];
+  }
+};
+
+}; // namespace util
+
+#endif // UTIL_CRC32_H_
@@ -85,20 +85,14 @@ public:
 
   	switch (n_) {
       case 0:
-      	x_ = OC::Strings::pi_digits[k_];
+      	x_ = OC::Strings::digit(OC::Strings::pi_digits, k_);
       	break;
       case 1:
-        x_ = OC::Strings::phi_digits[k_];
+        x_ = OC::Strings::digit(OC::Strings::phi_digits, k_);
         break;
-//       case 2:
-//       	x_ = OC::Strings::tau_digits[k_];
-//       	break;
       case 2:
-        x_ = OC::Strings::eul_digits[k_];
+        x_ = OC::Strings::digit(OC::Strings::eul_digits, k_);
         break;
-//       case 4:
-//       	x_ = OC::Strings::rt2_digits[k_];
-//       	break;
       case 3:
       	x_ = OC::Strings::van_eck[k_];
       	break;
@@ -144,6 +138,12 @@ public:
       case 10:
       	x_ = OC::Strings::interspersion_of_A163253[k_];
       	break;      	
+      case 11:
+        x_ = OC::Strings::digit(OC::Strings::tau_digits, k_);
+        break;
+      case 12:
+        x_ = OC::Strings::digit(OC::Strings::rt2_digits, k_);
+        break;
       default:
         break;
     }
@@ -25,28 +25,32 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include "util_math.h"
 
 namespace util {
 
+// x and r are Q24. Since x stays in [0, 1] and r in [3, 4), both products fit
+// a 32x32 -> 64 multiply whose result is shifted back down by 24, so Clock()
+// uses a single umull per product instead of int64 math. This is bit-exact
+// with the previous int64_t implementation (truncating, as before).
 class LogisticMap {
 public:
-  static const int64_t kONE = 1 << 24;
-  static const int64_t kDefaultSeed = 1 << 16; // 1.0 = 1 << 24
-  static const int64_t kDefaultR = 3.6 * kONE;
+  static const uint32_t kONE = 1 << 24;
+  static const uint32_t kDefaultSeed = 1 << 16; // 1.0 = 1 << 24
+  static const uint32_t kDefaultR = 3.6 * kONE;
 
   void Init() {
     x_ = seed_ = kDefaultSeed;
     r_ = kDefaultR;
   }
 
-  int64_t Clock() {
-    next_x_ = (r_ * ((x_ * (kONE - x_)) >> 24)) >> 24;
-    x_ = next_x_;
-    return x_ ;
+  uint32_t Clock() {
+    x_ = multiply_u32xu32_rshift24(r_, multiply_u32xu32_rshift24(x_, kONE - x_));
+    return x_;
   }
 
   void set_seed(uint8_t seed) {
-    if (seed_ != seed << 16) {
+    if (seed_ != static_cast<uint32_t>(seed << 16)) {
       seed_ = seed << 16 ; // seed range 1 to 255 = 1/256 to 1
       x_ = seed_;
     }
@@ -61,10 +65,9 @@ public:
   }
 
 private:
-  int64_t seed_;
-  int64_t r_;
-  int64_t x_;
-  int64_t next_x_;
+  uint32_t seed_;
+  uint32_t r_;
+  uint32_t x_;
 };
 
 }; // namespace util
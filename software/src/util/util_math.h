@@ -23,6 +23,11 @@
 #ifndef UTIL_MATH_H_
 #define UTIL_MATH_H_
 
+#include <stdint.h>
+
+// The asm helpers below have portable versions for host builds (see
+// software/host_tests).
+
 // Woo. Funky macro magic to avoid dividing by non-power-of-two.
 // Essentially a quick fixed-point calculation, but only valid up to 2^exp
 
@@ -40,32 +45,49 @@
 
 inline uint32_t USAT16(uint32_t value) __attribute__((always_inline));
 inline uint32_t USAT16(uint32_t value) {
+#ifdef __arm__
   uint32_t result;
   __asm("usat %0, %1, %2" : "=r" (result) : "I" (16), "r" (value));
   return result;
+#else
+  const int32_t signed_value = value; // usat saturates signed values
+  return signed_value < 0 ? 0 : (signed_value > 0xffff ? 0xffff : signed_value);
+#endif
 }
 
 inline uint32_t USAT16(int32_t value) __attribute__((always_inline));
 inline uint32_t USAT16(int32_t value) {
+#ifdef __arm__
   uint32_t result;
   __asm("usat %0, %1, %2" : "=r" (result) : "I" (16), "r" (value));
   return result;
+#else
+  return value < 0 ? 0 : (value > 0xffff ? 0xffff : value);
+#endif
 }
 
 static inline uint32_t multiply_u32xu32_rshift24(uint32_t a, uint32_t b) __attribute__((always_inline));
 static inline uint32_t multiply_u32xu32_rshift24(uint32_t a, uint32_t b)
 {
+#ifdef __arm__
   register uint32_t lo, hi;
   asm volatile("umull %0, %1, %2, %3" : "=r" (lo), "=r" (hi) : "r" (a), "r" (b));
   return (lo >> 24) | (hi << 8);
+#else
+  return static_cast<uint32_t>((static_cast<uint64_t>(a) * b) >> 24);
+#endif
 }
 
 static inline uint32_t multiply_u32xu32_rshift(uint32_t a, uint32_t b, uint32_t shift) __attribute__((always_inline));
 static inline uint32_t multiply_u32xu32_rshift(uint32_t a, uint32_t b, uint32_t shift)
 {
+#ifdef __arm__
   register uint32_t lo, hi;
   asm volatile("umull %0, %1, %2, %3" : "=r" (lo), "=r" (hi) : "r" (a), "r" (b));
   return (lo >> shift) | (hi << (32 - shift));
+#else
+  return static_cast<uint32_t>((static_cast<uint64_t>(a) * b) >> shift);
+#endif
 }
 
 template <typename T, T smoothing>
@@ -23,7 +23,10 @@
 #ifndef PAGESTORAGE_H_
 #define PAGESTORAGE_H_
 
+#include <stddef.h>
+#include <string.h>
 #include "util_misc.h"
+#include "util_crc32.h"
 
 //#define DEBUG_STORAGE
 #ifdef DEBUG_STORAGE
@@ -58,6 +61,27 @@ enum EStorageMode {
  * The optional FASTSCAN parameter to can be used for force a scan of all pages
  * during ::load. If it is true, the scan stops at the first non-good page,
  * which is faster but might miss pages if a write is corrupted.
+ *
+ * Saving can be split up using ::BeginSave and ::Commit, so that the actual
+ * (slow) storage writes can be spread over several main loop iterations. The
+ * data is written before the header, and the generation last, so a commit that
+ * is cut short leaves a page that either fails the checksum or is complete;
+ * with more than one page, ::load then falls back to the previous one.
+ *
+ * With a single page there's nothing to fall back to, so the space after the
+ * page (if there's enough) is used as a redo journal instead: ::BeginSave
+ * records the bytes that change, and ::Commit writes that record and marks it
+ * complete before touching the page, and clears it afterwards. If a commit is
+ * cut short after the record was completed, ::load first finishes it from the
+ * record. The journal is small, so a save that changes more bytes than it
+ * holds is written without one, as above.
+ *
+ * A save without a journal first invalidates the FOURCC of the page it's
+ * about to overwrite, until the header is written. Cutting it short loses
+ * that page, but never leaves one that loads with a mix of old and new data.
+ *
+ * The checksum covers the header too (apart from itself); pages written
+ * before it did are still accepted.
  */
 template <typename STORAGE, size_t BASE_ADDR, size_t END_ADDR, typename DATA_TYPE, EStorageMode MODE = STORAGE_UPDATE, bool FASTSCAN=true>
 class PageStorage {
@@ -79,6 +103,19 @@ protected:
 
   } __attribute__((aligned(2)));
 
+  /**
+   * Journal record header; followed by entries of uint16_t page offset,
+   * uint8_t count, and count bytes.
+   */
+  struct journal_header {
+    uint16_t marker;
+    uint16_t length; // of the entries
+    uint32_t crc; // of length and the entries
+  };
+
+  static const uint16_t JOURNAL_MARKER = 0x524a;
+  static const size_t JOURNAL_ENTRY_SIZE = sizeof(uint16_t) + sizeof(uint8_t);
+
 public:
 
   static const size_t LENGTH = END_ADDR - BASE_ADDR;
@@ -90,6 +127,13 @@ public:
   // throw compiler error if OOB
   typedef bool CHECK_BASEADDR[BASE_ADDR + LENGTH > STORAGE::LENGTH ? -1 : 1];
 
+  static const size_t JOURNAL_ADDR = BASE_ADDR + PAGES * PAGESIZE;
+  // Only used with a single page, and if there's room for a few entries
+  static const size_t JOURNAL_LENGTH =
+      (1 == PAGES && END_ADDR - JOURNAL_ADDR >= sizeof(journal_header) + 4 * (JOURNAL_ENTRY_SIZE + 1))
+      ? (END_ADDR - JOURNAL_ADDR < 0xffff ? END_ADDR - JOURNAL_ADDR : 0xffff)
+      : 0;
+
   /**
    * @return index of page in storage; only valid after ::load
    */
@@ -102,6 +146,8 @@ public:
    */
   void Init() {
     page_index_ = -1;
+    commit_pos_ = commit_prefix_ = commit_length_ = 0;
+    journal_length_ = 0;
     page_.header.fourcc = DATA_TYPE::FOURCC;
     page_.header.size = sizeof(DATA_TYPE);
   }
@@ -115,6 +161,10 @@ public:
   bool Load(DATA_TYPE &data) {
 
     page_index_ = -1;
+    commit_pos_ = commit_prefix_ = commit_length_ = 0;
+    journal_length_ = 0;
+    Recover();
+
     memset(&page_, 0, sizeof(page_));
     page_.header.generation = -1;
     page_data next_page;
@@ -128,7 +178,8 @@ public:
 
       if ((DATA_TYPE::FOURCC != next_page.header.fourcc) ||
           (sizeof(DATA_TYPE) != next_page.header.size) ||
-          (next_page.header.checksum != checksum(next_page)) ||
+          (next_page.header.checksum != checksum(next_page) &&
+           next_page.header.checksum != checksum(next_page, false)) ||
           (next_page.header.generation < page_.header.generation && (int32_t)page_.header.generation != -1)) {
         if (FASTSCAN) {
           STORAGE_PRINTF("Aborting scan at page %d\n", i);
@@ -159,44 +210,241 @@ public:
    * @return true if data was written to storage
    */
   bool Save(const DATA_TYPE &data) {
+    bool dirty = BeginSave(data);
+    Flush();
+    return dirty;
+  }
+
+  /**
+   * Prepare saving data, but leave the writing to ::Commit. The data is copied,
+   * so it's safe to modify once this returns. A commit that is still in
+   * progress is finished first. Assumes ::load has been called!
+   * @param data data to be stored
+   * @return true if data has changed and needs to be committed
+   */
+  bool BeginSave(const DATA_TYPE &data) {
+    Flush();
 
+    JournalBegin();
     bool dirty = false;
     const uint8_t *src = (const uint8_t*)&data;
     uint8_t *dst = (uint8_t*)&page_.data;
-    size_t length = sizeof(DATA_TYPE);
-    while (length--) {
+    for (size_t i = 0; i < sizeof(DATA_TYPE); ++i, ++dst, ++src) {
       if (*dst != *src) {
         dirty = true;
         *dst = *src;
+        JournalAdd(sizeof(page_header) + i, *src);
       }
-      ++dst;
-      ++src;
     }
 
     if (dirty) {
+      const page_header previous = page_.header;
       ++page_.header.generation;
       page_.header.checksum = checksum(page_);
-      page_index_ = (page_index_ + 1) % PAGES;
+      for (size_t i = 0; i < sizeof(page_header); ++i) {
+        const uint8_t b = ((const uint8_t *)&page_.header)[i];
+        if (((const uint8_t *)&previous)[i] != b)
+          JournalAdd(i, b);
+      }
 
-      if (STORAGE_UPDATE == MODE)
-        STORAGE::update(BASE_ADDR + page_index_ * PAGESIZE, &page_, sizeof(page_));
-      else
-        STORAGE::write(BASE_ADDR + page_index_ * PAGESIZE, &page_, sizeof(page_));
+      page_index_ = (page_index_ + 1) % PAGES;
+      JournalEnd();
+      commit_pos_ = 0;
+      commit_prefix_ = journal_length_ ? journal_length_ : 1;
+      commit_length_ = commit_prefix_ + PAGESIZE + (journal_length_ ? sizeof(uint16_t) : 0);
     }
 
     return dirty;
   }
 
+  /**
+   * Write up to max_bytes of the pending save.
+   * @return true if there's still more to write
+   */
+  bool Commit(size_t max_bytes) {
+    const uint8_t *src = (const uint8_t *)&page_;
+    const size_t page_addr = BASE_ADDR + page_index_ * PAGESIZE;
+    while (commit_pos_ < commit_length_ && max_bytes--) {
+      size_t pos = commit_pos_++;
+      if (pos < commit_prefix_) {
+        if (journal_length_) {
+          size_t offset = journal_offset(pos);
+          write_byte(JOURNAL_ADDR + offset, journal_[offset]);
+        } else {
+          write_byte(page_addr, src[0] ^ 0xff); // FOURCC is restored with the header
+        }
+      } else if ((pos -= commit_prefix_) < PAGESIZE) {
+        size_t offset = commit_offset(pos);
+        write_byte(page_addr + offset, src[offset]);
+      } else {
+        // The page is complete, retire the journal record
+        write_byte(JOURNAL_ADDR + pos - PAGESIZE, 0);
+      }
+    }
+    return commit_pos_ < commit_length_;
+  }
+
+  /**
+   * Finish the pending save, if any.
+   */
+  void Flush() {
+    while (Commit(PAGESIZE)) { }
+  }
+
+  /**
+   * @return true if a save has been started but not fully written
+   */
+  bool committing() const {
+    return commit_pos_ < commit_length_;
+  }
+
 protected:
 
   int page_index_;
   page_data page_;
+  size_t commit_pos_;
+  size_t commit_prefix_; // Journal, or FOURCC invalidation, before the page
+  size_t commit_length_;
+
+  // Record of the pending save, as written to the journal; journal_length_ is
+  // 0 if it isn't journaled
+  uint8_t journal_[JOURNAL_LENGTH ? JOURNAL_LENGTH : 1];
+  size_t journal_length_;
+  size_t journal_entry_; // Position of the last entry
+  bool journal_full_;
 
-  static uint16_t checksum(const page_data &page) {
+  static const size_t GENERATION_OFFSET = offsetof(page_header, generation);
+  static const size_t GENERATION_SIZE = sizeof(uint32_t);
+  static const size_t CHECKSUM_OFFSET = offsetof(page_header, checksum);
+
+  // Commit order: data, then the header minus generation, then generation
+  static size_t commit_offset(size_t pos) {
+    if (pos < PAGESIZE - sizeof(page_header))
+      return sizeof(page_header) + pos;
+    pos -= PAGESIZE - sizeof(page_header);
+    if (pos < GENERATION_OFFSET)
+      return pos;
+    pos -= GENERATION_OFFSET;
+    if (pos < sizeof(page_header) - GENERATION_OFFSET - GENERATION_SIZE)
+      return GENERATION_OFFSET + GENERATION_SIZE + pos;
+    pos -= sizeof(page_header) - GENERATION_OFFSET - GENERATION_SIZE;
+    return GENERATION_OFFSET + pos;
+  }
+
+  // Journal order: entries, then the rest of the header, then the marker
+  size_t journal_offset(size_t pos) const {
+    if (pos < journal_length_ - sizeof(journal_header))
+      return sizeof(journal_header) + pos;
+    pos -= journal_length_ - sizeof(journal_header);
+    if (pos < sizeof(journal_header) - sizeof(uint16_t))
+      return sizeof(uint16_t) + pos;
+    return pos - (sizeof(journal_header) - sizeof(uint16_t));
+  }
+
+  static void write_byte(size_t addr, uint8_t value) {
+    if (STORAGE_UPDATE == MODE)
+      STORAGE::update(addr, &value, 1);
+    else
+      STORAGE::write(addr, &value, 1);
+  }
+
+  void JournalBegin() {
+    journal_length_ = sizeof(journal_header);
+    journal_entry_ = 0;
+    journal_full_ = !JOURNAL_LENGTH;
+  }
+
+  void JournalAdd(size_t offset, uint8_t value) {
+    if (journal_full_)
+      return;
+
+    // Extend the last entry if this byte follows on from it
+    if (journal_entry_) {
+      uint8_t *entry = journal_ + journal_entry_;
+      uint16_t entry_offset;
+      memcpy(&entry_offset, entry, sizeof(entry_offset));
+      uint8_t count = entry[sizeof(uint16_t)];
+      if (entry_offset + count == offset && count < 0xff && journal_length_ < JOURNAL_LENGTH) {
+        entry[sizeof(uint16_t)] = count + 1;
+        journal_[journal_length_++] = value;
+        return;
+      }
+    }
+
+    if (journal_length_ + JOURNAL_ENTRY_SIZE + 1 > JOURNAL_LENGTH) {
+      STORAGE_PRINTF("Journal full, saving without\n");
+      journal_full_ = true;
+      return;
+    }
+    journal_entry_ = journal_length_;
+    const uint16_t entry_offset = offset;
+    memcpy(journal_ + journal_length_, &entry_offset, sizeof(entry_offset));
+    journal_[journal_length_ + sizeof(uint16_t)] = 1;
+    journal_[journal_length_ + JOURNAL_ENTRY_SIZE] = value;
+    journal_length_ += JOURNAL_ENTRY_SIZE + 1;
+  }
+
+  void JournalEnd() {
+    if (journal_full_) {
+      journal_length_ = 0;
+      return;
+    }
+    journal_header header;
+    header.marker = JOURNAL_MARKER;
+    header.length = journal_length_ - sizeof(journal_header);
+    header.crc = journal_crc(header.length);
+    memcpy(journal_, &header, sizeof(header));
+  }
+
+  uint32_t journal_crc(uint16_t length) const {
+    util::CRC32 crc;
+    crc.Update(&length, sizeof(length));
+    crc.Update(journal_ + sizeof(journal_header), length);
+    return crc.value();
+  }
+
+  // Finish a save whose journal record is complete, but might not have made
+  // it to the page
+  void Recover() {
+    if (!JOURNAL_LENGTH)
+      return;
+
+    journal_header header;
+    STORAGE::read(JOURNAL_ADDR, &header, sizeof(header));
+    if (JOURNAL_MARKER != header.marker || header.length > JOURNAL_LENGTH - sizeof(journal_header))
+      return;
+    STORAGE::read(JOURNAL_ADDR, journal_, sizeof(journal_header) + header.length);
+    if (header.crc != journal_crc(header.length))
+      return;
+
+    STORAGE_PRINTF("Replaying journal (%u bytes)\n", header.length);
+    const uint8_t *entry = journal_ + sizeof(journal_header);
+    const uint8_t *end = entry + header.length;
+    while (entry + JOURNAL_ENTRY_SIZE <= end) {
+      uint16_t offset;
+      memcpy(&offset, entry, sizeof(offset));
+      uint8_t count = entry[sizeof(uint16_t)];
+      entry += JOURNAL_ENTRY_SIZE;
+      if (entry + count > end || offset + count > PAGESIZE)
+        break;
+      for (uint8_t i = 0; i < count; ++i)
+        write_byte(BASE_ADDR + offset + i, entry[i]);
+      entry += count;
+    }
+    write_byte(JOURNAL_ADDR, 0);
+    write_byte(JOURNAL_ADDR + 1, 0);
+  }
+
+  // Without the header, for pages written before it was included
+  static uint16_t checksum(const page_data &page, bool include_header = true) {
     uint16_t c = 0;
-    // header not included in crc
-    const uint8_t *p = (const uint8_t *)&page.data;
-    size_t length = sizeof(page_data) - sizeof(page_header);
+    const uint8_t *p = (const uint8_t *)&page.header;
+    size_t length = include_header ? CHECKSUM_OFFSET : 0;
+    while (length--) {
+      c += *p++;
+    }
+    p = (const uint8_t *)&page.data;
+    length = sizeof(page_data) - sizeof(page_header);
     while (length--) {
       c += *p++;
     }
@@ -206,4 +454,3 @@ protected:
 };
 
 #endif // PAGESTORAGE_H_
-
@@ -68,6 +68,13 @@ public:
     write_ptr_ = read_ptr_ = 0;
   }
 
+  // Most recently written item. The producer may only modify this while at
+  // least one older item is readable, since the consumer might be in the
+  // middle of reading the oldest one.
+  inline T &Back() {
+    return buffer_[(write_ptr_ - 1) & (size - 1)];
+  }
+
   inline T Poke(size_t index_offset) {
     size_t read_ptr = (poke_ptr_ - 1) - index_offset;
     T value = buffer_[read_ptr & (size - 1)];
@@ -0,0 +1,116 @@
+#ifndef UTIL_SCOPE_H_
+#define UTIL_SCOPE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace util {
+
+/**
+ * Multi-channel scope capture with min/max decimation.
+ *
+ * Each of the `width` columns covers 2^decimation samples, and keeps the
+ * smallest and largest sample per channel instead of just one of them, so a
+ * spike that's shorter than a column still shows up. Samples are 8 bits;
+ * scaling them is up to the caller.
+ *
+ * Captures are double-buffered: Push writes into one buffer while the last
+ * complete capture is readable from the other, and the two are swapped when
+ * the last column is done. frames() counts completed captures, so a reader can
+ * tell when it needs to rebuild whatever it derives from them.
+ *
+ * Push does the same (small) amount of work on every call regardless of the
+ * decimation.
+ */
+template <size_t width, size_t channels>
+class ScopeCapture {
+public:
+  static constexpr size_t kWidth = width;
+  static constexpr size_t kChannels = channels;
+  static constexpr uint8_t kMaxDecimation = 15;
+
+  struct Column {
+    uint8_t min;
+    uint8_t max;
+  };
+
+  void Init(uint8_t decimation) {
+    memset(columns_, 0, sizeof(columns_));
+    ready_ = 0;
+    frames_ = 0;
+    set_decimation(decimation);
+  }
+
+  // Changing the decimation discards the capture in progress
+  void set_decimation(uint8_t decimation) {
+    if (decimation > kMaxDecimation) decimation = kMaxDecimation;
+    decimation_ = decimation;
+    Restart();
+  }
+
+  void Restart() {
+    column_ = 0;
+    count_ = 0;
+    ResetColumn();
+  }
+
+  inline void Push(const uint8_t *samples) {
+    for (size_t ch = 0; ch < channels; ++ch) {
+      if (samples[ch] < acc_[ch].min) acc_[ch].min = samples[ch];
+      if (samples[ch] > acc_[ch].max) acc_[ch].max = samples[ch];
+    }
+
+    if (++count_ >> decimation_) {
+      const uint8_t writing = ready_ ^ 1;
+      for (size_t ch = 0; ch < channels; ++ch)
+        columns_[writing][ch][column_] = acc_[ch];
+      ResetColumn();
+      count_ = 0;
+
+      if (++column_ >= width) {
+        column_ = 0;
+        ready_ = writing;
+        ++frames_;
+      }
+    }
+  }
+
+  inline uint8_t decimation() const {
+    return decimation_;
+  }
+
+  inline uint32_t frames() const {
+    return frames_;
+  }
+
+  // Column currently being captured
+  inline size_t position() const {
+    return column_;
+  }
+
+  // Last complete capture
+  inline const Column &column(size_t ch, size_t x) const {
+    return columns_[ready_][ch][x];
+  }
+
+private:
+  Column columns_[2][channels][width];
+  Column acc_[channels];
+  volatile uint8_t ready_;
+  volatile uint32_t frames_;
+  uint8_t decimation_;
+  uint16_t count_;
+  size_t column_;
+
+  inline void ResetColumn() {
+    for (size_t ch = 0; ch < channels; ++ch) {
+      acc_[ch].min = 0xff;
+      acc_[ch].max = 0;
+    }
+  }
+};
+
+}; // namespace util
+
+#endif // UTIL_SCOPE_H_
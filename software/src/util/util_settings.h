@@ -68,7 +68,10 @@ struct value_attr {
 // type as specified in the attributes. For even more compact representations,
 // the owning class can pack things differently if required.
 //
-// TODO: Save/Restore is still kind of sucky
+// Save/Restore don't keep any state between calls and the layout only depends
+// on value_attr_, so a class can be saved straight back into the storage it was
+// restored from and unchanged settings leave their bytes as they were.
+//
 // TODO: If absolutely necessary, add STORAGE_TYPE_BIT and pack nibbles & bits
 //
 template <typename clazz, size_t num_settings>
@@ -107,38 +110,52 @@ public:
       values_[s] = value_attr_[s].default_value();
   }
 
+  // Settings are packed in order; U4 values are paired up into one byte (first
+  // nibble in the msbits), any other type starts on the next whole byte.
   size_t Save(void *storage) const {
-    nibbles_ = 0;
     uint8_t *write_ptr = static_cast<uint8_t *>(storage);
+    uint8_t *nibble_ptr = nullptr;
     for (size_t s = 0; s < num_settings; ++s) {
-      switch(value_attr_[s].storage_type) {
-        case STORAGE_TYPE_U4: write_ptr = write_nibble(write_ptr, s); break;
-        case STORAGE_TYPE_I8: write_ptr = write_setting<int8_t>(write_ptr, s); break;
-        case STORAGE_TYPE_U8: write_ptr = write_setting<uint8_t>(write_ptr, s); break;
-        case STORAGE_TYPE_I16: write_ptr = write_setting<int16_t>(write_ptr, s); break;
-        case STORAGE_TYPE_U16: write_ptr = write_setting<uint16_t>(write_ptr, s); break;
-        case STORAGE_TYPE_I32: write_ptr = write_setting<int32_t>(write_ptr, s); break;
-        case STORAGE_TYPE_U32: write_ptr = write_setting<uint32_t>(write_ptr, s); break;
+      const StorageType storage_type = value_attr_[s].storage_type;
+      if (STORAGE_TYPE_U4 == storage_type) {
+        write_ptr = write_nibble(write_ptr, nibble_ptr, values_[s]);
+        continue;
+      }
+
+      nibble_ptr = nullptr;
+      switch(storage_type) {
+        case STORAGE_TYPE_I8: write_ptr = write_setting<int8_t>(write_ptr, values_[s]); break;
+        case STORAGE_TYPE_U8: write_ptr = write_setting<uint8_t>(write_ptr, values_[s]); break;
+        case STORAGE_TYPE_I16: write_ptr = write_setting<int16_t>(write_ptr, values_[s]); break;
+        case STORAGE_TYPE_U16: write_ptr = write_setting<uint16_t>(write_ptr, values_[s]); break;
+        case STORAGE_TYPE_I32: write_ptr = write_setting<int32_t>(write_ptr, values_[s]); break;
+        case STORAGE_TYPE_U32: write_ptr = write_setting<uint32_t>(write_ptr, values_[s]); break;
+        default: break;
       }
     }
-    if (nibbles_)
-      write_ptr = flush_nibbles(write_ptr);
 
     return (size_t)(write_ptr - static_cast<uint8_t *>(storage));
   }
 
   size_t Restore(const void *storage) {
-    nibbles_ = 0;
     const uint8_t *read_ptr = static_cast<const uint8_t *>(storage);
+    const uint8_t *nibble_ptr = nullptr;
     for (size_t s = 0; s < num_settings; ++s) {
-      switch(value_attr_[s].storage_type) {
-        case STORAGE_TYPE_U4: read_ptr = read_nibble(read_ptr, s); break;
+      const StorageType storage_type = value_attr_[s].storage_type;
+      if (STORAGE_TYPE_U4 == storage_type) {
+        read_ptr = read_nibble(read_ptr, nibble_ptr, s);
+        continue;
+      }
+
+      nibble_ptr = nullptr;
+      switch(storage_type) {
         case STORAGE_TYPE_I8: read_ptr = read_setting<int8_t>(read_ptr, s); break;
         case STORAGE_TYPE_U8: read_ptr = read_setting<uint8_t>(read_ptr, s); break;
         case STORAGE_TYPE_I16: read_ptr = read_setting<int16_t>(read_ptr, s); break;
         case STORAGE_TYPE_U16: read_ptr = read_setting<uint16_t>(read_ptr, s); break;
         case STORAGE_TYPE_I32: read_ptr = read_setting<int32_t>(read_ptr, s); break;
         case STORAGE_TYPE_U32: read_ptr = read_setting<uint32_t>(read_ptr, s); break;
+        default: break;
       }
     }
     return (size_t)(read_ptr - static_cast<const uint8_t *>(storage));
@@ -150,50 +167,37 @@ public:
 
 protected:
 
-  static constexpr uint16_t kNibbleValid = 0xf000;
-
   int values_[num_settings];
   static const settings::value_attr value_attr_[];
   static const size_t storage_size_;
 
-  mutable uint16_t nibbles_;
-
-  uint8_t *flush_nibbles(uint8_t *dest) const {
-    *dest++ = (nibbles_ & 0xff);
-    nibbles_ = 0;
-    return dest;
-  }
-
-  uint8_t *write_nibble(uint8_t *dest, size_t index) const {
-    if (nibbles_) {
-      nibbles_ |= (values_[index] & 0x0f);
-      dest = flush_nibbles(dest);
+  // nibble_ptr is the byte holding an unpaired nibble, if any
+  static uint8_t *write_nibble(uint8_t *dest, uint8_t *&nibble_ptr, int value) {
+    if (nibble_ptr) {
+      *nibble_ptr = (*nibble_ptr & 0xf0) | (value & 0x0f);
+      nibble_ptr = nullptr;
     } else {
-      // Ensure correct packing for reads even if there's an odd number of nibbles;
-      // the first nibble is assumed to be in the msbits.
-      nibbles_ = kNibbleValid | ((values_[index] & 0x0f) << 4);
+      nibble_ptr = dest;
+      *dest++ = (value & 0x0f) << 4;
     }
     return dest;
   }
 
   template <typename storage_type>
-  uint8_t *write_setting(uint8_t *dest, size_t index) const {
-    if (nibbles_)
-      dest = flush_nibbles(dest);
+  static uint8_t *write_setting(uint8_t *dest, int value) {
     storage_type *storage = reinterpret_cast<storage_type *>(dest);
-    *storage++ = values_[index];
+    *storage++ = value;
     return reinterpret_cast<uint8_t *>(storage);
   }
 
-  const uint8_t *read_nibble(const uint8_t *src, size_t index) {
+  const uint8_t *read_nibble(const uint8_t *src, const uint8_t *&nibble_ptr, size_t index) {
     uint8_t value;
-    if (nibbles_) {
-      value = nibbles_ & 0x0f;
-      nibbles_ = 0;
+    if (nibble_ptr) {
+      value = *nibble_ptr & 0x0f;
+      nibble_ptr = nullptr;
     } else {
-      value = *src++;
-      nibbles_ = kNibbleValid | value;
-      value >>= 4;
+      nibble_ptr = src;
+      value = *src++ >> 4;
     }
     apply_value(index, value);
     return src;
@@ -201,7 +205,6 @@ protected:
 
   template <typename storage_type>
   const uint8_t *read_setting(const uint8_t *src, size_t index) {
-    nibbles_ = 0;
     const storage_type *storage = reinterpret_cast<const storage_type*>(src);
     apply_value(index, *storage++);
     return reinterpret_cast<const uint8_t *>(storage);
@@ -26,10 +26,10 @@
 
 namespace util {
 
-// Helper class to manage delayed triggers. The active triggers are maintained
-// in a register of bits that is shifted on each Update. Uses an array of
-// uint32_t to support "long" delays (in OC: 67 * 60us, i.e. 3xuint32_t)
-// Could be special-cased for max_delay < 32 without array overhead.
+// Helper class to manage delayed triggers. The pending triggers are kept as
+// bits in a ring that's at least max_delay + 1 long; Update just advances the
+// read position, so the cost per tick doesn't depend on the delay length
+// (in OC: 96 * 60us, i.e. a 128 bit ring in 4xuint32_t).
 
 template <size_t max_delay>
 class TriggerDelay {
@@ -41,30 +41,144 @@ public:
 
   void Init() {
     memset(delays_, 0, sizeof(uint32_t) * kEntries);
+    head_ = 0;
   }
 
   inline void Update() {
-    for (size_t i = 0; i < kEntries - 1; ++i) {
-      delays_[i] = (delays_[i] >> 1) | (delays_[i + 1] << 31);
-    }
-    delays_[kEntries - 1] = delays_[kEntries - 1] >> 1;
+    delays_[head_ >> 5] &= ~(0x1 << (head_ & 31));
+    head_ = (head_ + 1) & (kBits - 1);
   }
 
   inline void Push(size_t delay) {
-    const size_t i = delay / 32;
-    const size_t b = delay - i * 32;
-    delays_[i] |= (0x1 << b);
+    const size_t b = (head_ + delay) & (kBits - 1);
+    delays_[b >> 5] |= (0x1 << (b & 31));
   }
 
   inline bool triggered() const {
-    return delays_[0] & 0x1;
+    return delays_[head_ >> 5] & (0x1 << (head_ & 31));
   }
 
 private:
 
-  static constexpr size_t kEntries = (max_delay + 31) / 32;
+  static constexpr size_t ring_bits(size_t bits) {
+    return bits > max_delay ? bits : ring_bits(bits << 1);
+  }
+
+  static constexpr size_t kBits = ring_bits(32);
+  static constexpr size_t kEntries = kBits / 32;
 
   uint32_t delays_[kEntries];
+  size_t head_;
+};
+
+// Events that are due a number of ticks in the future, for delays that are
+// too long (or too many) for the bit ring above. The events are kept in a
+// min-heap, so Tick and checking for the next due event are O(1), and only
+// Push and Pop are O(log capacity).
+template <typename T, size_t capacity>
+class DelayQueue {
+public:
+  DelayQueue() { }
+  ~DelayQueue() { }
+
+  struct Event {
+    uint32_t due;
+    T value;
+  };
+
+  void Init() {
+    now_ = 0;
+    size_ = 0;
+  }
+
+  inline void Tick() {
+    ++now_;
+  }
+
+  inline size_t size() const {
+    return size_;
+  }
+
+  inline bool empty() const {
+    return !size_;
+  }
+
+  // Next event to be due; only valid if !empty()
+  inline const Event &next() const {
+    return events_[0];
+  }
+
+  inline uint32_t ticks_left(const Event &event) const {
+    int32_t left = static_cast<int32_t>(event.due - now_);
+    return left > 0 ? left : 0;
+  }
+
+  // The event will be due delay ticks later, i.e. after that many calls to
+  // Tick. Returns false if the queue is full.
+  bool Push(uint32_t delay, const T &value) {
+    if (size_ >= capacity)
+      return false;
+
+    size_t i = size_++;
+    const uint32_t due = now_ + delay;
+    while (i) {
+      size_t parent = (i - 1) / 2;
+      if (!earlier(due, events_[parent].due))
+        break;
+      events_[i] = events_[parent];
+      i = parent;
+    }
+    events_[i].due = due;
+    events_[i].value = value;
+    return true;
+  }
+
+  // Reschedule the next event instead of adding a new one
+  void ReplaceNext(uint32_t delay, const T &value) {
+    if (!size_) {
+      Push(delay, value);
+    } else {
+      Event event = { now_ + delay, value };
+      SiftDown(event);
+    }
+  }
+
+  // Remove the next event if it's due
+  bool Pop(T &value) {
+    if (!size_ || earlier(now_, events_[0].due))
+      return false;
+
+    value = events_[0].value;
+    if (--size_)
+      SiftDown(events_[size_]);
+    return true;
+  }
+
+private:
+  Event events_[capacity];
+  uint32_t now_;
+  size_t size_;
+
+  static inline bool earlier(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+  }
+
+  // Place event, starting at the root
+  void SiftDown(const Event event) {
+    size_t i = 0;
+    for (;;) {
+      size_t child = 2 * i + 1;
+      if (child >= size_)
+        break;
+      if (child + 1 < size_ && earlier(events_[child + 1].due, events_[child].due))
+        ++child;
+      if (!earlier(events_[child].due, event.due))
+        break;
+      events_[i] = events_[child];
+      i = child;
+    }
+    events_[i] = event;
+  }
 };
 
 }; // namespace util
@@ -90,6 +90,7 @@ public:
             memcpy(&segments[segment_count], &segment, sizeof(segments[segment_count]));
             total_time += segments[segment_count].time;
             segment_count++;
+            tables_valid = 0;
         }
     }
 
@@ -100,6 +101,7 @@ public:
         memcpy(&segments[ix], &segment, sizeof(segments[ix]));
         total_time += segments[ix].time;
         if (ix == segment_count) segment_count++;
+        tables_valid = 0;
     }
 
     HS::VOSegment GetSegment(byte ix) {
@@ -107,11 +109,16 @@ public:
         return segments[ix];
     }
 
-    void SetScale(uint16_t scale_) {scale = scale_;}
+    void SetScale(uint16_t scale_) {
+        if (scale_ != scale) tables_valid = 0;
+        scale = scale_;
+    }
 
     /* frequency is centihertz (e.g., 440 Hz is 44000) */
     void SetFrequency(uint32_t frequency_) {
         frequency = frequency_;
+        // How many ticks should a complete cycle last? cycle_ticks is 10 times that number.
+        cycle_ticks = frequency ? 16666667 / frequency : 0;
         rise = calculate_rise(segment_index);
     }
 
@@ -128,7 +135,7 @@ public:
 
     void Reset() {
         segment_index = 0;
-        signal = scale_level(segments[segment_count - 1].level);
+        signal = segment_count ? level_signal(segment_count - 1) : 0;
         rise = calculate_rise(segment_index);
         sustained = 0;
         eoc = !cycle;
@@ -137,7 +144,7 @@ public:
     int32_t Next() {
     		// For non-cycling waveforms, send the level of the last step if eoc
     		if (eoc && cycle == 0) {
-    			vosignal_t nr_signal = scale_level(segments[segment_count - 1].level);
+    			vosignal_t nr_signal = segment_count ? level_signal(segment_count - 1) : 0;
     			return signal2int(nr_signal) + offset;
     		}
         if (!sustained) { // Observe sustain state
@@ -162,36 +169,54 @@ public:
     int32_t Phase(int degrees) {
     		degrees = degrees % 3600;
     		degrees = abs(degrees);
+    		if (!segment_count) return offset;
+    		update_tables();
 
-    		// I need to find out which segment the specified phase occurs in
+    		// I need to find out which segment the specified phase occurs in. The running total of
+    		// segment times is kept in a byte, as it always has been, so it's only sorted (and
+    		// binary-searchable) if the total time fits.
     		byte time_index = Proportion(degrees, 3600, total_time);
     		byte segment = 0;
-    		byte time = 0;
-    		for (byte ix = 0; ix < segment_count; ix++)
-    		{
-    			time += segments[ix].time;
-    			if (time > time_index) {
-    				segment = ix;
-    				break;
+    		int start_degree = wrapped_start_degree;
+    		if (total_time <= 255) {
+    			byte lo = 0;
+    			byte hi = segment_count - 1;
+    			while (lo < hi) {
+    				byte mid = (lo + hi) >> 1;
+    				if (end_time[mid] > time_index) hi = mid;
+    				else lo = mid + 1;
+    			}
+    			if (end_time[lo] > time_index) {
+    				segment = lo;
+    				start_degree = start_degrees[lo];
+    			}
+    		} else {
+    			for (byte ix = 0; ix < segment_count; ix++)
+    			{
+    				if (end_time[ix] > time_index) {
+    					segment = ix;
+    					start_degree = start_degrees[ix];
+    					break;
+    				}
     			}
     		}
 
-    		// Where does this segment start, and how many degrees does it span?
-    		int start_degree = Proportion(time - segments[segment].time, total_time, 3600);
-    		int segment_degrees = Proportion(segments[segment].time, total_time, 3600);
-
     		// Start and end point of the total segment
-    		int start = signal2int(scale_level(segment == 0 ? segments[segment_count - 1].level : segments[segment - 1].level));
-    		int end = signal2int(scale_level(segments[segment].level));
+    		int start = levels[segment == 0 ? segment_count - 1 : segment - 1];
+    		int end = levels[segment];
 
     		// Determine the signal based on the levels and the position within the segment
-    		int signal = Proportion(degrees - start_degree, segment_degrees, end - start) + start;
+    		int32_t position = degrees - start_degree;
+    		vosignal_t proportion = position < 0
+    			? -(vosignal_t)divide_span(segment, int2signal(-position))
+    			: (vosignal_t)divide_span(segment, int2signal(position));
+    		int signal = signal2int(proportion * (end - start)) + start;
 
         return signal + offset;
     }
 
 private:
-    VOSegment segments[12]; // Array of segments in this Oscillator
+    VOSegment segments[HS::VO_MAX_SEGMENTS]; // Array of segments in this Oscillator
     byte segment_count = 0; // Number of segments
     int total_time = 0; // Sum of time values for all segments
     vosignal_t signal = 0; // Current scaled signal << 10 for more precision
@@ -206,6 +231,20 @@ private:
     int32_t offset = 0; // Amount added to each voltage output (e.g., to make it unipolar)
     bool sustain = 0; // Waveform stops when it reaches the end of the penultimate stage
     bool sustained = 0; // Current state of sustain. Only active when sustain = 1
+    int32_t cycle_ticks = 0; // 10 times the number of ticks in a complete cycle
+
+    /*
+     * Tables derived from the segments and scale, so that Next() and Phase() don't have
+     * to divide. They're rebuilt on the next use after a segment or the scale changes.
+     */
+    bool tables_valid = 0;
+    int32_t levels[HS::VO_MAX_SEGMENTS]; // Scaled segment levels
+    uint16_t time_fractions[HS::VO_MAX_SEGMENTS]; // Segment time as a fraction of total_time, << 10
+    byte end_time[HS::VO_MAX_SEGMENTS]; // Running total of segment times (as a byte, see Phase())
+    int16_t start_degrees[HS::VO_MAX_SEGMENTS]; // Phase at which each segment starts
+    int16_t wrapped_start_degree; // Start phase used when no segment ends past the phase
+    uint32_t span_reciprocals[HS::VO_MAX_SEGMENTS]; // Reciprocal of each segment's span in degrees...
+    byte span_shifts[HS::VO_MAX_SEGMENTS]; // ...and the shift to go with it
 
     /*
      * The Oscillator can only oscillate if the following conditions are true:
@@ -240,6 +279,53 @@ private:
         return scaled_level;
     }
 
+    vosignal_t level_signal(byte ix) {
+        update_tables();
+        return int2signal(levels[ix]);
+    }
+
+    /* Division by zero is 0, as it is on the Cortex-M4 */
+    int32_t Proportion0(int numerator, int denominator, int max_value) {
+        return denominator ? Proportion(numerator, denominator, max_value) : 0;
+    }
+
+    void update_tables() {
+        if (tables_valid) return;
+
+        byte time = 0;
+        for (byte ix = 0; ix < segment_count; ix++)
+        {
+            levels[ix] = signal2int(scale_level(segments[ix].level));
+            time_fractions[ix] = total_time ? int2signal(segments[ix].time) / total_time : 0;
+
+            time += segments[ix].time;
+            end_time[ix] = time;
+            start_degrees[ix] = Proportion0(time - segments[ix].time, total_time, 3600);
+
+            // position / span is exact for |position| < 8192 (i.e. position << 10 < 2^23) if
+            // the reciprocal is rounded up with 23 + log2(span) bits of precision. When the
+            // byte-sized running total wraps, Phase() can be up to 7200 degrees past the
+            // segment's start.
+            int span = Proportion0(segments[ix].time, total_time, 3600);
+            if (span > 0) {
+                byte shift = 23;
+                while ((1 << (shift - 23)) < span) shift++;
+                span_shifts[ix] = shift;
+                span_reciprocals[ix] = (uint32_t)((((uint64_t)1 << shift) + span - 1) / span);
+            } else {
+                span_shifts[ix] = 0;
+                span_reciprocals[ix] = 0;
+            }
+        }
+        wrapped_start_degree = segment_count ? Proportion0(time - segments[0].time, total_time, 3600) : 0;
+        tables_valid = 1;
+    }
+
+    /* (numerator / segment's span in degrees), numerator < 2^23 */
+    uint32_t divide_span(byte ix, uint32_t numerator) {
+        return ((uint64_t)numerator * span_reciprocals[ix]) >> span_shifts[ix];
+    }
+
     void advance_segment() {
         if (sustain && segment_index == segment_count - 2) {
             sustained = 1;
@@ -253,22 +339,33 @@ private:
     }
 
     vosignal_t calculate_rise(byte ix) {
+        if (!segment_count) {
+            signal = target = 0;
+            countdown = 1;
+            return 0;
+        }
+        if (ix >= segment_count) {
+            // Past the last segment, i.e. a non-cycling waveform has ended and the frequency
+            // or scale changed. This used to read the unused segment after the last one, which
+            // has no time, so jump to its level and wait a tick.
+            if (ix < HS::VO_MAX_SEGMENTS) signal = scale_level(segments[ix].level);
+            target = signal;
+            countdown = 1;
+            return 0;
+        }
+        update_tables();
+
         // Determine the target level for this segment
-        byte level = segments[ix].level;
-        int time = static_cast<uint32_t>(segments[ix].time);
-        target = scale_level(level);
+        byte segment = ix;
+        target = int2signal(levels[ix]);
 
         // Determine the starting level of this segment to get the total segment rise
         if (ix > 0) ix--;
         else ix = segment_count - 1;
-        level = segments[ix].level;
-        vosignal_t starting = scale_level(level);
-
-        // How many ticks should a complete cycle last? cycle_ticks is 10 times that number.
-        int32_t cycle_ticks = 16666667 / frequency;
+        vosignal_t starting = int2signal(levels[ix]);
 
         // How many ticks should the current segment last?
-        int32_t segment_ticks = Proportion(time, total_time, cycle_ticks);
+        int32_t segment_ticks = signal2int(time_fractions[segment] * cycle_ticks);
 
         // The total difference between the target and the current signal, divided by how many ticks
         // it should take to get there, is the rise. The / 10 is to cancel the extra precision
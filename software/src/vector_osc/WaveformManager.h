@@ -25,6 +25,19 @@
 
 class WaveformManager {
 public:
+    /* Table of contents for the user and library waveforms, so that lookups don't have to
+     * scan the segment memory for TOC entries. The user index is rebuilt whenever the user
+     * waveforms are changed via the WaveformManager, and its version changes along with it,
+     * so that oscillators built from a user waveform can tell that they're out of date.
+     */
+    struct WaveformIndex {
+        byte toc[HS::VO_SEGMENT_COUNT / 2]; // Segment index of each waveform's TOC entry
+        byte count;
+        byte segments_used; // Including validation segment
+        uint16_t version;
+        bool built;
+    };
+
     /*
      * The segment at user_waveforms[0] should have a level byte of 0xfc, and the time
      * byte should have a value of 0xe2. This indicates that the memory is set up for
@@ -43,16 +56,46 @@ public:
         HS::user_waveforms[4] = VOSegment {0x02, 0xff}; // TOC entry: 2 steps
         HS::user_waveforms[5] = VOSegment {0xff, 0x00}; // First segment of sawtooth
         HS::user_waveforms[6] = VOSegment {0x00, 0x01}; // Second segment of sawtooth
-        for (byte i = 7; i < 64; i++) HS::user_waveforms[i] = VOSegment {0x00, 0xff};
+        for (byte i = 7; i < HS::VO_SEGMENT_COUNT; i++) HS::user_waveforms[i] = VOSegment {0x00, 0xff};
+        Rebuild();
     }
 
-    byte static WaveformCount() {
-        byte count = 0;
+    /* Re-index the user waveforms. This needs to be called after HS::user_waveforms has been
+     * changed other than through the WaveformManager (e.g. by a SysEx dump).
+     */
+    void static Rebuild() {
+        WaveformIndex &index = user_index();
+        index.count = 0;
+        index.segments_used = 1; // Include validation segment
         for (byte i = 0; i < HS::VO_SEGMENT_COUNT; i++)
         {
-            if (HS::user_waveforms[i].IsTOC()) count++;
+            if (HS::user_waveforms[i].IsTOC() && index.count < sizeof(index.toc)) {
+                index.toc[index.count++] = i;
+                index.segments_used += HS::user_waveforms[i].Segments();
+            }
         }
-        return count;
+        index.version++;
+        index.built = 1;
+    }
+
+    /* Changes whenever the user waveforms do */
+    uint16_t static Version() {
+        return user_toc().version;
+    }
+
+    /* For an oscillator built from waveform_number when Version() was version: if the user
+     * waveforms have changed since, updates version and returns the waveform to rebuild the
+     * oscillator from (the nearest one, if it was deleted). Otherwise returns -1. Keep a version
+     * for each oscillator, so that rebuilding one doesn't hide that another is out of date.
+     */
+    int static RefreshWaveform(byte waveform_number, uint16_t &version) {
+        if (version == Version()) return -1;
+        version = Version();
+        return waveform_number < 32 ? GetNextWaveform(waveform_number, 0) : -1;
+    }
+
+    byte static WaveformCount() {
+        return user_toc().count;
     }
 
     /* Allows a client application to navigate back and forth between the user waveforms and library
@@ -72,14 +115,7 @@ public:
     }
 
     byte static SegmentsRemaining() {
-        byte segment_count = 1; // Include validation segment
-        for (byte i = 0; i < HS::VO_SEGMENT_COUNT; i++)
-        {
-            if (HS::user_waveforms[i].IsTOC()) {
-                segment_count += HS::user_waveforms[i].Segments();
-            }
-        }
-        return (64 - segment_count);
+        return (HS::VO_SEGMENT_COUNT - user_toc().segments_used);
     }
 
     VectorOscillator static VectorOscillatorFromWaveform(byte waveform_number) {
@@ -87,18 +123,12 @@ public:
         if (waveform_number >= 32) { // Library waveforms start at 32
             osc = VectorOscillatorFromLibrary(waveform_number);
         } else {
-            byte count = 0;
-            for (byte i = 0; i < HS::VO_SEGMENT_COUNT; i++)
-            {
-                if (HS::user_waveforms[i].IsTOC()) {
-                    if (count == waveform_number) {
-                        for (int s = 0; s < HS::user_waveforms[i].Segments(); s++)
-                        {
-                            osc.SetSegment(HS::user_waveforms[i + s + 1]);
-                        }
-                        break;
-                    }
-                    count++;
+            const WaveformIndex &index = user_toc();
+            if (waveform_number < index.count) {
+                byte i = index.toc[waveform_number];
+                for (int s = 0; s < HS::user_waveforms[i].Segments(); s++)
+                {
+                    osc.SetSegment(HS::user_waveforms[i + s + 1]);
                 }
             }
         }
@@ -109,35 +139,26 @@ public:
         waveform_number = waveform_number - 32; // Library waveforms start at 32
         if (waveform_number >= HS::WAVEFORM_LIBRARY_COUNT) waveform_number = HS::WAVEFORM_LIBRARY_COUNT - 1;
         VectorOscillator osc;
-        byte count = 0;
-        for (byte i = 0; i < 255; i++)
-        {
-            if (HS::library_waveforms[i].IsTOC()) {
-                if (count == waveform_number) {
-                    for (int s = 0; s < HS::library_waveforms[i].Segments(); s++)
-                    {
-                        osc.SetSegment(HS::library_waveforms[i + s + 1]);
-                    }
-                    break;
-                }
-                count++;
+        const WaveformIndex &index = library_toc();
+        if (waveform_number < index.count) {
+            byte i = index.toc[waveform_number];
+            for (int s = 0; s < HS::library_waveforms[i].Segments(); s++)
+            {
+                osc.SetSegment(HS::library_waveforms[i + s + 1]);
             }
         }
         return osc;
     }
 
     byte static GetSegmentIndex(byte waveform_number, byte segment_number, int8_t direction = 0) {
-        byte count = 0;
         byte segment_index = 0; // Index from which to copy
 
         // Find the waveform that's the target of the add operation
-        for (byte i = 0; i < HS::VO_SEGMENT_COUNT; i++)
-        {
-            if (HS::user_waveforms[i].IsTOC() && count++ == waveform_number) {
-                segment_index = i + segment_number + 1;
-                HS::user_waveforms[i].SetTOC(HS::user_waveforms[i].Segments() + direction);
-                break;
-            }
+        const WaveformIndex &index = user_toc();
+        if (waveform_number < index.count) {
+            byte i = index.toc[waveform_number];
+            segment_index = i + segment_number + 1;
+            HS::user_waveforms[i].SetTOC(HS::user_waveforms[i].Segments() + direction);
         }
 
         return segment_index;
@@ -154,6 +175,7 @@ public:
                 memcpy(&HS::user_waveforms[i], &HS::user_waveforms[i - 1], sizeof(HS::user_waveforms[i - 1]));
             }
             if (HS::user_waveforms[insert_point + 1].time == 0) HS::user_waveforms[insert_point + 1].time = 1;
+            Rebuild();
         }
     }
 
@@ -166,6 +188,7 @@ public:
             {
                 memcpy(&HS::user_waveforms[i], &HS::user_waveforms[i + 1], sizeof(HS::user_waveforms[i + 1]));
             }
+            Rebuild();
         }
     }
 
@@ -174,23 +197,24 @@ public:
         if (ix) {
             HS::user_waveforms[ix].level = segment->level;
             HS::user_waveforms[ix].time = segment->time;
+            Rebuild();
         }
     }
 
     void static AddWaveform() {
         byte ix = 1;
-        for (byte i = 0; i < HS::VO_SEGMENT_COUNT; i++)
-        {
-            if (HS::user_waveforms[i].IsTOC()) {
-                ix = i + HS::user_waveforms[i].Segments() + 1;
-            }
+        const WaveformIndex &index = user_toc();
+        if (index.count) {
+            byte last = index.toc[index.count - 1];
+            ix = last + HS::user_waveforms[last].Segments() + 1;
         }
 
         // If there's enough room, add a new triangle waveform
-        if (ix < 61) {
+        if (ix < HS::VO_SEGMENT_COUNT - 3) {
             HS::user_waveforms[ix] = VOSegment {0x02, 0xff}; // TOC entry: 2 steps
             HS::user_waveforms[ix + 1] = VOSegment {0xff, 0x01}; // First segment of triangle
             HS::user_waveforms[ix + 2] = VOSegment {0x00, 0x01}; // Second segment of triangle
+            Rebuild();
         }
     }
 
@@ -211,7 +235,41 @@ public:
             {
                 HS::user_waveforms[i] = VOSegment {0x00, 0xff};
             }
+            Rebuild();
+        }
+    }
+
+private:
+    static WaveformIndex &user_index() {
+        static WaveformIndex index;
+        return index;
+    }
+
+    /* The user waveforms are set up on first use, so applets don't depend on the Waveform
+     * Editor having been started.
+     */
+    static const WaveformIndex &user_toc() {
+        const WaveformIndex &index = user_index();
+        if (!index.built) {
+            if (!Validate()) Setup();
+            else Rebuild();
+        }
+        return index;
+    }
+
+    /* The library doesn't change, so it's only indexed once */
+    static const WaveformIndex &library_toc() {
+        static WaveformIndex index;
+        if (!index.built) {
+            const byte library_size = sizeof(HS::library_waveforms) / sizeof(HS::library_waveforms[0]);
+            const byte max_count = min(sizeof(index.toc), (size_t)HS::WAVEFORM_LIBRARY_COUNT);
+            for (byte i = 0; i < library_size && index.count < max_count; i++)
+            {
+                if (HS::library_waveforms[i].IsTOC()) index.toc[index.count++] = i;
+            }
+            index.built = 1;
         }
+        return index;
     }
 };
 